@@ -0,0 +1,470 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/components/Visibility.hpp>
+#include <ge/core/Global.hpp>
+#include <ge/math/Bvh.hpp>
+#include <ge/math/FrustumCullBatch.hpp>
+#include <ge/math/LooseGrid.hpp>
+#include <ge/math/OcclusionBuffer.hpp>
+#include <ge/systems/FrustumCullingSystem.hpp>
+
+// Times every culling path over synthetic scenes and a camera path, without a window or GPU.
+// One CSV row per scene, size, path and thread count goes to stdout; progress goes to stderr.
+namespace
+{
+    constexpr uint32_t ScreenWidth = 1920;
+    constexpr uint32_t ScreenHeight = 1080;
+    constexpr uint32_t MaxOccluders = 32;
+
+    struct Options
+    {
+        std::vector<std::string> scenes{ "uniform", "clustered", "city" };
+        std::vector<size_t> sizes{ 1000, 10000, 100000, 1000000 };
+        std::vector<std::string> paths;     // Empty runs every path
+        uint32_t frames{ 64 };
+        uint32_t maxThreads{ 0 };           // 0 is the thread pool plus the calling thread
+    };
+
+    struct Scene
+    {
+        std::string name;
+        std::vector<AABB> boxes;
+        float extent{ 0.f };
+    };
+
+    struct Result
+    {
+        double seconds{ 0.0 };
+        uint64_t visible{ 0 };
+    };
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double Seconds(Clock::time_point begin, Clock::time_point end)
+    {
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+    std::vector<std::string> Split(const std::string& list)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        for (std::string item; std::getline(stream, item, ',');)
+        {
+            if (!item.empty())
+                items.push_back(item);
+        }
+        return items;
+    }
+
+    // Buildings on a square grid, towers among them
+    Scene MakeCity(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        constexpr float spacing = 20.f;
+        size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(count))));
+
+        Scene scene{ "city" };
+        scene.extent = side * spacing;
+        scene.boxes.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+            glm::vec3 size{ 5.f + 10.f * unit(rng), 5.f + 95.f * unit(rng), 5.f + 10.f * unit(rng) };
+            scene.boxes[i] = { corner, corner + size };
+        }
+        return scene;
+    }
+
+    // Small props spread evenly over the ground, up to 100 high
+    Scene MakeUniform(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        Scene scene{ "uniform" };
+        scene.extent = 20.f * static_cast<float>(std::sqrt(double(count)));
+        scene.boxes.resize(count);
+        for (auto& box : scene.boxes)
+        {
+            glm::vec3 corner{ scene.extent * unit(rng), 100.f * unit(rng), scene.extent * unit(rng) };
+            box = { corner, corner + glm::vec3{ 1.f + 4.f * unit(rng) } };
+        }
+        return scene;
+    }
+
+    // Groups of a thousand props around random centers, dense in some places and empty elsewhere
+    Scene MakeClustered(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        std::normal_distribution<float> spread(0.f, 60.f);
+
+        Scene scene{ "clustered" };
+        scene.extent = 20.f * static_cast<float>(std::sqrt(double(count)));
+        std::vector<glm::vec3> centers(std::max<size_t>(1, count / 1000));
+        for (auto& center : centers)
+            center = { scene.extent * unit(rng), 30.f * unit(rng), scene.extent * unit(rng) };
+
+        scene.boxes.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const glm::vec3& center = centers[i % centers.size()];
+            glm::vec3 corner = center + glm::vec3{ spread(rng), std::abs(spread(rng)) * .25f, spread(rng) };
+            scene.boxes[i] = { corner, corner + glm::vec3{ 1.f + 4.f * unit(rng) } };
+        }
+        return scene;
+    }
+
+    bool MakeScene(const std::string& name, size_t count, Scene& scene)
+    {
+        std::mt19937 rng(1);
+        if (name == "uniform")
+            scene = MakeUniform(count, rng);
+        else if (name == "clustered")
+            scene = MakeClustered(count, rng);
+        else if (name == "city")
+            scene = MakeCity(count, rng);
+        else
+            return false;
+        return true;
+    }
+
+    // A slow circle at street level through the middle of the scene, turning with the path
+    std::vector<GE::Camera3DData> MakeCameraPath(const Scene& scene, uint32_t frames)
+    {
+        std::vector<GE::Camera3DData> path(frames);
+        glm::vec3 center{ .5f * scene.extent, 0.f, .5f * scene.extent };
+        float radius = .3f * scene.extent;
+        for (uint32_t f = 0; f < frames; f++)
+        {
+            float angle = 6.2831853f * f / frames;
+            glm::vec3 eye = center + glm::vec3{ radius * std::cos(angle), 30.f, radius * std::sin(angle) };
+            glm::vec3 front = glm::normalize(glm::vec3{ -std::sin(angle), -.1f, std::cos(angle) });
+
+            path[f].projection = glm::perspective(glm::radians(60.f), float(ScreenWidth) / ScreenHeight, .1f, 1500.f);
+            path[f].view = glm::lookAt(eye, eye + front, glm::vec3{ 0.f, 1.f, 0.f });
+            path[f].position = eye;
+            path[f].front = front;
+        }
+        return path;
+    }
+
+    uint64_t CountBits(const std::vector<uint64_t>& bits)
+    {
+        uint64_t count = 0;
+        for (uint64_t word : bits)
+            for (; word; word &= word - 1)
+                count++;
+        return count;
+    }
+
+    Result RunScalar(const Scene& scene, const std::vector<GE::Camera3DData>& path)
+    {
+        Result result;
+        for (const auto& camera : path)
+        {
+            auto begin = Clock::now();
+            GE::Math::Frustum frustum(camera.projection * camera.view);
+            uint64_t visible = 0;
+            for (const AABB& box : scene.boxes)
+                visible += frustum.IsBoxVisible(box.min, box.max);
+            result.seconds += Seconds(begin, Clock::now());
+            result.visible += visible;
+        }
+        return result;
+    }
+
+    // Every thread culls its own contiguous share of the boxes
+    Result RunBatch(const Scene& scene, const std::vector<GE::Camera3DData>& path, uint32_t threads)
+    {
+        std::vector<GE::Math::BoundsSoA> shares(threads);
+        std::vector<std::vector<uint64_t>> bits(threads);
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            size_t first = scene.boxes.size() * t / threads, end = scene.boxes.size() * (t + 1) / threads;
+            shares[t].Reserve(end - first);
+            for (size_t i = first; i < end; i++)
+                shares[t].Push(scene.boxes[i].min, scene.boxes[i].max);
+            bits[t].resize(GE::Math::VisibilityWords(end - first));
+        }
+
+        Result result;
+        for (const auto& camera : path)
+        {
+            auto begin = Clock::now();
+            GE::Math::Frustum frustum(camera.projection * camera.view);
+            GE::GlobalThreadPool().ParallelFor(threads, [&](uint32_t t) { GE::Math::CullBoxes(frustum, shares[t], bits[t].data()); });
+            result.seconds += Seconds(begin, Clock::now());
+            for (const auto& share : bits)
+                result.visible += CountBits(share);
+        }
+        return result;
+    }
+
+    Result RunBvh(GE::Math::Bvh& bvh, const std::vector<GE::Camera3DData>& path, bool coherent)
+    {
+        Result result;
+        std::vector<uint32_t> visible;
+        for (const auto& camera : path)
+        {
+            auto begin = Clock::now();
+            GE::Math::Frustum frustum(camera.projection * camera.view);
+            visible.clear();
+            if (coherent)
+                bvh.CullCoherent(frustum, visible);
+            else
+                bvh.Cull(frustum, visible);
+            result.seconds += Seconds(begin, Clock::now());
+            result.visible += visible.size();
+        }
+        return result;
+    }
+
+    Result RunGrid(const GE::Math::LooseGrid& grid, const std::vector<GE::Camera3DData>& path)
+    {
+        Result result;
+        std::vector<uint32_t> visible;
+        for (const auto& camera : path)
+        {
+            auto begin = Clock::now();
+            visible.clear();
+            grid.QueryFrustum(GE::Math::Frustum(camera.projection * camera.view), visible);
+            result.seconds += Seconds(begin, Clock::now());
+            result.visible += visible.size();
+        }
+        return result;
+    }
+
+    // The frustum visible boxes as occludees behind the closest ones, rasterized and tested on
+    // every thread. The frustum cull itself is not timed; visible counts what survives occlusion.
+    Result RunOcclusion(const Scene& scene, GE::Math::Bvh& bvh, const std::vector<GE::Camera3DData>& path, uint32_t threads)
+    {
+        const uint32_t boxIndices[36] = { 0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3 };
+        GE::Math::OcclusionBuffer buffer;
+        std::vector<uint32_t> visible;
+        std::vector<std::pair<float, uint32_t>> candidates;
+        std::vector<glm::vec3> corners(8 * MaxOccluders);
+        std::vector<uint8_t> unoccluded;
+
+        Result result;
+        for (const auto& camera : path)
+        {
+            visible.clear();
+            bvh.Cull(GE::Math::Frustum(camera.projection * camera.view), visible);
+
+            auto begin = Clock::now();
+            candidates.clear();
+            for (uint32_t i : visible)
+            {
+                const AABB& box = scene.boxes[i];
+                glm::vec3 diagonal = box.max - box.min, toCenter = (box.min + box.max) * .5f - camera.position;
+                candidates.push_back({ glm::dot(diagonal, diagonal) / std::max(glm::dot(toCenter, toCenter), 1e-4f), i });
+            }
+            size_t numOccluders = std::min<size_t>(candidates.size(), MaxOccluders);
+            std::partial_sort(candidates.begin(), candidates.begin() + numOccluders, candidates.end(),
+                [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) { return a.first > b.first; });
+
+            buffer.Begin(camera.projection * camera.view);
+            for (size_t o = 0; o < numOccluders; o++)
+            {
+                const AABB& box = scene.boxes[candidates[o].second];
+                for (int c = 0; c < 8; c++)
+                    corners[8 * o + c] = { c & 1 ? box.max.x : box.min.x, c & 2 ? box.max.y : box.min.y, c & 4 ? box.max.z : box.min.z };
+                buffer.AddOccluder(&corners[8 * o], boxIndices, 36);
+            }
+
+            uint32_t bands = std::min(threads, GE::Math::OcclusionBuffer::TilesY);
+            GE::GlobalThreadPool().ParallelFor(bands, [&](uint32_t band) {
+                buffer.Rasterize(band * GE::Math::OcclusionBuffer::TilesY / bands, (band + 1) * GE::Math::OcclusionBuffer::TilesY / bands);
+            });
+
+            unoccluded.assign(visible.size(), 0);
+            GE::GlobalThreadPool().ParallelFor(threads, [&](uint32_t t) {
+                for (size_t i = visible.size() * t / threads; i < visible.size() * (t + 1) / threads; i++)
+                    unoccluded[i] = buffer.IsBoxVisible(scene.boxes[visible[i]].min, scene.boxes[visible[i]].max);
+            });
+            result.seconds += Seconds(begin, Clock::now());
+            for (uint8_t kept : unoccluded)
+                result.visible += kept;
+        }
+        return result;
+    }
+
+    // The whole system over registry entities, the camera arriving the way Camera3D sends it
+    Result RunSystem(GE::Sys::FrustumCullingSystem& system, const std::vector<GE::Camera3DData>& path)
+    {
+        Result result;
+        for (const auto& camera : path)
+        {
+            GE::GlobalDispatcher().trigger(camera);
+            auto begin = Clock::now();
+            system.Update(0);
+            result.seconds += Seconds(begin, Clock::now());
+            result.visible += system.GetStats().visible;
+        }
+        return result;
+    }
+
+    bool Wanted(const Options& options, const std::string& path)
+    {
+        return options.paths.empty() || std::find(options.paths.begin(), options.paths.end(), path) != options.paths.end();
+    }
+
+    void PrintRow(const Scene& scene, const std::string& path, uint32_t threads, uint32_t frames, const Result& result)
+    {
+        double perFrame = result.seconds / frames;
+        printf("%s,%zu,%s,%u,%u,%.3f,%.4f,%.1f\n", scene.name.c_str(), scene.boxes.size(), path.c_str(), threads, frames,
+            1e9 * perFrame / std::max<size_t>(scene.boxes.size(), 1), 1e3 * perFrame, double(result.visible) / frames);
+        fflush(stdout);
+    }
+
+    void RunScene(const Options& options, const Scene& scene)
+    {
+        auto path = MakeCameraPath(scene, options.frames);
+        uint32_t frames = options.frames;
+
+        std::vector<uint32_t> threadCounts;
+        for (uint32_t threads = 1; threads < options.maxThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(options.maxThreads);
+
+        if (Wanted(options, "frustum"))
+            PrintRow(scene, "frustum", 1, frames, RunScalar(scene, path));
+
+        if (Wanted(options, "batch"))
+        {
+            for (uint32_t threads : threadCounts)
+                PrintRow(scene, std::string("batch_") + GE::Math::ToString(GE::Math::ActiveSimdLevel()), threads, frames, RunBatch(scene, path, threads));
+        }
+
+        if (Wanted(options, "bvh") || Wanted(options, "bvh_coherent") || Wanted(options, "occlusion"))
+        {
+            auto begin = Clock::now();
+            GE::Math::Bvh bvh;
+            bvh.Build(scene.boxes.data(), scene.boxes.size());
+            PrintRow(scene, "bvh_build", 1, 1, { Seconds(begin, Clock::now()), 0 });
+
+            if (Wanted(options, "bvh"))
+                PrintRow(scene, "bvh", 1, frames, RunBvh(bvh, path, false));
+            if (Wanted(options, "bvh_coherent"))
+                PrintRow(scene, "bvh_coherent", 1, frames, RunBvh(bvh, path, true));
+            if (Wanted(options, "occlusion"))
+            {
+                for (uint32_t threads : threadCounts)
+                    PrintRow(scene, "occlusion", threads, frames, RunOcclusion(scene, bvh, path, threads));
+            }
+        }
+
+        if (Wanted(options, "grid"))
+        {
+            auto begin = Clock::now();
+            GE::Math::LooseGrid grid;
+            for (size_t i = 0; i < scene.boxes.size(); i++)
+                grid.Insert(scene.boxes[i], static_cast<uint32_t>(i));
+            PrintRow(scene, "grid_build", 1, 1, { Seconds(begin, Clock::now()), 0 });
+            PrintRow(scene, "grid", 1, frames, RunGrid(grid, path));
+        }
+
+        bool systemPaths = Wanted(options, "system_linear") || Wanted(options, "system_hierarchical") || Wanted(options, "system_still")
+            || Wanted(options, "system_screen_area");
+        if (!systemPaths)
+            return;
+
+        auto& registry = GE::GlobalRegistry();
+        for (const AABB& box : scene.boxes)
+        {
+            auto entity = registry.create();
+            registry.emplace<AABB>(entity, box);
+            registry.emplace<Visibility>(entity, false);
+        }
+
+        GE::Sys::FrustumCullingSystem system;
+        system.SetScreenHeight(ScreenHeight);
+        system.OnAttach();
+
+        // The first frame of every run builds what it needs and is left out
+        auto runSystem = [&](const char* name, bool hierarchical, float minScreenArea, const std::vector<GE::Camera3DData>& cameras) {
+            system.SetHierarchical(hierarchical);
+            system.SetMinScreenArea(minScreenArea);
+            RunSystem(system, { cameras.front() });
+            PrintRow(scene, name, 1, static_cast<uint32_t>(cameras.size()), RunSystem(system, cameras));
+        };
+        if (Wanted(options, "system_linear"))
+            runSystem("system_linear", false, 0.f, path);
+        if (Wanted(options, "system_hierarchical"))
+            runSystem("system_hierarchical", true, 0.f, path);
+        if (Wanted(options, "system_still"))
+            runSystem("system_still", true, 0.f, std::vector<GE::Camera3DData>(frames, path.front()));
+        if (Wanted(options, "system_screen_area"))
+            runSystem("system_screen_area", true, 4.f, path);
+
+        system.OnDetach();
+        registry.clear();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--scenes")
+            options.scenes = Split(value);
+        else if (arg == "--sizes")
+        {
+            options.sizes.clear();
+            for (const auto& size : Split(value))
+                options.sizes.push_back(static_cast<size_t>(std::stoull(size)));
+        }
+        else if (arg == "--paths")
+            options.paths = Split(value);
+        else if (arg == "--frames")
+            options.frames = std::max(1u, static_cast<uint32_t>(std::stoul(value)));
+        else if (arg == "--threads")
+            options.maxThreads = static_cast<uint32_t>(std::stoul(value));
+        else
+        {
+            printf("usage: CullBenchmark [--scenes uniform,clustered,city] [--sizes 1000,...,10000000] [--frames 64]\n");
+            printf("                     [--threads max] [--paths frustum,batch,bvh,bvh_coherent,grid,occlusion,\n");
+            printf("                      system_linear,system_hierarchical,system_still,system_screen_area]\n");
+            printf("prints scene,objects,path,threads,frames,ns_per_object,ms_per_frame,visible_per_frame as CSV\n");
+            return -1;
+        }
+        i++;
+    }
+
+    GE::Global::Get().Initialize();
+    uint32_t poolThreads = static_cast<uint32_t>(GE::GlobalThreadPool().Size() + 1);
+    options.maxThreads = options.maxThreads == 0 ? poolThreads : std::min(options.maxThreads, poolThreads);
+
+    printf("scene,objects,path,threads,frames,ns_per_object,ms_per_frame,visible_per_frame\n");
+    for (const auto& name : options.scenes)
+    {
+        for (size_t size : options.sizes)
+        {
+            Scene scene;
+            if (!MakeScene(name, size, scene))
+            {
+                fprintf(stderr, "unknown scene %s\n", name.c_str());
+                return -1;
+            }
+            fprintf(stderr, "%s, %zu boxes\n", name.c_str(), size);
+            RunScene(options, scene);
+        }
+    }
+
+    GE::Global::Get().Release();
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/Bvh.hpp>
+#include <ge/math/FrustumCullBatch.hpp>
+
+#include "Tests.hpp"
+
+// Builds a city of buildings on a square grid and culls it from street level views with the
+// linear batched path and the BVH, checking both agree and comparing their cost
+int TestBvh()
+{
+    constexpr size_t numObjects = 100000;
+    constexpr uint32_t numViews = 16;
+
+    constexpr float spacing = 20.f;
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<AABB> boxes(numObjects);
+    GE::Math::BoundsSoA bounds;
+    bounds.Reserve(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+        glm::vec3 size{ 5.f + 10.f * unit(rng), 5.f + 95.f * unit(rng), 5.f + 10.f * unit(rng) };
+        boxes[i] = { corner, corner + size };
+        bounds.Push(boxes[i].min, boxes[i].max);
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    GE::Math::Bvh bvh;
+    bvh.Build(boxes.data(), boxes.size());
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+    printf("%zu objects, %zu nodes, depth %u, built in %.1f ms\n", numObjects, bvh.NumNodes(), bvh.Depth(), buildMs);
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1500.f);
+    std::vector<uint64_t> bits(GE::Math::VisibilityWords(numObjects));
+    std::vector<uint32_t> visible;
+    double linearMs = 0.0, bvhMs = 0.0;
+    uint64_t numVisible = 0, nodesVisited = 0, itemsTested = 0, subtreesAccepted = 0, mismatches = 0;
+
+    for (uint32_t v = 0; v < numViews; v++)
+    {
+        float extent = side * spacing;
+        glm::vec3 eye{ extent * unit(rng), 2.f + 30.f * unit(rng), extent * unit(rng) };
+        float yaw = 6.2831853f * unit(rng);
+        GE::Math::Frustum frustum(projection * glm::lookAt(eye, eye + glm::vec3{ std::cos(yaw), -.1f, std::sin(yaw) }, glm::vec3{ 0.f, 1.f, 0.f }));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        GE::Math::CullBoxes(frustum, bounds, bits.data());
+        auto middle = std::chrono::high_resolution_clock::now();
+        visible.clear();
+        GE::Math::Bvh::CullStats stats;
+        bvh.Cull(frustum, visible, &stats);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        linearMs += std::chrono::duration<double, std::milli>(middle - start).count();
+        bvhMs += std::chrono::duration<double, std::milli>(end - middle).count();
+        numVisible += visible.size();
+        nodesVisited += stats.nodesVisited;
+        itemsTested += stats.itemsTested;
+        subtreesAccepted += stats.subtreesAccepted;
+
+        // Both must report the same set
+        uint64_t linearVisible = 0;
+        for (uint64_t word : bits)
+            for (; word; word &= word - 1)
+                linearVisible++;
+        for (uint32_t item : visible)
+            mismatches += ((bits[item / 64] >> (item % 64)) & 1) == 0;
+        mismatches += linearVisible > visible.size() ? linearVisible - visible.size() : 0;
+    }
+
+    printf("per view: %.1f visible (%.3f%%), %.1f nodes, %.1f boxes tested, %.1f subtrees accepted whole\n",
+        double(numVisible) / numViews, 100.0 * numVisible / (double(numViews) * numObjects),
+        double(nodesVisited) / numViews, double(itemsTested) / numViews, double(subtreesAccepted) / numViews);
+    printf("linear %s: %.3f ms, bvh: %.3f ms (%.1fx)\n", GE::Math::ToString(GE::Math::ActiveSimdLevel()),
+        linearMs / numViews, bvhMs / numViews, linearMs / bvhMs);
+    printf("%llu mismatches between the linear and hierarchical results\n", (unsigned long long)mismatches);
+
+    // Coincident boxes cannot be split, the build must still stop within MaxDepth and keep them all
+    std::vector<AABB> stacked(10000, AABB{ glm::vec3{ 0.f }, glm::vec3{ 1.f } });
+    GE::Math::Bvh degenerate;
+    degenerate.Build(stacked.data(), stacked.size());
+    visible.clear();
+    degenerate.Cull(GE::Math::Frustum(projection * glm::lookAt(glm::vec3{ -5.f }, glm::vec3{ 0.f }, glm::vec3{ 0.f, 1.f, 0.f })), visible);
+    bool bounded = bvh.Depth() <= GE::Math::Bvh::MaxDepth && degenerate.Depth() <= GE::Math::Bvh::MaxDepth && visible.size() == stacked.size();
+    printf("%zu coincident boxes: depth %u, %zu visible\n", stacked.size(), degenerate.Depth(), visible.size());
+
+    return mismatches == 0 && bounded ? 0 : 1;
+}
+
+// Flies the camera smoothly through a city, culling every frame with the hierarchy from
+// scratch and with the plane remembered per node, checking both agree
+int TestCoherence()
+{
+    constexpr size_t numObjects = 100000;
+    constexpr uint32_t numFrames = 120;
+
+    constexpr float spacing = 20.f;
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<AABB> boxes(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+        glm::vec3 size{ 5.f + 10.f * unit(rng), 5.f + 95.f * unit(rng), 5.f + 10.f * unit(rng) };
+        boxes[i] = { corner, corner + size };
+    }
+
+    GE::Math::Bvh bvh;
+    bvh.Build(boxes.data(), boxes.size());
+
+    // A minute at 10 m/s, turning slowly, at 60 frames a second
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1500.f);
+    float extent = side * spacing;
+    glm::vec3 eye{ .5f * extent, 30.f, .5f * extent };
+    std::vector<uint32_t> visible, coherentVisible;
+    double plainMs = 0.0, coherentMs = 0.0;
+    uint64_t numVisible = 0, mismatches = 0;
+
+    for (uint32_t f = 0; f < numFrames; f++)
+    {
+        float yaw = .3f * std::sin(f * .004f) + f * .002f;
+        glm::vec3 forward{ std::cos(yaw), -.1f, std::sin(yaw) };
+        eye += glm::vec3{ forward.x, 0.f, forward.z } * (10.f / 60.f);
+        GE::Math::Frustum frustum(projection * glm::lookAt(eye, eye + forward, glm::vec3{ 0.f, 1.f, 0.f }));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        visible.clear();
+        bvh.Cull(frustum, visible);
+        auto middle = std::chrono::high_resolution_clock::now();
+        coherentVisible.clear();
+        bvh.CullCoherent(frustum, coherentVisible);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        // The first frame fills the plane cache
+        if (f > 0)
+        {
+            plainMs += std::chrono::duration<double, std::milli>(middle - start).count();
+            coherentMs += std::chrono::duration<double, std::milli>(end - middle).count();
+        }
+        numVisible += visible.size();
+        mismatches += visible != coherentVisible;
+    }
+
+    printf("%zu objects, %u frames: %.1f visible per frame\n", numObjects, numFrames, double(numVisible) / numFrames);
+    printf("bvh: %.3f ms, with remembered planes: %.3f ms (%.2fx)\n", plainMs / (numFrames - 1), coherentMs / (numFrames - 1), plainMs / coherentMs);
+    printf("%llu frames differ between the two\n", (unsigned long long)mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/FrustumCullBatch.hpp>
+
+#include "Tests.hpp"
+
+// Culls random boxes scattered around a camera with Frustum::IsBoxVisible one box at a time
+// and with the batched kernels at every level the CPU supports, from 10k to 100k boxes
+int TestCull()
+{
+    constexpr size_t maxBoxes = 100000;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+    std::uniform_real_distribution<float> extent(.5f, 20.f);
+    GE::Math::Frustum frustum(glm::perspective(45.f, 16.f / 9.f, .1f, 1000.f)
+        * glm::lookAt(glm::vec3{ 0.f }, glm::vec3{ 0.f, 0.f, -1.f }, glm::vec3{ 0.f, 1.f, 0.f }));
+
+    auto timeMs = [](auto&& run) {
+        // Best of several runs, at least 100 ms in total
+        double best = 1e30, total = 0.0;
+        for (int rep = 0; rep < 50 && (rep < 3 || total < 100.0); rep++)
+        {
+            auto begin = std::chrono::high_resolution_clock::now();
+            run();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+            best = std::min(best, ms);
+            total += ms;
+        }
+        return best;
+    };
+
+    printf("active level: %s\n", GE::Math::ToString(GE::Math::ActiveSimdLevel()));
+    printf("%10s %-8s %10s %10s %8s %10s\n", "boxes", "path", "ms", "ns/box", "speedup", "mismatches");
+
+    int failures = 0;
+    for (size_t count = 10000; count <= maxBoxes; count *= 10)
+    {
+        std::vector<AABB> boxes(count);
+        GE::Math::BoundsSoA bounds;
+        bounds.Reserve(count);
+        for (auto& box : boxes)
+        {
+            glm::vec3 center{ position(rng), position(rng), position(rng) };
+            glm::vec3 half{ extent(rng), extent(rng), extent(rng) };
+            box = { center - half, center + half };
+            bounds.Push(box.min, box.max);
+        }
+
+        std::vector<uint64_t> expected(GE::Math::VisibilityWords(count));
+        double scalarMs = timeMs([&]() {
+            std::fill(expected.begin(), expected.end(), 0);
+            for (size_t i = 0; i < count; i++)
+                expected[i / 64] |= uint64_t(frustum.IsBoxVisible(boxes[i].min, boxes[i].max)) << (i % 64);
+        });
+        printf("%10zu %-8s %10.3f %10.2f %8s %10s\n", count, "per box", scalarMs, scalarMs * 1e6 / count, "1.00x", "-");
+
+        for (uint32_t level = 0; level <= static_cast<uint32_t>(GE::Math::ActiveSimdLevel()); level++)
+        {
+            std::vector<uint64_t> visible(expected.size());
+            double ms = timeMs([&]() { GE::Math::CullBoxes(frustum, bounds, visible.data(), static_cast<GE::Math::SimdLevel>(level)); });
+
+            size_t mismatches = 0;
+            for (size_t w = 0; w < visible.size(); w++)
+            {
+                uint64_t diff = visible[w] ^ expected[w];
+                for (; diff; diff &= diff - 1)
+                    mismatches++;
+            }
+            failures += mismatches != 0;
+
+            char speedup[16];
+            snprintf(speedup, sizeof(speedup), "%.2fx", scalarMs / ms);
+            printf("%10zu %-8s %10.3f %10.2f %8s %10zu\n", count, GE::Math::ToString(static_cast<GE::Math::SimdLevel>(level)),
+                ms, ms * 1e6 / count, speedup, mismatches);
+        }
+    }
+
+    printf("%s\n", failures == 0 ? "batched results identical to Frustum::IsBoxVisible" : "batched results differ from Frustum::IsBoxVisible");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/LooseGrid.hpp>
+
+#include "Tests.hpp"
+
+// Moves objects around a square world every frame, updating a loose grid, and checks the
+// grid's frustum, box and sphere queries against testing every object
+int TestGrid()
+{
+    constexpr size_t numObjects = 20000;
+    constexpr uint32_t numFrames = 16;
+
+    float extent = 40.f * static_cast<float>(std::sqrt(double(numObjects)));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<AABB> boxes(numObjects);
+    std::vector<glm::vec3> velocities(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        // Mostly small movers with the odd large one
+        float scale = unit(rng) < .01f ? 40.f : 1.f;
+        glm::vec3 size = scale * glm::vec3{ 1.f + 4.f * unit(rng), 1.f + 4.f * unit(rng), 1.f + 4.f * unit(rng) };
+        glm::vec3 corner{ extent * unit(rng), 20.f * unit(rng), extent * unit(rng) };
+        boxes[i] = { corner, corner + size };
+        velocities[i] = glm::vec3{ unit(rng) - .5f, 0.f, unit(rng) - .5f } * 4.f;
+    }
+
+    auto elapsedMs = [](std::chrono::high_resolution_clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+    };
+
+    GE::Math::LooseGrid grid;
+    std::vector<uint32_t> handles(numObjects);
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numObjects; i++)
+        handles[i] = grid.Insert(boxes[i], static_cast<uint32_t>(i));
+    double insertMs = elapsedMs(begin);
+    printf("%zu objects in %zu cells, inserted in %.1f ms (%.0f ns each)\n", numObjects, grid.NumCells(), insertMs, 1e6 * insertMs / numObjects);
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1000.f);
+    std::vector<uint32_t> found, expected;
+    double updateMs = 0.0, frustumMs = 0.0, boxMs = 0.0, sphereMs = 0.0;
+    uint64_t numFrustum = 0, numBox = 0, numSphere = 0, cellsVisited = 0, itemsTested = 0, mismatches = 0;
+
+    // Sorts the query result and counts values missing from either side
+    auto compare = [&]() {
+        std::sort(found.begin(), found.end());
+        if (found == expected)
+            return;
+        std::vector<uint32_t> difference;
+        std::set_symmetric_difference(found.begin(), found.end(), expected.begin(), expected.end(), std::back_inserter(difference));
+        mismatches += difference.size();
+    };
+
+    for (uint32_t frame = 0; frame < numFrames; frame++)
+    {
+        for (size_t i = 0; i < numObjects; i++)
+        {
+            glm::vec3 center = (boxes[i].min + boxes[i].max) * .5f;
+            if (center.x < 0.f || center.x > extent)
+                velocities[i].x = -velocities[i].x;
+            if (center.z < 0.f || center.z > extent)
+                velocities[i].z = -velocities[i].z;
+            boxes[i].min += velocities[i];
+            boxes[i].max += velocities[i];
+        }
+
+        begin = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < numObjects; i++)
+            grid.Update(handles[i], boxes[i]);
+        updateMs += elapsedMs(begin);
+
+        glm::vec3 eye{ extent * unit(rng), 2.f + 30.f * unit(rng), extent * unit(rng) };
+        float yaw = 6.2831853f * unit(rng);
+        GE::Math::Frustum frustum(projection * glm::lookAt(eye, eye + glm::vec3{ std::cos(yaw), -.1f, std::sin(yaw) }, glm::vec3{ 0.f, 1.f, 0.f }));
+
+        found.clear();
+        GE::Math::LooseGrid::QueryStats stats;
+        begin = std::chrono::high_resolution_clock::now();
+        grid.QueryFrustum(frustum, found, &stats);
+        frustumMs += elapsedMs(begin);
+        numFrustum += found.size();
+        cellsVisited += stats.cellsVisited;
+        itemsTested += stats.itemsTested;
+        expected.clear();
+        for (size_t i = 0; i < numObjects; i++)
+            if (frustum.IsBoxVisible(boxes[i].min, boxes[i].max))
+                expected.push_back(static_cast<uint32_t>(i));
+        compare();
+
+        glm::vec3 queryMin{ extent * unit(rng), 0.f, extent * unit(rng) };
+        glm::vec3 queryMax = queryMin + glm::vec3{ 10.f + 90.f * unit(rng), 25.f, 10.f + 90.f * unit(rng) };
+        found.clear();
+        begin = std::chrono::high_resolution_clock::now();
+        grid.QueryBox(queryMin, queryMax, found);
+        boxMs += elapsedMs(begin);
+        numBox += found.size();
+        expected.clear();
+        for (size_t i = 0; i < numObjects; i++)
+            if (glm::all(glm::lessThanEqual(boxes[i].min, queryMax)) && glm::all(glm::greaterThanEqual(boxes[i].max, queryMin)))
+                expected.push_back(static_cast<uint32_t>(i));
+        compare();
+
+        glm::vec3 center{ extent * unit(rng), 10.f, extent * unit(rng) };
+        float radius = 10.f + 90.f * unit(rng);
+        found.clear();
+        begin = std::chrono::high_resolution_clock::now();
+        grid.QuerySphere(center, radius, found);
+        sphereMs += elapsedMs(begin);
+        numSphere += found.size();
+        expected.clear();
+        for (size_t i = 0; i < numObjects; i++)
+        {
+            glm::vec3 d = glm::max(glm::max(boxes[i].min - center, center - boxes[i].max), glm::vec3{ 0.f });
+            if (glm::dot(d, d) <= radius * radius)
+                expected.push_back(static_cast<uint32_t>(i));
+        }
+        compare();
+    }
+
+    printf("update: %.3f ms per frame (%.1f ns per object), %zu cells after moving\n",
+        updateMs / numFrames, 1e6 * updateMs / (double(numFrames) * numObjects), grid.NumCells());
+    printf("frustum: %.3f ms, %.1f visible, %.1f cells visited, %.1f boxes tested\n", frustumMs / numFrames,
+        double(numFrustum) / numFrames, double(cellsVisited) / numFrames, double(itemsTested) / numFrames);
+    printf("box: %.3f ms, %.1f found\n", boxMs / numFrames, double(numBox) / numFrames);
+    printf("sphere: %.3f ms, %.1f found\n", sphereMs / numFrames, double(numSphere) / numFrames);
+    printf("%llu mismatches against testing every object\n", (unsigned long long)mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/FrustumCull.hpp>
+#include <ge/math/OcclusionBuffer.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    // Straightforward double precision rasterizer over whole pixels, the reference for the
+    // occlusion test: clip to the same near plane, then test every pixel center of the rectangle
+    void ReferenceRasterize(const glm::mat4& viewProjection, const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount, std::vector<double>& depth)
+    {
+        constexpr double width = GE::Math::OcclusionBuffer::Width, height = GE::Math::OcclusionBuffer::Height;
+        for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            glm::vec4 clip[3];
+            for (int k = 0; k < 3; k++)
+                clip[k] = viewProjection * glm::vec4(vertices[indices[i + k]], 1.f);
+
+            std::vector<glm::dvec4> polygon;
+            for (int k = 0; k < 3; k++)
+            {
+                glm::dvec4 a = clip[k], b = clip[(k + 1) % 3];
+                double da = a.w - 1e-3, db = b.w - 1e-3;
+                if (da >= 0.0)
+                    polygon.push_back(a);
+                if ((da >= 0.0) != (db >= 0.0))
+                    polygon.push_back(a + (b - a) * (da / (da - db)));
+            }
+
+            for (size_t k = 1; k + 1 < polygon.size(); k++)
+            {
+                glm::dvec3 p[3];
+                const glm::dvec4* v[3] = { &polygon[0], &polygon[k], &polygon[k + 1] };
+                for (int j = 0; j < 3; j++)
+                    p[j] = { (v[j]->x / v[j]->w * .5 + .5) * width, (v[j]->y / v[j]->w * .5 + .5) * height, 1.0 / v[j]->w };
+
+                double area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+                if (std::abs(area) < 1e-6)
+                    continue;
+
+                int firstX = std::max(0, int(std::floor(std::min({ p[0].x, p[1].x, p[2].x }))));
+                int lastX = std::min(int(width) - 1, int(std::ceil(std::max({ p[0].x, p[1].x, p[2].x }))));
+                int firstY = std::max(0, int(std::floor(std::min({ p[0].y, p[1].y, p[2].y }))));
+                int lastY = std::min(int(height) - 1, int(std::ceil(std::max({ p[0].y, p[1].y, p[2].y }))));
+                for (int y = firstY; y <= lastY; y++)
+                {
+                    for (int x = firstX; x <= lastX; x++)
+                    {
+                        double px = x + .5, py = y + .5;
+                        double w0 = ((p[1].x - px) * (p[2].y - py) - (p[1].y - py) * (p[2].x - px)) / area;
+                        double w1 = ((p[2].x - px) * (p[0].y - py) - (p[2].y - py) * (p[0].x - px)) / area;
+                        double w2 = 1.0 - w0 - w1;
+                        if (w0 >= 0.0 && w1 >= 0.0 && w2 >= 0.0)
+                        {
+                            double& pixel = depth[size_t(y) * size_t(width) + x];
+                            pixel = std::max(pixel, w0 * p[0].z + w1 * p[1].z + w2 * p[2].z);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Culls a city of buildings from street level views: the largest buildings on screen are
+// drawn as occluders and every frustum visible building is tested. Checks the buffer against
+// a double precision reference rasterizer and that no occluded box has a pixel of the
+// reference depth behind it.
+int TestOcclusion()
+{
+    constexpr size_t numObjects = 10000;
+    constexpr uint32_t numViews = 8;
+    constexpr uint32_t maxOccluders = 32;
+    constexpr uint32_t width = GE::Math::OcclusionBuffer::Width, height = GE::Math::OcclusionBuffer::Height;
+
+    constexpr float spacing = 20.f;
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    // Every building is a closed box of 12 triangles
+    std::vector<AABB> boxes(numObjects);
+    std::vector<glm::vec3> vertices(8 * numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+        glm::vec3 size{ 5.f + 10.f * unit(rng), 5.f + 45.f * unit(rng), 5.f + 10.f * unit(rng) };
+        boxes[i] = { corner, corner + size };
+        for (int c = 0; c < 8; c++)
+            vertices[8 * i + c] = { c & 1 ? boxes[i].max.x : boxes[i].min.x, c & 2 ? boxes[i].max.y : boxes[i].min.y, c & 4 ? boxes[i].max.z : boxes[i].min.z };
+    }
+    const uint32_t boxIndices[36] = { 0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3 };
+    std::vector<uint32_t> indices(36 * numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+        for (int k = 0; k < 36; k++)
+            indices[36 * i + k] = static_cast<uint32_t>(8 * i + boxIndices[k]);
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1500.f);
+    GE::Math::OcclusionBuffer buffer;
+    std::vector<double> reference(size_t(width) * height);
+    std::vector<std::pair<float, uint32_t>> candidates;
+    std::vector<uint32_t> occludees;
+    double rasterizeMs = 0.0, testMs = 0.0;
+    uint64_t numTriangles = 0, numTested = 0, numOccluded = 0, referenceOccluded = 0;
+    uint64_t coverageMismatches = 0, falseOcclusions = 0;
+    double maxDepthError = 0.0;
+
+    for (uint32_t v = 0; v < numViews; v++)
+    {
+        float extent = side * spacing;
+        glm::vec3 eye{ extent * unit(rng), 2.f + 10.f * unit(rng), extent * unit(rng) };
+        float yaw = 6.2831853f * unit(rng);
+        glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + glm::vec3{ std::cos(yaw), -.05f, std::sin(yaw) }, glm::vec3{ 0.f, 1.f, 0.f });
+        GE::Math::Frustum frustum(viewProjection);
+
+        // Buildings the camera is inside of are skipped, they hide everything
+        candidates.clear();
+        occludees.clear();
+        for (uint32_t i = 0; i < numObjects; i++)
+        {
+            if (!frustum.IsBoxVisible(boxes[i].min, boxes[i].max))
+                continue;
+            occludees.push_back(i);
+            if (glm::all(glm::lessThanEqual(boxes[i].min, eye)) && glm::all(glm::greaterThanEqual(boxes[i].max, eye)))
+                continue;
+            glm::vec3 diagonal = boxes[i].max - boxes[i].min;
+            glm::vec3 toCenter = (boxes[i].min + boxes[i].max) * .5f - eye;
+            candidates.push_back({ glm::dot(diagonal, diagonal) / std::max(glm::dot(toCenter, toCenter), 1e-4f), i });
+        }
+        size_t numOccluders = std::min<size_t>(candidates.size(), maxOccluders);
+        std::partial_sort(candidates.begin(), candidates.begin() + numOccluders, candidates.end(), std::greater<std::pair<float, uint32_t>>());
+
+        auto start = std::chrono::high_resolution_clock::now();
+        buffer.Begin(viewProjection);
+        for (size_t i = 0; i < numOccluders; i++)
+            buffer.AddOccluder(vertices.data(), indices.data() + 36 * candidates[i].second, 36);
+        buffer.Rasterize(0, GE::Math::OcclusionBuffer::TilesY);
+        auto middle = std::chrono::high_resolution_clock::now();
+        uint32_t occluded = 0;
+        for (uint32_t i : occludees)
+            occluded += !buffer.IsBoxVisible(boxes[i].min, boxes[i].max);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        rasterizeMs += std::chrono::duration<double, std::milli>(middle - start).count();
+        testMs += std::chrono::duration<double, std::milli>(end - middle).count();
+        numTriangles += buffer.NumTriangles();
+        numTested += occludees.size();
+        numOccluded += occluded;
+
+        std::fill(reference.begin(), reference.end(), 0.0);
+        for (size_t i = 0; i < numOccluders; i++)
+            ReferenceRasterize(viewProjection, vertices.data(), indices.data() + 36 * candidates[i].second, 36, reference);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                double expected = reference[size_t(y) * width + x];
+                double actual = buffer.DepthAt(x, y);
+                if ((expected > 0.0) != (actual > 0.0))
+                    coverageMismatches++;
+                else if (expected > 0.0)
+                    maxDepthError = std::max(maxDepthError, std::abs(actual - expected) / expected);
+            }
+        }
+
+        // An occluded box must be behind the reference depth at every pixel it touches
+        for (uint32_t i : occludees)
+        {
+            double nearest = 0.0, minX = DBL_MAX, maxX = -DBL_MAX, minY = DBL_MAX, maxY = -DBL_MAX;
+            bool crossesNear = false;
+            for (int c = 0; c < 8; c++)
+            {
+                glm::vec4 clip = viewProjection * glm::vec4(c & 1 ? boxes[i].max.x : boxes[i].min.x, c & 2 ? boxes[i].max.y : boxes[i].min.y, c & 4 ? boxes[i].max.z : boxes[i].min.z, 1.f);
+                crossesNear |= clip.w <= 1e-3f;
+                double x = (double(clip.x) / clip.w * .5 + .5) * width, y = (double(clip.y) / clip.w * .5 + .5) * height;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+                nearest = std::max(nearest, 1.0 / clip.w);
+            }
+
+            bool hidden = !crossesNear;
+            int firstX = std::max(0, int(std::floor(minX))), lastX = std::min(int(width) - 1, int(std::ceil(maxX)) - 1);
+            int firstY = std::max(0, int(std::floor(minY))), lastY = std::min(int(height) - 1, int(std::ceil(maxY)) - 1);
+            for (int y = firstY; y <= lastY && hidden; y++)
+                for (int x = firstX; x <= lastX && hidden; x++)
+                    hidden = reference[size_t(y) * width + x] > nearest;
+
+            referenceOccluded += hidden;
+            falseOcclusions += !hidden && !buffer.IsBoxVisible(boxes[i].min, boxes[i].max);
+        }
+    }
+
+    printf("%zu buildings, %u views: %.1f occluder triangles, %.1f boxes tested per view\n", numObjects, numViews,
+        double(numTriangles) / numViews, double(numTested) / numViews);
+    printf("rasterize %.3f ms, test %.3f ms (%.0f ns per box), one thread\n", rasterizeMs / numViews, testMs / numViews,
+        1e6 * testMs / std::max<uint64_t>(numTested, 1));
+    printf("occluded %.1f%% of frustum visible boxes, reference %.1f%%\n", 100.0 * numOccluded / std::max<uint64_t>(numTested, 1),
+        100.0 * referenceOccluded / std::max<uint64_t>(numTested, 1));
+    printf("against the reference: %llu pixels differ in coverage (%.4f%%), depth within %.2e\n", (unsigned long long)coverageMismatches,
+        100.0 * coverageMismatches / (double(numViews) * width * height), maxDepthError);
+    printf("%llu boxes occluded that the reference sees\n", (unsigned long long)falseOcclusions);
+    return falseOcclusions == 0 ? 0 : 1;
+}
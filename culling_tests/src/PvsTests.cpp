@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/components/Occluder.hpp>
+#include <ge/components/PvsObject.hpp>
+#include <ge/components/Visibility.hpp>
+#include <ge/core/Global.hpp>
+#include <ge/math/FrustumCullBatch.hpp>
+#include <ge/math/OcclusionBuffer.hpp>
+#include <ge/math/PotentiallyVisibleSet.hpp>
+#include <ge/math/ShadowCull.hpp>
+#include <ge/systems/FrustumCullingSystem.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    uint32_t CountBits(uint64_t word)
+    {
+        uint32_t count = 0;
+        for (; word; word &= word - 1)
+            count++;
+        return count;
+    }
+
+    // Buildings on a square grid, each a closed box of 12 triangles it occludes with
+    struct City
+    {
+        std::vector<AABB> boxes;
+        std::vector<glm::vec3> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<Occluder> occluders;
+        GE::Math::PvsBakeSettings settings;
+    };
+
+    void BuildCity(size_t numObjects, std::mt19937& rng, City& city)
+    {
+        constexpr float spacing = 20.f;
+        size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        city.boxes.resize(numObjects);
+        city.vertices.resize(8 * numObjects);
+        for (size_t i = 0; i < numObjects; i++)
+        {
+            glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+            glm::vec3 size{ 5.f + 10.f * unit(rng), 5.f + 45.f * unit(rng), 5.f + 10.f * unit(rng) };
+            AABB& box = city.boxes[i];
+            box = { corner, corner + size };
+            for (int c = 0; c < 8; c++)
+                city.vertices[8 * i + c] = { c & 1 ? box.max.x : box.min.x, c & 2 ? box.max.y : box.min.y, c & 4 ? box.max.z : box.min.z };
+        }
+        const uint32_t boxIndices[36] = { 0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3 };
+        city.indices.resize(36 * numObjects);
+        city.occluders.resize(numObjects);
+        for (size_t i = 0; i < numObjects; i++)
+        {
+            for (int k = 0; k < 36; k++)
+                city.indices[36 * i + k] = static_cast<uint32_t>(8 * i + boxIndices[k]);
+            city.occluders[i] = { city.vertices.data(), city.indices.data() + 36 * i, 36 };
+        }
+
+        // One layer of cells at street level
+        city.settings.cellSize = 10.f;
+        city.settings.min = { -spacing, 1.f, -spacing };
+        city.settings.max = { side * spacing, 11.f, side * spacing };
+    }
+
+    // Objects whose box shows from a point: the same cube of occlusion buffers the bake renders
+    void VisibleFromPoint(const glm::vec3& point, const glm::mat4& projection, float range, const std::vector<AABB>& boxes,
+        const std::vector<Occluder>& occluders, GE::Math::OcclusionBuffer& buffer, std::vector<uint64_t>& bits)
+    {
+        std::vector<uint32_t> faceVisible[GE::Math::CubeFaces];
+        GE::Math::ShadowCubeCuller cube(projection, point, range);
+        cube.Cull(boxes.data(), boxes.size(), faceVisible);
+
+        bits.assign(GE::Math::VisibilityWords(boxes.size()), 0);
+        for (uint32_t face = 0; face < GE::Math::CubeFaces; face++)
+        {
+            buffer.Begin(cube.GetFaceMatrix(face));
+            for (uint32_t i : faceVisible[face])
+                buffer.AddOccluder(occluders[i].vertices, occluders[i].indices, occluders[i].indexCount);
+            buffer.Rasterize(0, GE::Math::OcclusionBuffer::TilesY);
+            for (uint32_t i : faceVisible[face])
+                if (buffer.IsBoxVisible(boxes[i].min, boxes[i].max))
+                    bits[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+}
+
+// Bakes a potentially visible set over the streets of a city at increasing thread counts,
+// checking every count bakes the same file, that sets decode to what was coded and survive
+// serialization. Then counts, from random street level points, the buildings seen there
+// that the point's cell misses, baked with and without dilation.
+int TestPvs()
+{
+    constexpr size_t numObjects = 49;
+    constexpr uint32_t numPoints = 128;
+    constexpr uint32_t maxThreads = 4;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    City city;
+    BuildCity(numObjects, rng, city);
+    const std::vector<AABB>& boxes = city.boxes;
+    const std::vector<Occluder>& occluders = city.occluders;
+    GE::Math::PvsBakeSettings settings = city.settings;
+
+    GE::Math::PotentiallyVisibleSet pvs;
+    GE::Math::PvsBakeStats stats;
+    std::vector<char> expected;
+    uint64_t bakeMismatches = 0;
+    for (uint32_t threads = 1;; threads = std::min(threads * 2, maxThreads))
+    {
+        settings.threads = threads;
+        auto start = std::chrono::high_resolution_clock::now();
+        pvs = GE::Math::BakePotentiallyVisibleSet(boxes.data(), occluders.data(), numObjects, settings, &stats);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        printf("bake on %u threads: %.1f ms (%.1f us per sample)\n", threads, ms, 1e3 * ms / std::max<uint64_t>(stats.samples, 1));
+
+        std::vector<char> data = pvs.Serialize();
+        if (expected.empty())
+            expected = data;
+        bakeMismatches += data != expected;
+        if (threads == maxThreads)
+            break;
+    }
+
+    uint32_t covered = stats.cells - stats.uncovered;
+    size_t words = GE::Math::VisibilityWords(numObjects);
+    printf("%zu buildings, %u cells (%u uncovered), %.1f triangles per sample, %.1f of %zu buildings per covered cell\n",
+        numObjects, stats.cells, stats.uncovered, double(stats.triangles) / std::max<uint64_t>(stats.samples, 1),
+        double(stats.visibleBits) / std::max(covered, 1u), numObjects);
+    printf("%u distinct sets, %zu coded bytes against %zu as plain bitsets (%.1fx)\n", pvs.NumSets(), pvs.CodedBytes(),
+        size_t(covered) * words * sizeof(uint64_t), double(covered) * words * sizeof(uint64_t) / std::max<size_t>(pvs.CodedBytes(), 1));
+
+    // Coding round trip over random sets of every density, runs included
+    uint64_t codingMismatches = 0;
+    {
+        GE::Math::PotentiallyVisibleSet coded;
+        coded.Reset(glm::vec3(0.f), 1.f, { 64, 1, 1 }, 1000);
+        std::vector<std::vector<uint64_t>> sets(64);
+        for (uint32_t cell = 0; cell < 64; cell++)
+        {
+            float density = unit(rng);
+            sets[cell].assign(GE::Math::VisibilityWords(1000), 0);
+            for (uint32_t i = 0; i < 1000; i++)
+                if ((cell % 4 == 0 && (i / 100) % 2 == 0) || unit(rng) < density * density)
+                    sets[cell][i / 64] |= uint64_t(1) << (i % 64);
+            coded.SetCell(cell, sets[cell].data());
+        }
+
+        GE::Math::PotentiallyVisibleSet loaded;
+        codingMismatches += !loaded.Deserialize(coded.Serialize());
+        std::vector<uint64_t> bits;
+        for (uint32_t cell = 0; cell < 64; cell++)
+        {
+            loaded.Decode(loaded.SetOf(cell), bits);
+            codingMismatches += bits != sets[cell];
+        }
+    }
+
+    GE::Math::PotentiallyVisibleSet loaded;
+    uint64_t serializeMismatches = !loaded.Deserialize(expected);
+    std::vector<uint64_t> bits, loadedBits;
+    for (uint32_t cell = 0; cell < pvs.NumCells(); cell++)
+    {
+        serializeMismatches += pvs.SetOf(cell) != loaded.SetOf(cell);
+        pvs.Decode(pvs.SetOf(cell), bits);
+        loaded.Decode(loaded.SetOf(cell), loadedBits);
+        serializeMismatches += bits != loadedBits;
+    }
+
+    settings.dilation = 0;
+    settings.threads = maxThreads;
+    GE::Math::PotentiallyVisibleSet undilated = GE::Math::BakePotentiallyVisibleSet(boxes.data(), occluders.data(), numObjects, settings);
+
+    float range = glm::length(boxes.back().max - settings.min) + settings.cellSize;
+    glm::mat4 projection = glm::perspective(glm::radians(90.f), float(GE::Math::OcclusionBuffer::Width) / GE::Math::OcclusionBuffer::Height,
+        settings.cellSize * .01f, range);
+    GE::Math::OcclusionBuffer buffer;
+    std::vector<uint64_t> seen;
+    uint64_t numSeen = 0, numPvs = 0, missed = 0, missedUndilated = 0, tested = 0;
+    while (tested < numPoints)
+    {
+        glm::vec3 point = settings.min + glm::vec3(unit(rng), unit(rng), unit(rng)) * (settings.max - settings.min);
+        bool inside = false;
+        for (const AABB& box : boxes)
+            inside |= glm::all(glm::lessThanEqual(box.min, point)) && glm::all(glm::greaterThanEqual(box.max, point));
+        uint32_t set = pvs.SetOf(pvs.CellAt(point));
+        if (inside || set == GE::Math::PotentiallyVisibleSet::NoSet)
+            continue;
+
+        VisibleFromPoint(point, projection, range, boxes, occluders, buffer, seen);
+        pvs.Decode(set, bits);
+        undilated.Decode(undilated.SetOf(undilated.CellAt(point)), loadedBits);
+        for (size_t w = 0; w < words; w++)
+        {
+            numSeen += CountBits(seen[w]);
+            numPvs += CountBits(bits[w]);
+            missed += CountBits(seen[w] & ~bits[w]);
+            missedUndilated += CountBits(seen[w] & ~loadedBits[w]);
+        }
+        tested++;
+    }
+
+    printf("%u street points: %.1f buildings seen, %.1f in the cell's set, %llu missed (%llu without dilation, %u distinct sets)\n",
+        numPoints, double(numSeen) / numPoints, double(numPvs) / numPoints, (unsigned long long)missed,
+        (unsigned long long)missedUndilated, undilated.NumSets());
+    printf("%llu thread count mismatches, %llu coding mismatches, %llu serialization mismatches\n", (unsigned long long)bakeMismatches,
+        (unsigned long long)codingMismatches, (unsigned long long)serializeMismatches);
+    return bakeMismatches == 0 && codingMismatches == 0 && serializeMismatches == 0 ? 0 : 1;
+}
+
+// Bakes a city and culls its buildings with FrustumCullingSystem from street level points, inside
+// and outside the baked volume, on both paths. Buildings in the frustum must be visible exactly
+// when the set of the camera's cell holds them, while an entity without a PvsObject and every
+// building seen from outside the volume are never filtered.
+int TestPvsSystem()
+{
+    constexpr size_t numObjects = 49;
+    constexpr uint32_t numViews = 32;
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    City city;
+    BuildCity(numObjects, rng, city);
+    city.settings.threads = static_cast<uint32_t>(GE::GlobalThreadPool().Size() + 1);
+    GE::Math::PotentiallyVisibleSet pvs = GE::Math::BakePotentiallyVisibleSet(city.boxes.data(), city.occluders.data(), numObjects, city.settings);
+
+    entt::registry& registry = GE::GlobalRegistry();
+    std::vector<entt::entity> entities(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        entities[i] = registry.create();
+        registry.emplace<Visibility>(entities[i], false);
+        registry.emplace<PvsObject>(entities[i], PvsObject{ static_cast<uint32_t>(i) });
+        registry.emplace<AABB>(entities[i], city.boxes[i]);
+    }
+
+    // Spans the whole city, no cell's set can hold it
+    entt::entity unbaked = registry.create();
+    registry.emplace<Visibility>(unbaked, false);
+    registry.emplace<AABB>(unbaked, AABB{ city.settings.min, city.settings.max });
+
+    GE::Sys::FrustumCullingSystem system;
+    system.SetScreenHeight(1080);
+    system.SetMinScreenArea(0.f);
+    system.SetPotentiallyVisibleSet(&pvs);
+    system.OnAttach();
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1000.f);
+    std::vector<uint64_t> bits;
+    uint64_t mismatches = 0, pvsCulled = 0, outside = 0;
+    for (uint32_t v = 0; v < numViews; v++)
+    {
+        system.SetHierarchical(v % 2 == 0);
+
+        // Every fourth view from above the baked volume
+        GE::Camera3DData camera;
+        glm::vec3 range = city.settings.max - city.settings.min;
+        camera.position = city.settings.min + glm::vec3{ unit(rng), v % 4 == 3 ? 2.f : unit(rng), unit(rng) } * range;
+        float yaw = 6.2831853f * unit(rng);
+        camera.front = glm::vec3{ std::cos(yaw), -.05f, std::sin(yaw) };
+        camera.projection = projection;
+        camera.view = glm::lookAt(camera.position, camera.position + camera.front, glm::vec3{ 0.f, 1.f, 0.f });
+        GE::GlobalDispatcher().trigger(camera);
+        system.Update(0);
+
+        uint32_t set = pvs.SetOf(pvs.CellAt(camera.position));
+        outside += set == GE::Math::PotentiallyVisibleSet::NoSet;
+        if (set != GE::Math::PotentiallyVisibleSet::NoSet)
+            pvs.Decode(set, bits);
+
+        GE::Math::Frustum frustum(camera.projection * camera.view);
+        size_t numVisible = 0;
+        for (size_t i = 0; i <= numObjects; i++)
+        {
+            entt::entity entity = i < numObjects ? entities[i] : unbaked;
+            const AABB& aabb = registry.get<const AABB>(entity);
+            bool inSet = i == numObjects || set == GE::Math::PotentiallyVisibleSet::NoSet || ((bits[i / 64] >> (i % 64)) & 1);
+            bool expected = inSet && frustum.IsBoxVisible(aabb.min, aabb.max);
+            mismatches += registry.get<Visibility>(entity) != expected;
+            numVisible += expected;
+        }
+        mismatches += system.GetVisibleSet().Size() != numVisible;
+        pvsCulled += system.GetStats().pvsCulled;
+    }
+
+    system.OnDetach();
+    registry.clear();
+
+    printf("%u views, %llu from outside the baked cells: %.1f buildings culled by the set per view\n", numViews,
+        (unsigned long long)outside, double(pvsCulled) / numViews);
+    printf("%llu mismatches against the frustum and the cell's set\n", (unsigned long long)mismatches);
+    return mismatches == 0 && pvsCulled > 0 && outside > 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/Bvh.hpp>
+#include <ge/math/ScreenArea.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    // Area of the convex hull of points, by Andrew's monotone chain
+    double HullArea(std::vector<glm::dvec2> points)
+    {
+        std::sort(points.begin(), points.end(), [](const glm::dvec2& a, const glm::dvec2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+        auto cross = [](const glm::dvec2& o, const glm::dvec2& a, const glm::dvec2& b) { return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); };
+
+        std::vector<glm::dvec2> hull(2 * points.size());
+        size_t k = 0;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0)
+                k--;
+            hull[k++] = points[i];
+        }
+        for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;)
+        {
+            while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0)
+                k--;
+            hull[k++] = points[i];
+        }
+
+        double area = 0.0;
+        for (size_t i = 0; i + 1 < k; i++)
+            area += hull[i].x * hull[i + 1].y - hull[i + 1].x * hull[i].y;
+        return std::abs(area) * .5;
+    }
+}
+
+// Looks across a city from above at 1080p and drops visible buildings by projected area,
+// checking the estimate never falls below the area the box actually covers
+int TestContribution()
+{
+    constexpr size_t numObjects = 50000;
+    constexpr float minPixels = 1.f;
+    constexpr float width = 1920.f, height = 1080.f;
+
+    constexpr float spacing = 20.f;
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<AABB> boxes(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+        glm::vec3 size{ 1.f + 4.f * unit(rng), 1.f + 20.f * unit(rng), 1.f + 4.f * unit(rng) };
+        boxes[i] = { corner, corner + size };
+    }
+
+    GE::Math::Bvh bvh;
+    bvh.Build(boxes.data(), boxes.size());
+
+    float extent = side * spacing;
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), width / height, .1f, 4.f * extent);
+    glm::mat4 view = glm::lookAt(glm::vec3{ -.05f * extent, 80.f, -.05f * extent }, glm::vec3{ .5f * extent, 0.f, .5f * extent }, glm::vec3{ 0.f, 1.f, 0.f });
+    glm::mat4 viewProjection = projection * view;
+    float focalPixels = std::abs(projection[1][1]) * height * .5f;
+
+    std::vector<uint32_t> visible;
+    bvh.Cull(GE::Math::Frustum(viewProjection), visible);
+
+    std::vector<float> areas(visible.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < visible.size(); i++)
+        areas[i] = GE::Math::ProjectedBoxArea(boxes[visible[i]].min, boxes[visible[i]].max, view, focalPixels);
+    double estimateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    const float thresholds[] = { minPixels, 4.f * minPixels, 16.f * minPixels };
+    uint64_t kept[3] = {}, underestimates = 0, checked = 0;
+    double ratio = 0.0;
+    std::vector<glm::dvec2> points(8);
+    for (size_t i = 0; i < visible.size(); i++)
+    {
+        for (int t = 0; t < 3; t++)
+            kept[t] += areas[i] >= thresholds[t];
+
+        // Boxes reaching behind the eye cover an unbounded area and are always kept
+        const AABB& box = boxes[visible[i]];
+        bool inFront = true;
+        for (int c = 0; c < 8; c++)
+        {
+            glm::vec4 clip = viewProjection * glm::vec4(c & 1 ? box.max.x : box.min.x, c & 2 ? box.max.y : box.min.y, c & 4 ? box.max.z : box.min.z, 1.f);
+            inFront &= clip.w > 0.f;
+            points[c] = { double(clip.x) / clip.w * .5 * width, double(clip.y) / clip.w * .5 * height };
+        }
+        if (!inFront || std::isinf(areas[i]))
+            continue;
+
+        double covered = HullArea(points);
+        checked++;
+        ratio += areas[i] / std::max(covered, 1e-12);
+        underestimates += areas[i] < covered * (1.0 - 1e-3);
+    }
+
+    printf("%zu buildings, %zu in the frustum, area estimate %.1f ns per box\n", numObjects, visible.size(), 1e6 * estimateMs / std::max<size_t>(visible.size(), 1));
+    for (int t = 0; t < 3; t++)
+        printf("at least %.1f pixels: %llu draws (%.1f%% culled)\n", thresholds[t], (unsigned long long)kept[t],
+            100.0 - 100.0 * kept[t] / std::max<size_t>(visible.size(), 1));
+    printf("estimate over covered area %.2fx on average, %llu of %llu boxes underestimated\n", ratio / std::max<uint64_t>(checked, 1),
+        (unsigned long long)underestimates, (unsigned long long)checked);
+    return underestimates == 0 ? 0 : 1;
+}
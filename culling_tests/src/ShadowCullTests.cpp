@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/FrustumCull.hpp>
+#include <ge/math/ShadowCull.hpp>
+
+#include "Tests.hpp"
+
+// Places point lights over a city and culls the buildings against each light's shadow cube,
+// checking the per face lists against testing every box with every face, and that every
+// building corner the light reaches lands in a face the building is drawn into
+int TestShadow()
+{
+    constexpr size_t numObjects = 20000;
+    constexpr uint32_t numLights = 8;
+    constexpr uint32_t faces = GE::Math::CubeFaces;
+    constexpr float zNear = .1f;
+
+    constexpr float spacing = 20.f;
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<AABB> boxes(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+        glm::vec3 size{ 5.f + 10.f * unit(rng), 5.f + 95.f * unit(rng), 5.f + 10.f * unit(rng) };
+        boxes[i] = { corner, corner + size };
+    }
+
+    std::vector<uint32_t> faceVisible[faces];
+    uint64_t faceDraws[faces] = {}, inRange = 0, mismatches = 0, missedCorners = 0;
+    double cullMs = 0.0;
+
+    for (uint32_t l = 0; l < numLights; l++)
+    {
+        float extent = side * spacing;
+        glm::vec3 light{ extent * unit(rng), 20.f + 200.f * unit(rng), extent * unit(rng) };
+        float range = 100.f + 400.f * unit(rng);
+        glm::mat4 projection = glm::perspective(glm::radians(90.f), 1.f, zNear, range) * glm::scale(glm::mat4(1.f), { 1.f, -1.f, 1.f });
+
+        auto start = std::chrono::high_resolution_clock::now();
+        GE::Math::ShadowCubeCuller culler(projection, light, range);
+        GE::Math::ShadowCubeCuller::Stats stats;
+        culler.Cull(boxes.data(), boxes.size(), faceVisible, &stats);
+        cullMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        inRange += stats.inRange;
+        for (uint32_t f = 0; f < faces; f++)
+            faceDraws[f] += stats.faceDraws[f];
+
+        std::vector<uint32_t> masks(numObjects, 0);
+        for (uint32_t f = 0; f < faces; f++)
+            for (uint32_t i : faceVisible[f])
+                masks[i] |= 1u << f;
+
+        for (size_t i = 0; i < numObjects; i++)
+        {
+            // Brute force: the range sphere, then every face frustum
+            glm::vec3 nearest = glm::clamp(light, boxes[i].min, boxes[i].max) - light;
+            uint32_t expected = 0;
+            if (glm::dot(nearest, nearest) <= range * range)
+                for (uint32_t f = 0; f < faces; f++)
+                    expected |= GE::Math::Frustum(culler.GetFaceMatrix(f)).IsBoxVisible(boxes[i].min, boxes[i].max) ? 1u << f : 0u;
+            mismatches += masks[i] != expected;
+
+            // A corner the light reaches must project inside a face the box is drawn into
+            for (int c = 0; c < 8; c++)
+            {
+                glm::vec3 point{ c & 1 ? boxes[i].max.x : boxes[i].min.x, c & 2 ? boxes[i].max.y : boxes[i].min.y, c & 4 ? boxes[i].max.z : boxes[i].min.z };
+                float distance = glm::length(point - light);
+                if (distance < 2.f * zNear || distance > .99f * range)
+                    continue;
+
+                bool covered = false;
+                for (uint32_t f = 0; f < faces && !covered; f++)
+                {
+                    glm::vec4 clip = culler.GetFaceMatrix(f) * glm::vec4(point, 1.f);
+                    covered = (masks[i] & (1u << f)) && clip.w > 0.f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w;
+                }
+                missedCorners += !covered;
+            }
+        }
+    }
+
+    uint64_t draws = 0;
+    for (uint32_t f = 0; f < faces; f++)
+        draws += faceDraws[f];
+    printf("%zu buildings, %u lights: %.1f in range per light, cull %.3f ms per light\n", numObjects, numLights,
+        double(inRange) / numLights, cullMs / numLights);
+    printf("draws per face:");
+    for (uint32_t f = 0; f < faces; f++)
+        printf(" %.1f", double(faceDraws[f]) / numLights);
+    printf("\n%.1f draws per light against %.1f drawing every in range caster into every face (%zu unculled)\n",
+        double(draws) / numLights, double(faces) * inRange / numLights, faces * numObjects);
+    printf("%llu masks differ from the brute force test, %llu reached corners outside their faces\n",
+        (unsigned long long)mismatches, (unsigned long long)missedCorners);
+    return mismatches == 0 && missedCorners == 0 ? 0 : 1;
+}
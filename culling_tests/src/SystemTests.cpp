@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/components/Dynamic.hpp>
+#include <ge/components/Occluder.hpp>
+#include <ge/components/Visibility.hpp>
+#include <ge/core/Global.hpp>
+#include <ge/systems/FrustumCullingSystem.hpp>
+#include <ge/systems/OcclusionCullingSystem.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    // Circles a square world at street level, looking along the circle
+    GE::Camera3DData OrbitCamera(float angle, float extent)
+    {
+        GE::Camera3DData camera;
+        float radius = .4f * extent;
+        camera.position = glm::vec3{ .5f * extent + radius * std::cos(angle), 20.f, .5f * extent + radius * std::sin(angle) };
+        camera.front = glm::normalize(glm::vec3{ -std::sin(angle), -.1f, std::cos(angle) });
+        camera.projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, .75f * extent);
+        camera.view = glm::lookAt(camera.position, camera.position + camera.front, glm::vec3{ 0.f, 1.f, 0.f });
+        return camera;
+    }
+
+    // Sorted entities with an AABB in the camera's frustum, by testing every one
+    std::vector<entt::entity> ExpectedVisible(const GE::Camera3DData& camera)
+    {
+        std::vector<entt::entity> expected;
+        GE::Math::Frustum frustum(camera.projection * camera.view);
+        GE::GlobalRegistry().view<const AABB, Visibility>().each([&](const entt::entity entity, const AABB& aabb, Visibility&) {
+            if (frustum.IsBoxVisible(aabb.min, aabb.max))
+                expected.push_back(entity);
+        });
+        std::sort(expected.begin(), expected.end());
+        return expected;
+    }
+
+    // Counts entities whose Visibility or VisibleSet membership differs from the expected set
+    uint64_t CountMismatches(const std::vector<entt::entity>& expected, const GE::Sys::VisibleSet& visibleSet)
+    {
+        std::vector<entt::entity> visible;
+        GE::GlobalRegistry().view<const AABB, Visibility>().each([&](const entt::entity entity, const AABB&, Visibility& visibility) {
+            if (visibility)
+                visible.push_back(entity);
+        });
+        std::sort(visible.begin(), visible.end());
+
+        std::vector<entt::entity> packed = visibleSet.entities;
+        std::sort(packed.begin(), packed.end());
+
+        uint64_t mismatches = 0;
+        for (const std::vector<entt::entity>* actual : { &visible, &packed })
+        {
+            std::vector<entt::entity> difference;
+            std::set_symmetric_difference(actual->begin(), actual->end(), expected.begin(), expected.end(), std::back_inserter(difference));
+            mismatches += difference.size();
+        }
+        return mismatches;
+    }
+}
+
+// Runs FrustumCullingSystem over a registry while statics stream in, settle, move, get destroyed
+// and switch between static and dynamic, checking Visibility and the VisibleSet against testing
+// every entity each frame, that pending statics are built into the hierarchy once quiet and that
+// nothing is culled again while the camera stands still
+int TestFrustumSystem()
+{
+    constexpr size_t numObjects = 3000;
+    constexpr float extent = 400.f;
+
+    entt::registry& registry = GE::GlobalRegistry();
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<entt::entity> entities;
+    auto create = [&](bool dynamic) {
+        entt::entity entity = registry.create();
+        glm::vec3 corner{ extent * unit(rng), 20.f * unit(rng), extent * unit(rng) };
+        registry.emplace<Visibility>(entity, false);
+        if (dynamic)
+            registry.emplace<Dynamic>(entity);
+        registry.emplace<AABB>(entity, AABB{ corner, corner + glm::vec3{ 2.f } });
+        entities.push_back(entity);
+    };
+    for (size_t i = 0; i < numObjects; i++)
+        create(i % 10 == 0);
+
+    GE::Sys::FrustumCullingSystem system;
+    system.SetScreenHeight(1080);
+    system.SetMinScreenArea(0.f);
+    system.OnAttach();
+
+    uint32_t frames = 0;
+    uint64_t mismatches = 0;
+    auto step = [&](float angle) {
+        GE::Camera3DData camera = OrbitCamera(angle, extent);
+        GE::GlobalDispatcher().trigger(camera);
+        system.Update(0);
+        mismatches += CountMismatches(ExpectedVisible(camera), system.GetVisibleSet());
+        frames++;
+    };
+
+    for (int f = 0; f < 10; f++)
+        step(f * .05f);
+
+    // A hundred statics a frame, then quiet frames until the pending ones are built in
+    uint32_t peakPending = 0;
+    for (int f = 0; f < 60; f++)
+    {
+        for (int i = 0; i < 100; i++)
+            create(false);
+        step(.5f + f * .01f);
+        peakPending = std::max(peakPending, system.GetStats().pending);
+    }
+    for (int f = 0; f < 40; f++)
+        step(1.1f);
+    uint32_t pendingAfterQuiet = system.GetStats().pending;
+
+    for (size_t i = 0; i < 200; i++)
+    {
+        entt::entity entity = entities[i * 7 % entities.size()];
+        glm::vec3 corner{ extent * unit(rng), 1.f, extent * unit(rng) };
+        registry.patch<AABB>(entity, [&](AABB& aabb) { aabb = { corner, corner + glm::vec3{ 3.f } }; });
+    }
+    step(1.1f);
+
+    for (size_t i = 0; i < 300; i++)
+    {
+        entt::entity entity = entities[i * 13 % entities.size()];
+        if (registry.valid(entity))
+            registry.destroy(entity);
+    }
+    step(1.1f);
+
+    for (size_t i = 0; i < 100; i++)
+    {
+        entt::entity entity = entities[i * 17 % entities.size()];
+        if (registry.valid(entity) && !registry.all_of<Dynamic>(entity))
+            registry.emplace<Dynamic>(entity);
+    }
+    step(1.2f);
+
+    for (size_t i = 0; i < 50; i++)
+    {
+        entt::entity entity = entities[i * 17 % entities.size()];
+        if (registry.valid(entity) && registry.all_of<Dynamic>(entity))
+            registry.remove<Dynamic>(entity);
+    }
+    step(1.3f);
+
+    for (int f = 0; f < 40; f++)
+        step(1.3f + f * .02f);
+    uint32_t pendingAfterSettle = system.GetStats().pending;
+
+    system.SetHierarchical(false);
+    for (int f = 0; f < 5; f++)
+        step(2.f + f * .1f);
+    system.SetHierarchical(true);
+    for (int f = 0; f < 5; f++)
+        step(2.5f + f * .1f);
+    for (int f = 0; f < 5; f++)
+        step(3.f);
+    bool reused = system.GetStats().reused;
+
+    system.OnDetach();
+    registry.clear();
+
+    printf("%u frames, %u statics pending at most, %u after quiet frames, %u after settling\n", frames, peakPending,
+        pendingAfterQuiet, pendingAfterSettle);
+    printf("%llu mismatches against testing every entity, last result %s while standing still\n", (unsigned long long)mismatches,
+        reused ? "reused" : "recomputed");
+    return mismatches == 0 && pendingAfterQuiet == 0 && pendingAfterSettle == 0 && reused ? 0 : 1;
+}
+
+// Runs FrustumCullingSystem and OcclusionCullingSystem over a city whose buildings are their own
+// occluders, from street level views. Every entity the frustum keeps must stay in the VisibleSet,
+// with Visibility set and its sort key, exactly when the occlusion buffer shows its box.
+int TestOcclusionSystem()
+{
+    constexpr size_t numObjects = 2500;
+    constexpr uint32_t numViews = 16;
+    constexpr float spacing = 20.f;
+
+    entt::registry& registry = GE::GlobalRegistry();
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(numObjects))));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    // Every building is a closed box of 12 triangles, the arrays outlive the Occluders pointing in
+    const uint32_t boxIndices[36] = { 0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3 };
+    std::vector<glm::vec3> vertices(8 * numObjects);
+    std::vector<uint32_t> indices(36 * numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 corner{ (i % side) * spacing, 0.f, (i / side) * spacing };
+        AABB aabb{ corner, corner + glm::vec3{ 5.f + 10.f * unit(rng), 5.f + 45.f * unit(rng), 5.f + 10.f * unit(rng) } };
+        for (int c = 0; c < 8; c++)
+            vertices[8 * i + c] = { c & 1 ? aabb.max.x : aabb.min.x, c & 2 ? aabb.max.y : aabb.min.y, c & 4 ? aabb.max.z : aabb.min.z };
+        for (int k = 0; k < 36; k++)
+            indices[36 * i + k] = static_cast<uint32_t>(8 * i + boxIndices[k]);
+
+        entt::entity entity = registry.create();
+        registry.emplace<Visibility>(entity, false);
+        registry.emplace<Occluder>(entity, Occluder{ vertices.data(), indices.data() + 36 * i, 36 });
+        registry.emplace<AABB>(entity, aabb);
+    }
+
+    GE::Sys::FrustumCullingSystem cullingSystem;
+    GE::Sys::OcclusionCullingSystem occlusionSystem(&cullingSystem);
+    cullingSystem.SetScreenHeight(1080);
+    cullingSystem.SetMinScreenArea(0.f);
+    cullingSystem.OnAttach();
+    occlusionSystem.OnAttach();
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1500.f);
+    uint64_t mismatches = 0, keyMismatches = 0, numFrustum = 0, numOccluded = 0;
+    for (uint32_t v = 0; v < numViews; v++)
+    {
+        // Every other view with occlusion off, the set must then be the frustum's
+        bool enabled = v % 2 == 0;
+        occlusionSystem.SetEnabled(enabled);
+
+        GE::Camera3DData camera;
+        float extent = side * spacing;
+        float yaw = 6.2831853f * unit(rng);
+        camera.position = glm::vec3{ extent * unit(rng), 2.f + 10.f * unit(rng), extent * unit(rng) };
+        camera.front = glm::vec3{ std::cos(yaw), -.05f, std::sin(yaw) };
+        camera.projection = projection;
+        camera.view = glm::lookAt(camera.position, camera.position + camera.front, glm::vec3{ 0.f, 1.f, 0.f });
+        GE::GlobalDispatcher().trigger(camera);
+        cullingSystem.Update(0);
+        occlusionSystem.Update(0);
+
+        const GE::Sys::VisibleSet& visibleSet = cullingSystem.GetVisibleSet();
+        for (size_t i = 0; i < visibleSet.Size(); i++)
+        {
+            const AABB& aabb = registry.get<const AABB>(visibleSet.entities[i]);
+            glm::vec3 toCenter = (aabb.min + aabb.max) * .5f - camera.position;
+            keyMismatches += visibleSet.sortKeys[i] != glm::dot(toCenter, toCenter);
+        }
+        keyMismatches += visibleSet.sortKeys.size() != visibleSet.Size();
+
+        std::vector<entt::entity> expected;
+        GE::Math::Frustum frustum(camera.projection * camera.view);
+        registry.view<const AABB, Visibility>().each([&](const entt::entity entity, const AABB& aabb, Visibility&) {
+            if (!frustum.IsBoxVisible(aabb.min, aabb.max))
+                return;
+            numFrustum++;
+            if (enabled && !occlusionSystem.GetBuffer().IsBoxVisible(aabb.min, aabb.max))
+                numOccluded++;
+            else
+                expected.push_back(entity);
+        });
+        std::sort(expected.begin(), expected.end());
+        mismatches += CountMismatches(expected, visibleSet);
+    }
+
+    occlusionSystem.OnDetach();
+    cullingSystem.OnDetach();
+    registry.clear();
+
+    printf("%zu buildings, %u views: %.1f in the frustum, %llu occluded with occlusion on\n", numObjects, numViews,
+        double(numFrustum) / numViews, (unsigned long long)numOccluded);
+    printf("%llu mismatches against the frustum and occlusion buffer, %llu sort keys off\n", (unsigned long long)mismatches,
+        (unsigned long long)keyMismatches);
+    return mismatches == 0 && keyMismatches == 0 && numOccluded > 0 ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Every test prints what it measured and returns 0 when all of its checks passed
+int TestCull();
+int TestBvh();
+int TestCoherence();
+int TestContribution();
+int TestPvs();
+int TestPvsSystem();
+int TestGrid();
+int TestFrustumSystem();
+int TestOcclusionSystem();
+int TestOcclusion();
+int TestShadow();
+int TestParallelFor();
@@ -0,0 +1,44 @@
+#include <atomic>
+#include <cstdio>
+#include <future>
+#include <vector>
+
+#include <ge/core/Global.hpp>
+
+#include "Tests.hpp"
+
+// Every worker runs a ParallelFor of its own at the same time, the way a bake or a model load
+// on the pool culls or parses in parallel. Must finish with every item run exactly once.
+int TestParallelFor()
+{
+    auto& pool = GE::GlobalThreadPool();
+    const uint32_t outer = static_cast<uint32_t>(pool.Size() * 2);
+    const uint32_t inner = 1000;
+
+    std::vector<std::atomic<uint32_t>> runs(size_t(outer) * inner);
+    for (auto& count : runs)
+        count = 0;
+
+    std::vector<std::future<void>> tasks;
+    for (uint32_t o = 0; o < outer; o++)
+    {
+        tasks.push_back(pool.enqueue([&, o]() {
+            pool.ParallelFor(inner, [&](uint32_t i) { runs[size_t(o) * inner + i]++; });
+        }));
+    }
+
+    // And from the calling thread while the workers are still busy with the tasks above
+    pool.ParallelFor(outer, [&](uint32_t o) {
+        pool.ParallelFor(inner, [&](uint32_t i) { runs[size_t(o) * inner + i]++; }, 2);
+    });
+
+    for (auto& task : tasks)
+        task.wait();
+
+    uint32_t wrong = 0;
+    for (auto& count : runs)
+        wrong += count != 2;
+
+    printf("%u nested loops of %u items, %u items not run exactly twice\n", outer * 2, inner, wrong);
+    return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <ge/gfx/MeshClusters.hpp>
+
+// Per object cluster culling state. clusters points into the owning ModelObject and covers the
+// full resolution index range. ClusterCullingSystem fills ranges each frame; when active is
+// false the object is drawn through its regular range.
+struct ClusterCulling
+{
+	const GE::Gfx::MeshCluster* clusters{ nullptr };
+	uint32_t numClusters{ 0 };
+
+	bool active{ false };
+	std::vector<GE::Gfx::IndexRange> ranges;
+};
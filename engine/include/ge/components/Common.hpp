@@ -2,5 +2,12 @@
 
 #include <ge/components/AABB.hpp>
 #include <ge/components/CenterOfMass.hpp>
+#include <ge/components/ClusterCulling.hpp>
 #include <ge/components/Drawable.hpp>
+#include <ge/components/Dynamic.hpp>
+#include <ge/components/LevelOfDetail.hpp>
+#include <ge/components/MinScreenArea.hpp>
+#include <ge/components/Occluder.hpp>
+#include <ge/components/PvsObject.hpp>
+#include <ge/components/ResourceUsage.hpp>
 #include <ge/components/Visibility.hpp>
@@ -1,21 +1,58 @@
 #pragma once
 
+#include <vector>
+
+#include <glm/glm.hpp>
+
 #include <ge/gfx/Buffer.hpp>
 
 class Drawable
 {
 public:
+	// Indexed draw of one material, the G-buffer pass sorts these by material across drawables
+	struct DrawCommand
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t material;
+	};
+
 	virtual bool Buffer(VkCommandBuffer cmdBuffer, VkDescriptorSet* descriptor, uint32_t frameIndex) = 0;
-	virtual void Draw(VkCommandBuffer cmdBuffer, VkDescriptorSet* descriptor, uint32_t frameIndex) = 0;
+
+	// Binds every vertex stream and the index buffer for the commands below
+	virtual void Bind(VkCommandBuffer cmdBuffer) = 0;
+
+	// Index range to draw this frame, e.g. the selected level of detail
+	virtual void DrawRange(uint32_t& firstIndex, uint32_t& indexCount) const
+	{
+		firstIndex = 0;
+		indexCount = numIndices;
+	}
+
+	// Appends this frame's draws split by material; material agnostic passes use DrawRange
+	virtual void DrawCommands(std::vector<DrawCommand>& commands) const
+	{
+		uint32_t firstIndex, indexCount;
+		DrawRange(firstIndex, indexCount);
+		commands.push_back({ firstIndex, indexCount, 0 });
+	}
 
 	bool loaded = false;
 
 	GE::Gfx::VulkanVertexBuffer verticesBuffer;
 	GE::Gfx::VulkanVertexBuffer texCoordsBuffer;
 	GE::Gfx::VulkanVertexBuffer normalsBuffer;
-	GE::Gfx::VulkanVertexBuffer texIdsBuffer;
+	GE::Gfx::VulkanIndexBuffer indicesBuffer;
 
 	uint32_t numVerts{ 0 };
+	uint32_t numIndices{ 0 };
+
+	// Pushed to the quantized vertex shaders, position = offset + scale * unorm16 position
+	struct Dequantization
+	{
+		glm::vec4 offset{ 0.f };
+		glm::vec4 scale{ 1.f };
+	} dequantization;
 };
 
 struct Object
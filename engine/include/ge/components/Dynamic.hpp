@@ -0,0 +1,6 @@
+#pragma once
+
+// Tags an entity whose AABB moves. FrustumCullingSystem keeps these in a loose grid instead of
+// its static hierarchy, so their AABB must be written through registry.replace or
+// registry.patch for the change to reach it.
+struct Dynamic {};
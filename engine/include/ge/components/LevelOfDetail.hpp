@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ge/gfx/MeshSimplifier.hpp>
+
+// Per object level of detail state. errors[i] is the object space error of level i (0 for the
+// full resolution mesh) and radius bounds the object around its CenterOfMass. LodSystem
+// writes level every frame.
+struct LevelOfDetail
+{
+	float radius{ 0.f };
+	uint32_t numLevels{ 1 };
+	float errors[GE::Gfx::LodSettings::MaxLevels]{};
+	uint32_t level{ 0 };
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+// Overrides FrustumCullingSystem's pixel threshold for one entity, e.g. 0 for an object that must
+// stay visible however small it gets on screen
+struct MinScreenArea
+{
+	float pixels{ 0.f };
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Triangles an entity can hide others behind, usually its coarsest level of detail. The arrays
+// point into the owning ModelObject. OcclusionCullingSystem draws the largest on screen each frame.
+struct Occluder
+{
+	const glm::vec3* vertices{ nullptr };
+	const uint32_t* indices{ nullptr };
+	uint32_t indexCount{ 0 };
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// Index of a static entity in a baked Math::PotentiallyVisibleSet, the object's position in the
+// model it was baked from. FrustumCullingSystem drops the entity outside the camera cell's set.
+struct PvsObject
+{
+	uint32_t index{ 0 };
+};
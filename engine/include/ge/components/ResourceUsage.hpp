@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+
+#include <ge/utils/UUID.hpp>
+
+// Resources an entity needs to be drawn correctly, used to prioritize streaming.
+struct ResourceUsage
+{
+	std::vector<GE::Utils::UUID> resources;
+};
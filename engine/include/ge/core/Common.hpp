@@ -21,6 +21,9 @@
 
 namespace GE
 {
+	// Monotonic timestamp used for telemetry and streaming statistics.
+	int64_t NowMicroseconds();
+
 	class Trace
 	{
 	public:
@@ -12,6 +12,14 @@ namespace GE
 		Utils::UUID uuid;
 	};
 
+	// A resource that streams in pieces (e.g. the objects of a Model) made part number `part`
+	// usable. Triggered on the main thread in part order, possibly after ResourceLoaded.
+	struct ResourcePartLoaded
+	{
+		Utils::UUID uuid;
+		uint32_t part;
+	};
+
 	class ResourceSink : virtual public Sys::System
 	{
 	public:
@@ -30,8 +30,13 @@ namespace GE
 		class VulkanIndexBuffer : public VulkanBuffer
 		{
 		public:
-			void Create(std::size_t size);
+			void Create(std::size_t size, VkIndexType indexType = VK_INDEX_TYPE_UINT32);
 			void Bind(VkCommandBuffer& cmdBuffer);
+
+			VkIndexType IndexType() const { return _indexType; }
+
+		private:
+			VkIndexType _indexType{ VK_INDEX_TYPE_UINT32 };
 		};
 
 		class VulkanVertexBuffer : public VulkanBuffer
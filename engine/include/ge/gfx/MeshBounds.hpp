@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include <ge/components/AABB.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		struct MeshBounds
+		{
+			AABB aabb{ glm::vec3{ 0.f }, glm::vec3{ 0.f } };
+			glm::vec3 centerOfMass{ 0.f };	// Mean of the positions
+			float radius{ 0.f };			// Bounding sphere about centerOfMass
+		};
+
+		// Streams the positions four at a time with SSE where available: min, max and sum in
+		// one pass, then the sphere radius about the mean in a second one.
+		MeshBounds ComputeMeshBounds(const glm::vec3* positions, size_t vertexCount);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/math/FrustumCull.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		struct IndexRange
+		{
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+		// A small patch of triangles stored as a contiguous index range, with bounds for culling.
+		// The normal cone rejects the cluster when the camera is behind every triangle in it.
+		struct MeshCluster
+		{
+			glm::vec3 center;
+			float radius;
+			glm::vec3 coneAxis;
+			float coneCutoff;	// 1 when the triangles spread too far for a useful cone
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+		constexpr size_t MaxClusterVertices = 64;
+		constexpr size_t MaxClusterTriangles = 124;
+
+		// Groups triangles into clusters of at most maxVertices unique vertices and maxTriangles
+		// triangles, growing each cluster through shared vertices. destination receives the
+		// indices in cluster order (it may alias indices); cluster ranges are offset by
+		// firstIndex. Returns the number of clusters appended.
+		size_t BuildMeshClusters(std::vector<MeshCluster>& clusters, uint32_t* destination, const uint32_t* indices, size_t indexCount,
+			const glm::vec3* positions, size_t vertexCount, uint32_t firstIndex = 0,
+			size_t maxVertices = MaxClusterVertices, size_t maxTriangles = MaxClusterTriangles);
+
+		// Frustum and backface cone test per cluster; survivors are appended to ranges with
+		// neighbouring ranges merged to keep the draw count low. Returns the surviving triangles.
+		size_t CullMeshClusters(std::vector<IndexRange>& ranges, const MeshCluster* clusters, size_t clusterCount,
+			const Math::Frustum& frustum, const glm::vec3& cameraPosition);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		struct MeshOptimizerSettings
+		{
+			bool vertexCache{ true };
+			bool vertexFetch{ true };
+			bool overdraw{ false };
+			bool clusters{ true };	// Reorder LOD0 into cullable clusters, see MeshClusters.hpp
+		};
+
+		struct VertexCacheStatistics
+		{
+			uint64_t verticesTransformed{ 0 };
+			float acmr{ 0.f };	// Transformed vertices per triangle, 0.5 is the ideal for a regular grid
+			float atvr{ 0.f };	// Transformed vertices per referenced vertex, 1.0 is ideal
+		};
+
+		struct VertexFetchStatistics
+		{
+			uint64_t bytesFetched{ 0 };
+			float overfetch{ 0.f };	// Bytes fetched per byte of referenced vertex data, 1.0 is ideal
+		};
+
+		// The index functions below take triangle lists and allow destination == indices.
+
+		// Reorders triangles for post-transform cache hits using Forsyth's linear-speed
+		// vertex cache optimisation (32 entry LRU model).
+		void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+		// Reorders triangles so clusters facing away from the mesh centre are drawn first,
+		// without breaking up the cache friendly runs produced by OptimizeVertexCache.
+		void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount);
+
+		// Builds a remap table that orders vertices by first use in the index buffer.
+		// Unreferenced vertices map to 0xFFFFFFFF. Returns the number of referenced vertices.
+		size_t OptimizeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+		void RemapIndexBuffer(uint32_t* destination, const uint32_t* indices, size_t indexCount, const uint32_t* remap);
+
+		// destination must hold the count returned by OptimizeVertexFetchRemap and must not alias vertices.
+		template <typename T>
+		void RemapVertexBuffer(T* destination, const T* vertices, size_t vertexCount, const uint32_t* remap)
+		{
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				if (remap[i] != 0xFFFFFFFF)
+					destination[remap[i]] = vertices[i];
+			}
+		}
+
+		VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 32);
+		VertexFetchStatistics AnalyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+	}
+}
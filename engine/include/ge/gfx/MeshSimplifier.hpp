@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		struct LodSettings
+		{
+			static constexpr uint32_t MaxLevels = 8;
+
+			uint32_t maxLevels{ 4 };		// Including the full resolution level
+			float reduction{ 0.5f };		// Target triangle ratio between consecutive levels
+			float maxError{ 0.02f };		// Per level error budget, relative to the mesh extent
+			uint32_t minTriangles{ 32 };	// Objects smaller than this get no further levels
+		};
+
+		// Quadric error edge collapse simplification (Garland & Heckbert) onto existing vertices,
+		// so the result indexes the same vertex streams as the input. Open borders are preserved
+		// by extra edge quadrics and vertices on attribute seams are never moved.
+		//
+		// destination must hold indexCount entries and may alias indices. Stops once the index
+		// count reaches targetIndexCount or the next collapse would exceed targetError, which is
+		// relative to the mesh extent. resultError receives the largest collapse error in object
+		// space units. Returns the new index count.
+		size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount,
+			size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+		// Largest distance from any vertex referenced by indices to the surface described by lod.
+		// Brute force, meant for validating simplifier output offline.
+		float MeasureSimplificationError(const uint32_t* indices, size_t indexCount, const uint32_t* lod, size_t lodIndexCount, const glm::vec3* positions);
+	}
+}
@@ -5,28 +5,71 @@
 #include <glm/glm.hpp>
 #include <tiny_obj_loader.h>
 
-#include <ge/components/CenterOfMass.hpp>
+#include <ge/gfx/MeshBounds.hpp>
+#include <ge/gfx/MeshClusters.hpp>
+#include <ge/gfx/MeshOptimizer.hpp>
+#include <ge/gfx/MeshSimplifier.hpp>
+#include <ge/gfx/VertexQuantization.hpp>
 #include <ge/systems/ResourceSystem.hpp>
+#include <ge/utils/AppendList.hpp>
+#include <ge/utils/Arena.hpp>
+#include <ge/utils/DerivedDataCache.hpp>
 
 namespace GE
 {
 	namespace Gfx
 	{
+		// Contiguous run of triangles sharing one material, the unit of G-buffer draws
+		struct Submesh
+		{
+			// Faces the OBJ assigns no material, kept apart from material 0
+			static constexpr uint32_t NoMaterial = 0xFFFFFFFF;
+
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			uint32_t material;	// Index into Model::materials or NoMaterial
+		};
+
+		// Every array is a view into the arena of the Model that owns the object
 		struct ModelObject
 		{
-			std::vector<glm::vec3> vertices;
-			std::vector<glm::vec2> texCoords;
-			std::vector<glm::vec3> normals;
-			std::vector<glm::vec3> colors;
+			Utils::Span<glm::vec3> vertices;
+			Utils::Span<glm::vec2> texCoords;
+			Utils::Span<glm::vec3> normals;
+
+			// Computed on the loading thread, so entities can be culled before their buffers exist
+			MeshBounds bounds;
+
+			struct LodLevel
+			{
+				uint32_t firstIndex;
+				uint32_t indexCount;
+				float error;	// Object space, accumulated over the chain
+				uint32_t firstSubmesh;
+				uint32_t numSubmeshes;
+			};
 
-			CenterOfMass centerOfMass;
+			// Triangle lists into the deduplicated vertex streams above, one range per level of detail.
+			// Each level is sorted by material and split into submeshes, NoMaterial first and then
+			// ascending by material.
+			Utils::Span<uint32_t> indices;
+			Utils::Span<LodLevel> lods;
+			Utils::Span<Submesh> submeshes;
 
-			std::vector<float> texture_id;
+			// Partition of the LOD0 range that never crosses a submesh, empty when clustering is disabled
+			Utils::Span<MeshCluster> clusters;
+
+			// Filled for VertexFormat::Quantized, which then leaves texCoords and normals empty.
+			// vertices is kept for CPU side bounds and culling.
+			QuantizedVertexSpans quantized;
 		};
 
 		class Model : public Sys::Resource
 		{
 		public:
+			// Bump whenever the processed ModelObject layout or processing changes
+			static constexpr uint32_t ProcessorVersion = 9;
+
 			Model()
 				: Resource({})
 			{}
@@ -46,9 +89,27 @@ namespace GE
 			virtual void Unload() override;
 
 			virtual bool LimitToMainThread() override { return false; }
+			virtual uint32_t PublishedParts() const override { return static_cast<uint32_t>(objects.Size()); }
+
+			void LogIndexingStats(uint64_t numCorners) const;
+			bool LoadFromCache(const Utils::DerivedDataKey& key);
+			void SaveToCache(const Utils::DerivedDataKey& key) const;
 
-			std::vector<ModelObject> objects;
+			// Applied to every object at load time; part of the derived-data key
+			MeshOptimizerSettings optimizerSettings;
+			LodSettings lodSettings;
+			VertexFormat vertexFormat{ VertexFormat::Quantized };
+
+			// ParseObj on the thread pool, tinyobj only for files it hands back
+			bool parallelParser{ true };
+
+			// Each object is published as soon as it is processed, materials are complete before the first
 			std::vector<tinyobj::material_t> materials;
+			Utils::AppendList<ModelObject> objects;
+
+			// Backs every object array, sized from the corner count before processing (or the cache
+			// payload) and freed as a whole by Unload
+			Utils::Arena _arena;
 			std::string _path;
 			std::string _mtlPath;
 
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <tiny_obj_loader.h>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		// Parallel replacement for tinyobj::LoadObj with triangulation. The buffer is split at line
+		// boundaries into chunks that are tokenized on GlobalThreadPool(), then v/vt/vn/f records
+		// are merged in file order with relative indices rebased onto the global counts.
+		//
+		// Numbers, names and shape splitting follow tinyobj's rules so the output matches it
+		// exactly, polygons included, which are fanned around their first corner. Files with
+		// lines, points or malformed faces return false and should be handed to tinyobj, which
+		// owns those rules.
+		//
+		// mtlStream is read on every mtllib record, like tinyobj::MaterialStreamReader. maxThreads
+		// limits the threads working on the file, 0 uses every pool worker plus the caller.
+		bool ParseObj(const char* data, size_t size, std::istream* mtlStream, tinyobj::attrib_t& attrib,
+			std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& materials, std::string& warn,
+			uint32_t maxThreads = 0);
+	}
+}
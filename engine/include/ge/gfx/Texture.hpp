@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <ge/core/Global.hpp>
 #include <ge/gfx/Buffer.hpp>
@@ -19,12 +20,17 @@ namespace GE
 		class VulkanTexture : public VulkanGfxElement
 		{
 		public:
+			// Bump whenever decoding settings change so cached pixels are rebuilt
+			static constexpr uint32_t ProcessorVersion = 1;
+
 			virtual void Create(VkImageCreateInfo imageCreateInfo, VkImageViewCreateInfo imageViewCreateInfo);
 			virtual void Create(VkCommandBuffer& cmdBuffer);
 			virtual void Destroy();
 
 			void LoadFromStorage(const std::string& path);
+			void LoadFromMemory(const std::vector<char>& data);
 			void LoadFromEngineResources(const std::string& path);
+			void ReleaseStorage();
 			bool IsLoaded() { return _loaded.Get(); }
 
 			VkImage Image() { return _image; }
@@ -91,22 +97,36 @@ namespace GE
 			}
 
 			virtual void Load() override {
-				if (!_isLoaded)
+				if (!_isLoaded && !IsCancelled())
 				{
+					int64_t begin = NowMicroseconds();
 					_cmdBuffer.Create(1);
 					auto buffer = _cmdBuffer.GetBuffer();
 					_texture.Create(buffer);
 					_cmdBuffer.Destroy();
 					_isLoaded = true;
+
+					_bytesResident = static_cast<uint64_t>(_texture._width) * _texture._height * 4;
+					Trace(Sys::ResourceStage::Upload, begin, _bytesResident);
 				}
 			}
 
 			virtual bool LimitToMainThread() override { return true; }
 
 			virtual void LoadFromStorage() override {
-				if (!_isLoaded)
+				if (!_isLoaded && !IsCancelled())
 				{
-					_texture.LoadFromStorage(_path);
+					int64_t begin = NowMicroseconds();
+					auto data = Utils::LoadFile(_path.c_str());
+					_bytesRead = data.size();
+					Trace(Sys::ResourceStage::StorageRead, begin, _bytesRead);
+
+					if (IsCancelled())
+						return;
+
+					begin = NowMicroseconds();
+					_texture.LoadFromMemory(data);
+					Trace(Sys::ResourceStage::Parse, begin);
 				}
 			}
 
@@ -115,6 +135,11 @@ namespace GE
 				{
 					_texture.Destroy();
 					_isLoaded = false;
+					_bytesResident = 0;
+				}
+				else
+				{
+					_texture.ReleaseStorage();
 				}
 			}
 
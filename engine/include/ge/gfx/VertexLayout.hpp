@@ -0,0 +1,31 @@
+#pragma once
+
+#include <ge/gfx/Common.hpp>
+#include <ge/gfx/VertexQuantization.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		// Each stream lives in its own vertex buffer. Shader locations are fixed per stream,
+		// binding numbers follow the order of the streams that are present.
+		enum VertexStream : uint32_t
+		{
+			VertexStreamPosition = 1 << 0,	// location 0
+			VertexStreamTexCoord = 1 << 1,	// location 1
+			VertexStreamNormal = 1 << 2,	// location 2
+			VertexStreamAll = 0x7
+		};
+
+		struct VertexInputLayout
+		{
+			std::vector<VkVertexInputBindingDescription> bindings;
+			std::vector<VkVertexInputAttributeDescription> attributes;
+		};
+
+		VertexInputLayout GetVertexInputLayout(VertexFormat format, uint32_t streams = VertexStreamAll);
+
+		// Bytes per vertex over the requested streams
+		uint32_t GetVertexSize(VertexFormat format, uint32_t streams = VertexStreamAll);
+	}
+}
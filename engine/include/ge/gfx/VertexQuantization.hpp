@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/utils/Span.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		enum class VertexFormat : uint32_t
+		{
+			Float,		// vec3 position, vec2 uv, vec3 normal: 32 bytes
+			Quantized	// unorm16x4 position, half2 uv, octahedral snorm16x2 normal: 16 bytes
+		};
+
+		struct QuantizedPosition
+		{
+			uint16_t x, y, z, w;	// w is padding, 3 component 16 bit formats are rarely supported for vertex input
+		};
+
+		struct QuantizedNormal
+		{
+			int16_t x, y;
+		};
+
+		struct QuantizedTexCoord
+		{
+			uint16_t u, v;
+		};
+
+		// Positions are stored as 16 bit fractions of the object AABB: p = offset + scale * q / 65535,
+		// the offset and scale are handed to the vertex shader for dequantization.
+		struct QuantizedVertexStreams
+		{
+			glm::vec3 positionOffset{ 0.f };
+			glm::vec3 positionScale{ 1.f };
+
+			std::vector<QuantizedPosition> positions;
+			std::vector<QuantizedTexCoord> texCoords;
+			std::vector<QuantizedNormal> normals;
+		};
+
+		// The same streams as views, e.g. into a model arena
+		struct QuantizedVertexSpans
+		{
+			glm::vec3 positionOffset{ 0.f };
+			glm::vec3 positionScale{ 1.f };
+
+			Utils::Span<QuantizedPosition> positions;
+			Utils::Span<QuantizedTexCoord> texCoords;
+			Utils::Span<QuantizedNormal> normals;
+		};
+
+		struct QuantizationError
+		{
+			float position{ 0.f };	// Object space distance
+			float normal{ 0.f };	// Degrees
+			float texCoord{ 0.f };	// UV units
+		};
+
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t value);
+
+		QuantizedNormal EncodeOctahedral(const glm::vec3& normal);
+		glm::vec3 DecodeOctahedral(QuantizedNormal encoded);
+
+		glm::vec3 DequantizePosition(const QuantizedVertexStreams& streams, size_t vertex);
+
+		// texCoords and normals may be null, leaving that stream empty
+		void QuantizeVertices(QuantizedVertexStreams& streams, const glm::vec3* positions, const glm::vec2* texCoords,
+			const glm::vec3* normals, size_t vertexCount);
+
+		// Largest round trip error of each stream against the float source data
+		QuantizationError MeasureQuantizationError(const QuantizedVertexStreams& streams, const glm::vec3* positions,
+			const glm::vec2* texCoords, const glm::vec3* normals, size_t vertexCount);
+	}
+}
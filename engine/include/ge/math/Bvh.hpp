@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/FrustumCull.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		// Bounding volume hierarchy over static boxes, built with binned SAH. Nodes are stored
+		// depth first in one array: the left child follows its parent and skip points past the
+		// subtree, so the right child is the left child's skip. The items of every subtree are
+		// contiguous, which lets a subtree fully inside the frustum be accepted without visiting it.
+		class Bvh
+		{
+		public:
+			static constexpr uint32_t MaxLeafItems = 4;
+
+			// Deeper subtrees become leaves whatever their size, which bounds the recursion of
+			// building and culling on degenerate input such as long runs of lopsided splits
+			static constexpr uint32_t MaxDepth = 48;
+
+			struct Node
+			{
+				glm::vec3 min;
+				uint32_t skip;			// First node after this subtree, index + 1 for leaves
+				glm::vec3 max;
+				uint32_t firstItem;		// The subtree owns [firstItem, nodes[skip].firstItem)
+			};
+
+			struct CullStats
+			{
+				uint32_t nodesVisited{ 0 };
+				uint32_t itemsTested{ 0 };
+				uint32_t subtreesAccepted{ 0 };
+			};
+
+			void Build(const AABB* boxes, size_t count);
+			void Clear();
+
+			// Updates every node to the boxes, indexed as they were for Build, keeping the tree. Far
+			// cheaper than building again for boxes that moved a little; the tree gets looser the
+			// further they move.
+			void Refit(const AABB* boxes);
+
+			// Appends the index into the built boxes of every box passing Frustum::IsBoxVisible
+			void Cull(const Frustum& frustum, std::vector<uint32_t>& visible, CullStats* stats = nullptr) const;
+
+			// Cull for a camera moving smoothly: every node and leaf item remembers the plane that
+			// last culled it and tests that one first. Same result as Cull.
+			void CullCoherent(const Frustum& frustum, std::vector<uint32_t>& visible, CullStats* stats = nullptr);
+
+			bool Empty() const { return _items.empty(); }
+			size_t NumItems() const { return _items.size(); }
+			size_t NumNodes() const { return _nodes.empty() ? 0 : _nodes.size() - 1; }
+			uint32_t Depth() const { return _depth; }
+
+		private:
+			struct Builder;
+			struct Culler;
+
+			// Followed by a sentinel whose firstItem is the item count
+			std::vector<Node> _nodes;
+			std::vector<uint32_t> _items;
+			std::vector<AABB> _itemBounds;	// In item order, so leaves read sequentially
+			std::vector<uint8_t> _nodePlanes;	// Plane that last culled each node and item
+			std::vector<uint8_t> _itemPlanes;
+			uint32_t _depth{ 0 };
+		};
+	}
+}
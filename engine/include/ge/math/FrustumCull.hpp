@@ -2,6 +2,8 @@
 
 // Source: https://gist.github.com/podgorskiy/e698d18879588ada9014768e3e82a644
 
+#include <cstdint>
+
 #include <glm/glm.hpp>
 #include <glm/matrix.hpp>
 
@@ -20,6 +22,29 @@ namespace GE
 			// http://iquilezles.org/www/articles/frustumcorrect/frustumcorrect.htm
 			bool IsBoxVisible(const glm::vec3& minp, const glm::vec3& maxp) const;
 
+			// Conservative: spheres straddling two planes near a corner still pass
+			bool IsSphereVisible(const glm::vec3& center, float radius) const;
+
+			// IsBoxVisible for the planes in planeMask. Planes the box is fully in front of are
+			// cleared from the mask, so children of a box can skip them and an empty mask means
+			// fully inside.
+			bool ClassifyBox(const glm::vec3& minp, const glm::vec3& maxp, uint32_t& planeMask) const;
+
+			// ClassifyBox testing rejectPlane first, with the same result. The plane that rejects the
+			// box is stored back, NoPlane when none does: a box culled by a plane is most likely
+			// culled by the same plane next frame.
+			bool ClassifyBox(const glm::vec3& minp, const glm::vec3& maxp, uint32_t& planeMask, uint8_t& rejectPlane) const;
+
+			// Left, right, bottom, top, near, far; unnormalized, inside is positive
+			const glm::vec4* GetPlanes() const { return m_planes; }
+			const glm::vec3* GetCorners() const { return m_points; }
+			const glm::vec3& GetCornerMin() const { return m_cornerMin; }
+			const glm::vec3& GetCornerMax() const { return m_cornerMax; }
+			static constexpr int NumPlanes = 6;
+			static constexpr int NumCorners = 8;
+			static constexpr uint32_t AllPlanes = (1u << NumPlanes) - 1;
+			static constexpr uint8_t NoPlane = 0xff;
+
 		private:
 			enum Planes
 			{
@@ -42,8 +67,14 @@ namespace GE
 			template<Planes a, Planes b, Planes c>
 			glm::vec3 intersection(const glm::vec3* crosses) const;
 
+			// Plane culling the box, NoPlane when it is visible and Count when the corner bounds cull it
+			uint8_t RejectingPlane(const glm::vec3& minp, const glm::vec3& maxp, uint32_t& planeMask) const;
+			bool IsOutside(int plane, const glm::vec3& minp, const glm::vec3& maxp) const;
+
 			glm::vec4   m_planes[Count];
 			glm::vec3   m_points[8];
+			glm::vec3   m_cornerMin;
+			glm::vec3   m_cornerMax;
 		};
 
 		inline Frustum::Frustum(glm::mat4 m)
@@ -83,6 +114,14 @@ namespace GE
 			m_points[6] = intersection<Right, Bottom, Far>(crosses);
 			m_points[7] = intersection<Right, Top, Far>(crosses);
 
+			// All eight corners beyond a box face is the same as their bounds beyond it
+			m_cornerMin = m_cornerMax = m_points[0];
+			for (int i = 1; i < 8; i++)
+			{
+				m_cornerMin = glm::min(m_cornerMin, m_points[i]);
+				m_cornerMax = glm::max(m_cornerMax, m_points[i]);
+			}
+
 		}
 
 		// http://iquilezles.org/www/articles/frustumcorrect/frustumcorrect.htm
@@ -116,6 +155,63 @@ namespace GE
 			return true;
 		}
 
+		// Same operation order as CullBoxes, so both agree on every box
+		inline bool Frustum::IsOutside(int plane, const glm::vec3& minp, const glm::vec3& maxp) const
+		{
+			const glm::vec4& p = m_planes[plane];
+			glm::vec3 far{ p.x >= 0.f ? maxp.x : minp.x, p.y >= 0.f ? maxp.y : minp.y, p.z >= 0.f ? maxp.z : minp.z };
+			return ((p.x * far.x + p.y * far.y) + p.z * far.z) + p.w < 0.f;
+		}
+
+		inline uint8_t Frustum::RejectingPlane(const glm::vec3& minp, const glm::vec3& maxp, uint32_t& planeMask) const
+		{
+			if (maxp.x < m_cornerMin.x || minp.x > m_cornerMax.x || maxp.y < m_cornerMin.y || minp.y > m_cornerMax.y
+				|| maxp.z < m_cornerMin.z || minp.z > m_cornerMax.z)
+				return Count;
+
+			for (int i = 0; i < Count; i++)
+			{
+				if (!(planeMask & (1u << i)))
+					continue;
+
+				if (IsOutside(i, minp, maxp))
+					return static_cast<uint8_t>(i);
+
+				const glm::vec4& plane = m_planes[i];
+				glm::vec3 near{ plane.x >= 0.f ? minp.x : maxp.x, plane.y >= 0.f ? minp.y : maxp.y, plane.z >= 0.f ? minp.z : maxp.z };
+				if (((plane.x * near.x + plane.y * near.y) + plane.z * near.z) + plane.w >= 0.f)
+					planeMask &= ~(1u << i);
+			}
+			return NoPlane;
+		}
+
+		inline bool Frustum::ClassifyBox(const glm::vec3& minp, const glm::vec3& maxp, uint32_t& planeMask) const
+		{
+			return RejectingPlane(minp, maxp, planeMask) == NoPlane;
+		}
+
+		inline bool Frustum::ClassifyBox(const glm::vec3& minp, const glm::vec3& maxp, uint32_t& planeMask, uint8_t& rejectPlane) const
+		{
+			if (rejectPlane < Count && (planeMask & (1u << rejectPlane)) && IsOutside(rejectPlane, minp, maxp))
+				return false;
+
+			rejectPlane = RejectingPlane(minp, maxp, planeMask);
+			return rejectPlane == NoPlane;
+		}
+
+		inline bool Frustum::IsSphereVisible(const glm::vec3& center, float radius) const
+		{
+			for (int i = 0; i < Count; i++)
+			{
+				// Planes are not normalized, so scale the radius instead
+				glm::vec3 normal(m_planes[i]);
+				if (glm::dot(normal, center) + m_planes[i].w < -radius * glm::length(normal))
+					return false;
+			}
+
+			return true;
+		}
+
 		template<Frustum::Planes a, Frustum::Planes b, Frustum::Planes c>
 		inline glm::vec3 Frustum::intersection(const glm::vec3* crosses) const
 		{
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/math/FrustumCull.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		// Boxes as one array per component, padded to a multiple of BoundsSoA::Padding so the
+		// kernels never need a scalar tail
+		class BoundsSoA
+		{
+		public:
+			static constexpr size_t Padding = 16;
+
+			void Clear();
+			void Reserve(size_t count);
+			uint32_t Push(const glm::vec3& min, const glm::vec3& max);
+
+			size_t Size() const { return _size; }
+
+			const float* MinX() const { return _minX.data(); }
+			const float* MinY() const { return _minY.data(); }
+			const float* MinZ() const { return _minZ.data(); }
+			const float* MaxX() const { return _maxX.data(); }
+			const float* MaxY() const { return _maxY.data(); }
+			const float* MaxZ() const { return _maxZ.data(); }
+
+		private:
+			std::vector<float> _minX, _minY, _minZ;
+			std::vector<float> _maxX, _maxY, _maxZ;
+			size_t _size{ 0 };
+		};
+
+		enum class SimdLevel : uint32_t
+		{
+			Scalar,
+			Sse,		// 4 boxes per iteration
+			Avx2,		// 8
+			Avx512,		// 16
+		};
+
+		const char* ToString(SimdLevel level);
+
+		// Widest level the CPU and OS support, detected once
+		SimdLevel ActiveSimdLevel();
+
+		// Number of uint64_t words CullBoxes writes for count boxes
+		inline size_t VisibilityWords(size_t count) { return (count + 63) / 64; }
+
+		// Same test as Frustum::IsBoxVisible for every box: the corner of the box furthest along
+		// each plane normal against the plane, then the box against the frustum corner bounds.
+		// Bit i of visible is set when box i passes. Levels above ActiveSimdLevel() fall back to it.
+		void CullBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint64_t* visible);
+		void CullBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint64_t* visible, SimdLevel level);
+	}
+}
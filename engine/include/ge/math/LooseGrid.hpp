@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/FrustumCull.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		// Hashed loose grid for boxes that move. Each box lives in exactly one cell: the cell of
+		// its center on the finest level whose cells are at least as large as the box, so it never
+		// leaves the cell grown by half a cell on every side. Insert, update and remove are a hash
+		// lookup and a swap with the cell's last item; an update that stays in its cell only
+		// stores the new bounds.
+		//
+		// Queries walk the cells of every level overlapping the query bounds, or the occupied
+		// cells of the level when that is fewer, then test the items of cells they touch.
+		class LooseGrid
+		{
+		public:
+			static constexpr uint32_t MaxLevels = 16;
+			static constexpr uint32_t InvalidHandle = 0xFFFFFFFF;
+
+			struct QueryStats
+			{
+				uint32_t cellsVisited{ 0 };
+				uint32_t itemsTested{ 0 };
+			};
+
+			// cellSize is the edge of the finest cells, about the size of a typical box
+			explicit LooseGrid(float cellSize = 8.f);
+
+			// value is returned by the queries, e.g. an entity
+			uint32_t Insert(const AABB& bounds, uint32_t value);
+			void Update(uint32_t handle, const AABB& bounds);
+			void Remove(uint32_t handle);
+			void Clear();
+
+			size_t Size() const { return _numItems; }
+			size_t NumCells() const { return _cells.size() - _freeCells.size(); }
+
+			// Append the value of every box passing the test, exactly like the per box test would
+			void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& values, QueryStats* stats = nullptr) const;
+			void QueryBox(const glm::vec3& min, const glm::vec3& max, std::vector<uint32_t>& values, QueryStats* stats = nullptr) const;
+			void QuerySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& values, QueryStats* stats = nullptr) const;
+
+		private:
+			struct CellKey
+			{
+				uint32_t level;
+				glm::ivec3 coord;
+
+				bool operator==(const CellKey& other) const { return level == other.level && coord == other.coord; }
+			};
+
+			struct Item
+			{
+				AABB bounds;
+				CellKey key;	// Copy of the cell's key, so updates in place do not touch the cell
+				uint32_t value;
+				uint32_t cell;	// InvalidHandle while on the free list
+				uint32_t slot;	// Position in the cell's item list, or the next free item
+			};
+
+			struct Cell
+			{
+				CellKey key;
+				uint32_t occupiedSlot;	// Position in the level's occupied list
+				std::vector<uint32_t> items;
+			};
+
+			// Packed so queries covering many cells scan coordinates without touching the cells
+			struct OccupiedCell
+			{
+				glm::ivec3 coord;
+				uint32_t cell;
+			};
+
+			// Open addressed with linear probing, the cells are created and freed too often for
+			// node based maps
+			struct Slot
+			{
+				CellKey key;
+				uint32_t cell;	// InvalidHandle for empty slots
+			};
+
+			struct Level
+			{
+				float size;
+				float margin;		// Half a cell, more on the coarsest level when boxes outgrow it
+				glm::ivec3 first;	// Bounds of every coordinate used since the last Clear
+				glm::ivec3 last;
+				std::vector<OccupiedCell> occupied;
+			};
+
+			CellKey KeyOf(const AABB& bounds) const;
+			glm::ivec3 CoordOf(uint32_t level, const glm::vec3& point) const;
+			void LooseBounds(const Level& level, const glm::ivec3& coord, glm::vec3& min, glm::vec3& max) const;
+			uint32_t FindCell(const CellKey& key) const;
+			uint32_t FindOrAddCell(const CellKey& key);
+			void EraseSlot(const CellKey& key);
+			void GrowTable();
+			void Attach(uint32_t handle, const CellKey& key);
+			void Detach(uint32_t handle);
+
+			// Calls visit(level, coord, cell) for every occupied cell whose loose bounds may overlap
+			// [min, max]. The cell itself is not read, so visitors can reject it from its coordinate
+			template <typename Visitor>
+			void ForEachCell(const glm::vec3& min, const glm::vec3& max, Visitor&& visit) const;
+
+			Level _levels[MaxLevels];
+
+			std::vector<Item> _items;
+			uint32_t _freeItem{ InvalidHandle };
+			size_t _numItems{ 0 };
+
+			std::vector<Cell> _cells;
+			std::vector<uint32_t> _freeCells;
+			std::vector<Slot> _table;
+		};
+	}
+}
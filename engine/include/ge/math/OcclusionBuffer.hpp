@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		// Low resolution depth buffer for CPU occlusion culling. Occluder triangles are clipped to
+		// the near plane and rasterized at pixel centers into 8x4 pixel tiles, a tile row of pixels
+		// at a time with SIMD, keeping the nearest 1/w per pixel. Every tile also keeps its
+		// farthest pixel, so most occludee tests end on one compare per tile.
+		//
+		// Rasterize works on a range of tile rows, so rows can be split over threads. IsBoxVisible
+		// only reads and may run on many threads once every row is rasterized.
+		class OcclusionBuffer
+		{
+		public:
+			static constexpr uint32_t Width = 256;
+			static constexpr uint32_t Height = 128;
+			static constexpr uint32_t TileWidth = 8;
+			static constexpr uint32_t TileHeight = 4;
+			static constexpr uint32_t TilesX = Width / TileWidth;
+			static constexpr uint32_t TilesY = Height / TileHeight;
+
+			OcclusionBuffer();
+
+			// Starts a frame, dropping the previous frame's occluders
+			void Begin(const glm::mat4& viewProjection);
+
+			// Transforms and clips a triangle list, queuing the triangles for Rasterize
+			void AddOccluder(const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount);
+
+			// Clears and draws the queued triangles into tile rows [firstRow, endRow)
+			void Rasterize(uint32_t firstRow, uint32_t endRow);
+
+			// False only when every pixel the box covers holds an occluder nearer than the box.
+			// Boxes crossing the near plane are always visible.
+			bool IsBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+			size_t NumTriangles() const { return _triangles.size(); }
+
+			// 1/w of the nearest occluder at a pixel, 0 where nothing was drawn
+			float DepthAt(uint32_t x, uint32_t y) const;
+
+		private:
+			struct Triangle
+			{
+				// Edge and depth planes as a * x + b * y + c over pixel coordinates. c is kept in
+				// double and evaluated once per tile, so clipped vertices far off screen keep precision.
+				float edgeA[3];
+				float edgeB[3];
+				double edgeC[3];
+				float depthA;
+				float depthB;
+				double depthC;
+				int firstTileX, lastTileX;
+				int firstTileY, lastTileY;
+			};
+
+			void SetupTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2);
+
+			glm::mat4 _viewProjection{ 1.f };
+			std::vector<Triangle> _triangles;
+
+			// Tile major, each tile's pixels row by row
+			std::vector<float> _depth;
+			std::vector<float> _tileFar;
+		};
+	}
+}
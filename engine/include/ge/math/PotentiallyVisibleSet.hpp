@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/components/Occluder.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		// Baked visibility of a static scene: the volume the camera moves in is split into a grid
+		// of cells, and every cell stores a bitset of the objects visible from somewhere inside it.
+		// Bitsets are run length coded, alone or as the difference to a neighbouring cell's set,
+		// and cells with the same set share it. Cells the bake found no view from, e.g. inside
+		// solid geometry, are left uncovered and filter nothing.
+		class PotentiallyVisibleSet
+		{
+		public:
+			static constexpr uint32_t NoCell = 0xFFFFFFFF;
+			static constexpr uint32_t NoSet = 0xFFFFFFFF;
+
+			// Bump whenever the serialized layout or the coding changes
+			static constexpr uint32_t Version = 1;
+
+			// Starts an empty grid of cells, each cellSize on a side, with its first corner at origin
+			void Reset(const glm::vec3& origin, float cellSize, const glm::uvec3& cells, uint32_t numObjects);
+
+			// Covers a cell with VisibilityWords(NumObjects()) words of object bits
+			void SetCell(uint32_t cell, const uint64_t* bits);
+
+			std::vector<char> Serialize() const;
+			bool Deserialize(const std::vector<char>& data);
+
+			// NoCell outside the grid
+			uint32_t CellAt(const glm::vec3& position) const;
+
+			// Cells sharing a set id see the same objects. NoSet for uncovered cells.
+			uint32_t SetOf(uint32_t cell) const { return cell < _cellSets.size() ? _cellSets[cell] : NoSet; }
+
+			// Expands a set into bits, one per object
+			void Decode(uint32_t set, std::vector<uint64_t>& bits) const;
+
+			bool Empty() const { return _cellSets.empty(); }
+			uint32_t NumObjects() const { return _numObjects; }
+			uint32_t NumCells() const { return static_cast<uint32_t>(_cellSets.size()); }
+			uint32_t NumSets() const { return static_cast<uint32_t>(_setOffsets.size()) - 1; }
+			size_t CodedBytes() const { return _data.size(); }
+
+			const glm::vec3& GetOrigin() const { return _origin; }
+			float GetCellSize() const { return _cellSize; }
+			const glm::uvec3& GetCells() const { return _cells; }
+
+			// Lowest corner of a cell
+			glm::vec3 CellMin(uint32_t cell) const;
+
+		private:
+			// Set whose bits a set is coded against, NoSet for a plain set
+			uint32_t BaseOf(uint32_t set) const;
+
+			glm::vec3 _origin{ 0.f };
+			float _cellSize{ 1.f };
+			glm::uvec3 _cells{ 0 };
+			uint32_t _numObjects{ 0 };
+
+			std::vector<uint32_t> _cellSets;
+
+			// Set i is coded in [_setOffsets[i], _setOffsets[i + 1]): base set + 1 or 0, then the runs
+			std::vector<uint32_t> _setOffsets{ 0 };
+			std::vector<uint8_t> _data;
+
+			// Sets by the hash of their bits, only while baking
+			std::unordered_multimap<uint64_t, uint32_t> _setsByHash;
+		};
+
+		struct PvsBakeSettings
+		{
+			// Volume the camera can be in, rounded up to whole cells
+			glm::vec3 min{ 0.f };
+			glm::vec3 max{ 0.f };
+			float cellSize{ 2.f };
+
+			// Points visibility is sampled from per cell: the center, the corners, then random points
+			uint32_t samplesPerCell{ 9 };
+
+			// Also marks what neighbouring cells within this many cells see, covering views between samples
+			uint32_t dilation{ 1 };
+
+			uint32_t threads{ 1 };
+		};
+
+		struct PvsBakeStats
+		{
+			uint32_t cells{ 0 };
+			uint32_t uncovered{ 0 };	// No sample saw anything
+			uint64_t samples{ 0 };
+			uint64_t visibleBits{ 0 };	// Summed over covered cells
+			uint64_t triangles{ 0 };	// Rasterized, summed over every sample
+		};
+
+		// Renders the occluders around every sample point into a cube of OcclusionBuffers and
+		// marks the objects whose box shows in any face. occluders[i] belongs to objects[i] and
+		// may be empty. Cells are spread over the global thread pool.
+		PotentiallyVisibleSet BakePotentiallyVisibleSet(const AABB* objects, const Occluder* occluders, size_t count,
+			const PvsBakeSettings& settings, PvsBakeStats* stats = nullptr);
+	}
+}
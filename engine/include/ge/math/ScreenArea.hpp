@@ -0,0 +1,18 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		// Pixels inside the perspective projection of a sphere: the exact area of the ellipse it
+		// projects to, which grows towards the screen edges. focalPixels is the pixel size of one
+		// unit at distance 1, projection[1][1] * height / 2. Infinite once the sphere reaches the
+		// plane through the eye.
+		float ProjectedSphereArea(const glm::vec3& center, float radius, const glm::mat4& view, float focalPixels);
+
+		// ProjectedSphereArea of the box's bounding sphere, never less than the box covers
+		float ProjectedBoxArea(const glm::vec3& min, const glm::vec3& max, const glm::mat4& view, float focalPixels);
+	}
+}
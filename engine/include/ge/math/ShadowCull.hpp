@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/math/FrustumCull.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		static constexpr uint32_t CubeFaces = 6;
+
+		// View rotation of cube face i, in the +X, -X, +Y, -Y, +Z, -Z order of cube map layers,
+		// for a light at the origin
+		glm::mat4 CubeFaceRotation(uint32_t face);
+
+		// Shadow caster culling for an omnidirectional shadow cube. Builds the frustum of every
+		// face from the same matrices the faces render with, so a caster is drawn into exactly
+		// the faces it can cast into, and drops casters outside the light's range sphere before
+		// testing any face.
+		class ShadowCubeCuller
+		{
+		public:
+			struct Stats
+			{
+				uint32_t casters{ 0 };
+				uint32_t inRange{ 0 };
+				uint32_t faceDraws[CubeFaces]{};
+
+				uint32_t Draws() const;
+			};
+
+			// projection is the 90 degree face projection, range the radius the light reaches
+			ShadowCubeCuller(const glm::mat4& projection, const glm::vec3& lightPosition, float range);
+
+			// Clip matrix of a face: projection * CubeFaceRotation(face) * translate(-lightPosition)
+			const glm::mat4& GetFaceMatrix(uint32_t face) const { return _faceMatrices[face]; }
+			const Frustum& GetFace(uint32_t face) const { return _faces[face]; }
+
+			// Bit f is set when the box is in range and inside face f's frustum
+			uint32_t FaceMask(const glm::vec3& min, const glm::vec3& max) const;
+
+			// One pass over the boxes, appending each index to the list of every face it is drawn in
+			void Cull(const AABB* boxes, size_t count, std::vector<uint32_t> faceVisible[CubeFaces], Stats* stats = nullptr) const;
+
+		private:
+			glm::mat4 _faceMatrices[CubeFaces];
+			Frustum _faces[CubeFaces];
+			glm::vec3 _lightPosition;
+			float _range;
+		};
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ge/events/CameraEvents.hpp>
+#include <ge/systems/Systems.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		// Frustum and normal cone culls the clusters of visible objects drawn at full resolution,
+		// leaving the surviving index ranges in ClusterCulling. Runs after FrustumCullingSystem
+		// and LodSystem.
+		class ClusterCullingSystem : virtual public GE::Sys::System, public GE::Camera3DSink
+		{
+		public:
+			struct Stats
+			{
+				uint64_t objectTriangles{ 0 };	// Triangles of objects passing the object frustum test
+				uint64_t clusterTriangles{ 0 };	// Of those, triangles in surviving clusters
+				uint32_t ranges{ 0 };
+			};
+
+			ClusterCullingSystem() : GE::Sys::System("ClusterCullingSystem") {}
+			virtual void Update(int64_t tsMicroseconds) override;
+
+			void SetEnabled(bool enabled) { _enabled = enabled; }
+			bool IsEnabled() const { return _enabled; }
+
+			Stats GetStats() const { return _stats; }
+
+		private:
+			bool _enabled{ true };
+			Stats _stats;
+		};
+	}
+}
@@ -1,17 +1,151 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include <ge/components/Visibility.hpp>
 #include <ge/events/CameraEvents.hpp>
+#include <ge/math/Bvh.hpp>
+#include <ge/math/FrustumCullBatch.hpp>
+#include <ge/math/LooseGrid.hpp>
+#include <ge/math/PotentiallyVisibleSet.hpp>
 #include <ge/systems/Systems.hpp>
+#include <ge/systems/VisibleSet.hpp>
 
 namespace GE
 {
 	namespace Sys
 	{
+		// Culls every AABB against the camera frustum. Static AABBs go into a hierarchy, entities
+		// tagged Dynamic into a loose grid, both kept up to date from the registry's AABB signals
+		// so per frame cost follows what is visible and what moved. Statics added since the last
+		// build are culled one by one until streaming settles or they outgrow the hierarchy, then
+		// built in; changed ones are refitted and removed ones skipped until then. The linear path
+		// batches every box through Math::CullBoxes instead. Boxes in the frustum covering fewer
+		// pixels than the threshold are culled as well. With a baked PotentiallyVisibleSet, static
+		// entities the camera's cell cannot see are dropped first.
+		//
+		// Nothing is tested again while neither the camera nor any bounds changed, only what moved
+		// is while the camera stands still, and the hierarchy tests the plane that last culled a
+		// node first. Visibility and the VisibleSet are written every frame regardless, as later
+		// systems take entities out of them.
 		class FrustumCullingSystem : virtual public GE::Sys::System, public GE::Camera3DSink
 		{
 		public:
-			FrustumCullingSystem() : GE::Sys::System("FrustumCullingSystem") {}
+			struct Stats
+			{
+				uint32_t entities{ 0 };
+				uint32_t visible{ 0 };
+				uint32_t dynamic{ 0 };
+				uint32_t tooSmall{ 0 };	// In the frustum, under the pixel threshold
+				uint32_t pvsCulled{ 0 };	// Outside the potentially visible set of the camera's cell
+				uint32_t pending{ 0 };	// Statics waiting to be built into the hierarchy
+				bool reused{ false };	// Nothing moved, last frame's result was kept
+				Math::Bvh::CullStats bvh;
+				Math::LooseGrid::QueryStats grid;
+			};
+
+			FrustumCullingSystem();
 			virtual void Update(int64_t tsMicroseconds) override;
+
+			void Attach();
+			void Detach();
+
+			void SetHierarchical(bool hierarchical) { _hierarchical = hierarchical; }
+			bool IsHierarchical() const { return _hierarchical; }
+
+			// Entities whose bounding sphere covers fewer pixels are not drawn, 0 draws everything.
+			// A MinScreenArea component overrides it per entity.
+			void SetMinScreenArea(float pixels) { _minScreenArea = pixels; }
+			float GetMinScreenArea() const { return _minScreenArea; }
+
+			// Screen height the areas are measured at, keep it in step with the framebuffer.
+			// While 0 nothing is culled for its size.
+			void SetScreenHeight(uint32_t pixels) { _screenHeight = pixels; }
+
+			// Entities with a PvsObject component outside the set of the cell the camera is in are
+			// culled before the frustum test. The set must outlive its use, nullptr filters nothing.
+			void SetPotentiallyVisibleSet(const Math::PotentiallyVisibleSet* pvs);
+
+			Stats GetStats() const { return _stats; }
+
+			// Filled every frame alongside Visibility, OcclusionCullingSystem compacts it further
+			const VisibleSet& GetVisibleSet() const { return _visibleSet; }
+			VisibleSet& GetVisibleSet() { return _visibleSet; }
+
+			// Moving entities, for gameplay queries as well as culling
+			const Math::LooseGrid& GetDynamicGrid() const { return _grid; }
+
+		private:
+			// Statics pending past this many, or past the hierarchy's size, are built in right away
+			static constexpr size_t MinPendingRebuild = 1024;
+
+			// Frames without statics added or removed before the pending ones are built in
+			static constexpr uint32_t QuietFramesRebuild = 30;
+
+			void UpdateLinear(const glm::mat4& viewProjection, bool changed);
+			void UpdateHierarchical(const glm::mat4& viewProjection, bool cameraMoved);
+			bool WantsRebuild() const;
+			void Rebuild();
+			void Publish(entt::entity entity, const AABB& aabb, Visibility& visibility, Stats& stats);
+			void BoundsChanged() { _boundsVersion++; }
+			bool UpdatePvs();
+			bool InPvs(entt::entity entity) const;
+
+			void OnBoundsCreated(entt::registry& registry, entt::entity entity);
+			void OnBoundsChanged(entt::registry& registry, entt::entity entity);
+			void OnBoundsDestroyed(entt::registry& registry, entt::entity entity);
+			void OnDynamicCreated(entt::registry& registry, entt::entity entity);
+			void OnDynamicDestroyed(entt::registry& registry, entt::entity entity);
+			void AddStatic(entt::entity entity, const AABB& bounds);
+			void RemoveStatic(entt::registry& registry, entt::entity entity);
+			void AddDynamic(entt::entity entity, const AABB& bounds);
+			void RemoveDynamic(entt::entity entity);
+
+			bool _hierarchical{ true };
+			float _minScreenArea{ 1.f };
+			uint32_t _screenHeight{ 0 };
+			float _focalPixels{ 1.f };
+			Stats _stats;
+
+			// What the last result was culled against
+			bool _culled{ false };
+			bool _culledHierarchical{ true };
+			glm::mat4 _culledViewProjection{ 1.f };
+			uint64_t _boundsVersion{ 0 };
+			uint64_t _culledVersion{ 0 };
+
+			VisibleSet _visibleSet;
+
+			// Linear path
+			std::vector<entt::entity> _entities;
+			Math::BoundsSoA _bounds;
+			std::vector<uint64_t> _visibleBits;
+			bool _resetAll{ true };	// Visibility was written outside _visible, reset it all once
+
+			// Statics by slot, entt::null once removed. Slots below the hierarchy's item count are
+			// its items, the ones after are pending.
+			std::vector<entt::entity> _statics;
+			std::vector<AABB> _staticBounds;
+			std::unordered_map<entt::entity, uint32_t> _staticSlots;
+			Math::Bvh _bvh;
+			size_t _removedStatics{ 0 };	// Slots in the hierarchy set to entt::null
+			uint32_t _quietFrames{ 0 };
+			bool _staticDirty{ true };
+			bool _refit{ false };
+			std::vector<uint32_t> _visible;	// Slots
+
+			const Math::PotentiallyVisibleSet* _pvs{ nullptr };
+			uint32_t _pvsSet{ Math::PotentiallyVisibleSet::NoSet };	// Decoded into _pvsBits, NoSet filters nothing
+			std::vector<uint64_t> _pvsBits;
+			uint32_t _pvsCulled{ 0 };
+
+			Math::LooseGrid _grid;
+			std::unordered_map<entt::entity, uint32_t> _gridHandles;
+			std::vector<uint32_t> _dynamicVisible;
+			bool _dynamicDirty{ false };
 		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ge/events/CameraEvents.hpp>
+#include <ge/systems/Systems.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		// Picks a LevelOfDetail level per entity from the projected size of each level's error:
+		// the coarsest level whose error covers at most pixelError pixels on screen. Switching
+		// requires crossing the threshold by the hysteresis fraction so levels do not flicker.
+		class LodSystem : virtual public GE::Sys::System, public GE::Camera3DSink
+		{
+		public:
+			LodSystem(float pixelError = 1.f, float hysteresis = 0.25f)
+				: GE::Sys::System("LodSystem")
+				, _pixelError(pixelError)
+				, _hysteresis(hysteresis)
+			{}
+
+			virtual void Update(int64_t tsMicroseconds) override;
+
+			void SetPixelError(float pixelError) { _pixelError = pixelError; }
+			float GetPixelError() const { return _pixelError; }
+
+		private:
+			float _pixelError;
+			float _hysteresis;
+		};
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include <ge/components/AABB.hpp>
+#include <ge/events/CameraEvents.hpp>
+#include <ge/math/OcclusionBuffer.hpp>
+#include <ge/systems/FrustumCullingSystem.hpp>
+#include <ge/systems/Systems.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		// Draws the Occluder triangles of the entities largest on screen into a Math::OcclusionBuffer
+		// and clears Visibility of every visible AABB hidden behind them, removing them from the
+		// culling system's VisibleSet as well. Runs after FrustumCullingSystem and before anything
+		// reading Visibility; rasterization and the box tests are split over the thread pool.
+		class OcclusionCullingSystem : virtual public GE::Sys::System, public GE::Camera3DSink
+		{
+		public:
+			static constexpr uint32_t MaxOccluders = 32;
+			static constexpr uint32_t MaxOccluderTriangles = 16384;
+
+			struct Stats
+			{
+				uint32_t occluders{ 0 };
+				uint32_t triangles{ 0 };	// After clipping, as rasterized
+				uint32_t tested{ 0 };
+				uint32_t occluded{ 0 };
+				int64_t rasterizeMicroseconds{ 0 };
+				int64_t testMicroseconds{ 0 };
+			};
+
+			explicit OcclusionCullingSystem(FrustumCullingSystem* cullingSys)
+				: GE::Sys::System("OcclusionCullingSystem")
+				, _cullingSys(cullingSys)
+			{}
+			virtual void Update(int64_t tsMicroseconds) override;
+
+			void SetEnabled(bool enabled) { _enabled = enabled; }
+			bool IsEnabled() const { return _enabled; }
+
+			Stats GetStats() const { return _stats; }
+			const Math::OcclusionBuffer& GetBuffer() const { return _buffer; }
+
+		private:
+			struct Candidate
+			{
+				float size;
+				entt::entity entity;
+			};
+
+			void DrawOccluders(Stats& stats);
+			void TestOccludees(Stats& stats);
+
+			FrustumCullingSystem* _cullingSys;
+			bool _enabled{ true };
+			Stats _stats;
+
+			Math::OcclusionBuffer _buffer;
+			std::vector<Candidate> _candidates;
+			std::vector<AABB> _occludeeBounds;
+			std::vector<uint8_t> _occludeeVisible;
+		};
+	}
+}
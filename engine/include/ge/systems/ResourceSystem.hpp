@@ -1,13 +1,22 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
+#include <ge/core/Common.hpp>
+#include <ge/events/CameraEvents.hpp>
+#include <ge/systems/ResourceTelemetry.hpp>
 #include <ge/systems/Systems.hpp>
 #include <ge/utils/Common.hpp>
+#include <ge/utils/DerivedDataCache.hpp>
+#include <ge/utils/IndexedPriorityQueue.hpp>
 
 namespace GE
 {
@@ -19,6 +28,7 @@ namespace GE
 			ResourceData(std::string name, std::string path) : name(name), path(path) {}
 			std::string name;
 			std::string path;
+			uint32_t slot{ 0xFFFFFFFF };
 		};
 
 		class Resource
@@ -30,21 +40,71 @@ namespace GE
 			bool _isLoaded{ false };
 			bool _isLoadedFromStorage{ false };
 
+			// Reported to the telemetry timeline; loaders fill these in as they go.
+			uint64_t _bytesRead{ 0 };
+			uint64_t _bytesResident{ 0 };
+
 			ResourceData* _data{ nullptr };
+
+			// Set when the last reference goes away mid-load; loaders bail out at the next stage boundary.
+			Utils::CancellationToken _cancellation;
 			
 			std::string& GetPath() const { return _data->path; }
+			bool IsCancelled() const { return _cancellation.IsCancelled(); }
+
+			// Records [beginMicroseconds, now] for stage on the resource timeline.
+			void Trace(ResourceStage stage, int64_t beginMicroseconds, uint64_t bytes = 0) const;
 
 			virtual void Load() = 0;
 			virtual void LoadFromStorage() { _isLoadedFromStorage = true; };
 			virtual void Unload() = 0;
 
 			virtual bool LimitToMainThread() = 0;
+
+			// Pieces usable while Load() is still running, announced through ResourcePartLoaded.
+			// Called from the main thread concurrently with Load().
+			virtual uint32_t PublishedParts() const { return 0; }
+		};
+
+		struct StreamingStats
+		{
+			uint32_t pending{ 0 };
+			uint32_t pendingVisible{ 0 };
+			uint32_t cancelled{ 0 };
+			int64_t lastVisibleCompleteMicroseconds{ -1 };
+		};
+
+		// Index into the resource slot table plus the generation the slot had when the id was
+		// handed out. A slot bumps its generation whenever its resource is destroyed, so a stale
+		// id is detected with a single compare.
+		struct ResourceId
+		{
+			static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+			uint32_t index{ InvalidIndex };
+			uint32_t generation{ 0 };
+
+			bool IsValid() const { return index != InvalidIndex; }
 		};
 
-		class ResourceSystem : public System
+		struct ResourceSlot
+		{
+			ResourceData data;
+			Utils::UUID uuid{ (uint64_t)0 };
+			Resource* resource{ nullptr };
+			std::atomic<uint32_t> refCount{ 0 };
+			std::atomic<uint32_t> generation{ 1 };
+		};
+
+		class ResourceSystem : virtual public System, public Camera3DSink
 		{
 			ResourceSystem(const char* resourceManifest);
 		public:
+			// Requests whose priority reaches this value are needed by something on screen.
+			static constexpr float VisiblePriority = 1.f;
+
+			using PriorityCallback = std::function<float(const Utils::UUID& uuid)>;
+
 			static ResourceSystem& Get(const char* ManifestFile = nullptr) {
 				static ResourceSystem rs(ManifestFile ? ManifestFile : "Manifest.xml");
 				return rs;
@@ -57,48 +117,121 @@ namespace GE
 			Utils::UUID LookupResource(const std::string& path);
 			Resource* GetResource(Utils::UUID uuid);
 
+			// Replaces the default camera distance/visibility prioritization. Called once per
+			// queued request every frame, without the resource lock held; higher values are
+			// streamed first.
+			void SetPriorityCallback(PriorityCallback callback);
+
+			// Parks queued requests below minPriority that have waited longer than minAgeMicroseconds.
+			// Parked requests are re-queued as soon as their priority climbs back to minPriority.
+			void CancelStaleLoads(float minPriority, int64_t minAgeMicroseconds);
+
+			StreamingStats GetStreamingStats();
+
+			ResourceTelemetry& Telemetry() { return _telemetry; }
+			bool ExportTimeline(const std::string& path);
+			const char* NameOf(uint32_t slot) const { return slot < _numSlots ? _slots[slot].data.name.c_str() : "<unknown>"; }
+
+			// Takes a reference on the resource, creating and queueing it if this is the first one.
 			template<class T>
-			Resource* LoadResource(Utils::UUID& uuid, bool lazyLoad = true)
+			ResourceId AcquireResource(const Utils::UUID& uuid, bool lazyLoad = true)
 			{
 				LOCK(_mutex);
-				auto data = _availableResources.find(uuid);
-				if (data != _availableResources.end())
+				auto it = _slotLookup.find(uuid);
+				if (it == _slotLookup.end())
 				{
-					if (_resources.count(uuid) > 0)
-						return _resources[uuid];
+					GE_ASSERT(0, "Failed to find resource with uuid: {}", uuid);
+					return {};
+				}
+
+				ResourceSlot& slot = _slots[it->second];
+				slot.refCount.fetch_add(1, std::memory_order_relaxed);
+
+				if (!slot.resource)
+				{
+					T* resource = new T(&slot.data);
+					slot.resource = resource;
 
-					_resourceRefCounts[uuid]++;
-					T* resource = new T(&data->second);
 					if (lazyLoad)
-						_loadFromDiskResources.push_back(uuid);
+						_loadFromDiskResources.Push(it->second, 0.f, NowMicroseconds());
 					else
 					{
 						resource->LoadFromStorage();
 						resource->Load();
 					}
-
-					_resources[uuid] = resource;
-					return resource;
 				}
-				GE_ASSERT(0, "Failed to find resource with uuid: {}", uuid);
-				return nullptr;
+
+				return { it->second, slot.generation.load(std::memory_order_acquire) };
+			}
+
+			inline bool IsAlive(ResourceId id) const
+			{
+				return id.index < _numSlots && _slots[id.index].generation.load(std::memory_order_acquire) == id.generation;
+			}
+
+			inline Resource* Resolve(ResourceId id) const
+			{
+				return IsAlive(id) ? _slots[id.index].resource : nullptr;
+			}
+
+			// Under _mutex, so the last Release cannot destroy the slot between the check and the add
+			inline void AddRef(ResourceId id)
+			{
+				LOCK(_mutex);
+				if (IsAlive(id))
+					_slots[id.index].refCount.fetch_add(1, std::memory_order_relaxed);
 			}
 
-			void UnloadResource(const Utils::UUID& uuid);
+			void Release(ResourceId id);
 
 		private:
+			struct ParkedLoad
+			{
+				uint32_t slot;
+				float minPriority;
+				int64_t enqueuedAt;
+			};
+
+			struct PartialLoad
+			{
+				uint32_t slot;
+				int64_t requestedAt;
+				uint32_t announced;
+				bool finished;
+			};
+
+			void AnnounceParts();
+			void UpdatePriorities();
+			void UpdateUsagePriorities();
+			void CancelAllLoads();
+			void FinishLoad(uint32_t slot);
+			void DestroyResource(uint32_t slot);
+
 			const std::string _resourceManifest;
-			std::unordered_map<Utils::UUID, ResourceData> _availableResources;
-			std::unordered_map<Utils::UUID, Resource*> _resources;
-			std::unordered_map<Utils::UUID, uint32_t> _resourceRefCounts;
+			std::unique_ptr<ResourceSlot[]> _slots;
+			uint32_t _numSlots{ 0 };
+			std::unordered_map<Utils::UUID, uint32_t> _slotLookup;
 
-			std::deque<Utils::UUID> _loadResources;
-			std::deque<Utils::UUID> _loadFromDiskResources;
-			std::deque<Utils::UUID> _unloadResources;
+			std::deque<uint32_t> _loadResources;
+			Utils::IndexedPriorityQueue<uint32_t> _loadFromDiskResources;
+			std::deque<uint32_t> _unloadResources;
+			std::vector<ParkedLoad> _parkedResources;
+			std::vector<PartialLoad> _partialLoads;
+
+			PriorityCallback _priorityCallback;
+			std::vector<float> _priorities;	// Per slot, from the callback or UpdateUsagePriorities
+			std::unordered_map<uint32_t, int64_t> _requestTimes;
+			StreamingStats _stats;
+			ResourceTelemetry _telemetry;
+			int64_t _visibleRequestedAt{ -1 };
+			int64_t _loadWaveStartedAt{ -1 };
+			Utils::DerivedDataCache::Stats _loadWaveCacheStats;
 
 			std::mutex _mutex;
+			std::condition_variable _idleCondition;
 
-			int32_t _numProcessing = 0;
+			std::atomic<int32_t> _numProcessing{ 0 };
+			bool _draining{ false };
 		};
 
 		template <class T>
@@ -106,18 +239,82 @@ namespace GE
 		{
 		public:
 			ResourceHandle() {}
-			ResourceHandle(uint64_t uuid, bool lazyLoad = true) :_uuid(uuid) { data = (T*)ResourceSystem::Get().LoadResource<T>(_uuid, lazyLoad); }
-			ResourceHandle(Utils::UUID objUUID, bool lazyLoad = true) : _uuid(objUUID) { data = (T*)ResourceSystem::Get().LoadResource<T>(_uuid, lazyLoad); }
-			~ResourceHandle() { ResourceSystem::Get().UnloadResource(_uuid); }
+			ResourceHandle(uint64_t uuid, bool lazyLoad = true) : ResourceHandle(Utils::UUID(uuid), lazyLoad) {}
+			ResourceHandle(Utils::UUID objUUID, bool lazyLoad = true)
+			{
+				_id = ResourceSystem::Get().AcquireResource<T>(objUUID, lazyLoad);
+				_data = static_cast<T*>(ResourceSystem::Get().Resolve(_id));
+			}
 
-			void Load() { data->Load(); }
-			T& Get() { return *data; }
-			operator T& () { return *data; }
-			T* operator->() { return data; }
+			ResourceHandle(const ResourceHandle& other)
+				: _data(other._data)
+				, _id(other._id)
+			{
+				if (_data)
+					ResourceSystem::Get().AddRef(_id);
+			}
+
+			ResourceHandle(ResourceHandle&& other) noexcept
+				: _data(other._data)
+				, _id(other._id)
+			{
+				other._data = nullptr;
+				other._id = {};
+			}
+
+			ResourceHandle& operator=(const ResourceHandle& other)
+			{
+				if (this != &other)
+				{
+					ResourceHandle copy(other);
+					std::swap(_data, copy._data);
+					std::swap(_id, copy._id);
+				}
+				return *this;
+			}
+
+			ResourceHandle& operator=(ResourceHandle&& other) noexcept
+			{
+				if (this != &other)
+				{
+					Reset();
+					std::swap(_data, other._data);
+					std::swap(_id, other._id);
+				}
+				return *this;
+			}
+
+			~ResourceHandle() { Reset(); }
+
+			void Reset()
+			{
+				if (_data)
+					ResourceSystem::Get().Release(_id);
+
+				_data = nullptr;
+				_id = {};
+			}
+
+			// False once the underlying slot has been recycled, e.g. after the resource system was detached.
+			bool IsValid() const { return _data && ResourceSystem::Get().IsAlive(_id); }
+			ResourceId Id() const { return _id; }
+
+			void Load() { Resolve()->Load(); }
+			T& Get() { return *Resolve(); }
+			operator T& () { return *Resolve(); }
+			T* operator->() { return Resolve(); }
 
 		private:
-			T* data{ nullptr };
-			Utils::UUID _uuid;
+			// Goes through the slot rather than _data, so a recycled slot is caught instead of dereferenced
+			T* Resolve() const
+			{
+				T* data = static_cast<T*>(ResourceSystem::Get().Resolve(_id));
+				GE_ASSERT(data, "Resource handle used after its slot was recycled");
+				return data;
+			}
+
+			T* _data{ nullptr };
+			ResourceId _id;
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace GE
+{
+	namespace Sys
+	{
+		enum class ResourceStage : uint8_t
+		{
+			Requested,		// Waiting in the load queue
+			StorageRead,	// Reading source bytes from disk
+			Parse,			// Decoding/processing on the CPU
+			Upload,			// Creating GPU objects
+			FirstPart,		// First piece announced through ResourcePartLoaded, for resources that stream in parts
+			Ready,			// Resident and announced through ResourceLoaded
+			Count
+		};
+
+		const char* ToString(ResourceStage stage);
+
+		struct ResourceTimelineEvent
+		{
+			uint32_t slot;
+			ResourceStage stage;
+			uint32_t thread;
+			int64_t beginMicroseconds;
+			int64_t endMicroseconds;
+			uint64_t bytes;
+		};
+
+		struct ResourceStageTotals
+		{
+			uint32_t count{ 0 };
+			int64_t microseconds{ 0 };
+			uint64_t bytes{ 0 };
+		};
+
+		// Fixed size ring of load stage timings. Oldest events are overwritten once full, so
+		// recording never allocates and is safe from loader threads.
+		class ResourceTelemetry
+		{
+		public:
+			static constexpr size_t Capacity = 8192;
+
+			using TotalsArray = std::array<ResourceStageTotals, static_cast<size_t>(ResourceStage::Count)>;
+
+			ResourceTelemetry();
+
+			void Record(uint32_t slot, ResourceStage stage, int64_t beginMicroseconds, int64_t endMicroseconds, uint64_t bytes = 0);
+			void Clear();
+
+			// Copies the retained events, oldest first.
+			std::vector<ResourceTimelineEvent> Snapshot() const;
+
+			// Running totals since the last Clear(), unaffected by ring wrap-around.
+			TotalsArray Totals() const;
+
+			// Writes the retained events as Chrome trace JSON (chrome://tracing, Perfetto).
+			bool ExportChromeTrace(const std::string& path, const std::function<std::string(uint32_t slot)>& nameOf) const;
+
+		private:
+			mutable std::mutex _mutex;
+			std::vector<ResourceTimelineEvent> _events;
+			size_t _next{ 0 };
+			bool _wrapped{ false };
+			TotalsArray _totals;
+		};
+	}
+}
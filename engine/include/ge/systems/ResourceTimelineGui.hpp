@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include <ge/systems/Systems.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		// ImGui view of ResourceSystem telemetry: per-stage totals, which stage dominates,
+		// a per-thread timeline of recent loads and a Chrome trace export.
+		class ResourceTimelineGui : public System
+		{
+		public:
+			ResourceTimelineGui(const std::string& exportPath = "resource_timeline.json");
+
+			virtual void RenderGui() override;
+
+		private:
+			std::string _exportPath;
+			float _windowSeconds{ 2.f };
+		};
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		// The entities visible this frame, packed, each with the squared distance from the camera
+		// to its box center to sort by. FrustumCullingSystem fills it and OcclusionCullingSystem
+		// removes what it hides, so passes after culling walk only what is visible. The arrays
+		// keep their capacity from frame to frame.
+		struct VisibleSet
+		{
+			std::vector<entt::entity> entities;
+			std::vector<float> sortKeys;
+
+			size_t Size() const { return entities.size(); }
+			bool Empty() const { return entities.empty(); }
+
+			void Clear()
+			{
+				entities.clear();
+				sortKeys.clear();
+			}
+
+			void Push(entt::entity entity, float sortKey)
+			{
+				entities.push_back(entity);
+				sortKeys.push_back(sortKey);
+			}
+		};
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace GE
+{
+	namespace Utils
+	{
+		// Append-only list for one producer thread and any number of reader threads. Elements
+		// live in blocks that never move and Size() publishes them with release/acquire ordering,
+		// so readers may use [0, Size()) without a lock while the producer keeps appending.
+		// Clear() is the only operation that needs the readers to be gone.
+		template <typename T>
+		class AppendList
+		{
+		public:
+			template <typename List, typename Value>
+			class Iterator
+			{
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = T;
+				using difference_type = std::ptrdiff_t;
+				using pointer = Value*;
+				using reference = Value&;
+
+				Iterator(List* list, size_t index) : _list(list), _index(index) {}
+
+				reference operator*() const { return (*_list)[_index]; }
+				pointer operator->() const { return &(*_list)[_index]; }
+				Iterator& operator++() { _index++; return *this; }
+				Iterator operator++(int) { Iterator it = *this; _index++; return it; }
+				bool operator==(const Iterator& other) const { return _index == other._index; }
+				bool operator!=(const Iterator& other) const { return _index != other._index; }
+
+			private:
+				List* _list;
+				size_t _index;
+			};
+
+			using iterator = Iterator<AppendList, T>;
+			using const_iterator = Iterator<const AppendList, const T>;
+
+			AppendList() = default;
+			~AppendList() { Clear(); }
+
+			AppendList(const AppendList&) = delete;
+			AppendList& operator=(const AppendList&) = delete;
+
+			size_t Size() const { return _size.load(std::memory_order_acquire); }
+			bool Empty() const { return Size() == 0; }
+
+			T& operator[](size_t index) { size_t block = BlockOf(index); return _blocks[block][index - BlockBegin(block)]; }
+			const T& operator[](size_t index) const { size_t block = BlockOf(index); return _blocks[block][index - BlockBegin(block)]; }
+
+			T& Front() { return (*this)[0]; }
+			const T& Front() const { return (*this)[0]; }
+
+			// Iteration covers the elements published when begin()/end() are called
+			iterator begin() { return { this, 0 }; }
+			iterator end() { return { this, Size() }; }
+			const_iterator begin() const { return { this, 0 }; }
+			const_iterator end() const { return { this, Size() }; }
+
+			// Producer thread only
+			T& Push(T&& value)
+			{
+				size_t index = _size.load(std::memory_order_relaxed);
+				size_t block = BlockOf(index);
+				if (!_blocks[block])
+					_blocks[block] = std::allocator<T>().allocate(BlockCapacity(block));
+
+				T* element = _blocks[block] + (index - BlockBegin(block));
+				new (element) T(std::move(value));
+				_size.store(index + 1, std::memory_order_release);
+				return *element;
+			}
+
+			void Clear()
+			{
+				size_t size = _size.load(std::memory_order_relaxed);
+				for (size_t i = 0; i < size; i++)
+					(*this)[i].~T();
+
+				for (size_t block = 0; block < MaxBlocks; block++)
+				{
+					if (_blocks[block])
+						std::allocator<T>().deallocate(_blocks[block], BlockCapacity(block));
+					_blocks[block] = nullptr;
+				}
+				_size.store(0, std::memory_order_release);
+			}
+
+		private:
+			// Block b holds FirstBlockSize << b elements, doubling keeps the block table tiny
+			static constexpr size_t FirstBlockBits = 4;
+			static constexpr size_t MaxBlocks = 40;
+
+			static size_t BlockCapacity(size_t block) { return size_t(1) << (FirstBlockBits + block); }
+			static size_t BlockBegin(size_t block) { return ((size_t(1) << block) - 1) << FirstBlockBits; }
+
+			static size_t BlockOf(size_t index)
+			{
+				size_t block = 0;
+				while ((index >> FirstBlockBits) + 1 >= (size_t(2) << block))
+					block++;
+				return block;
+			}
+
+			T* _blocks[MaxBlocks]{};
+			std::atomic<size_t> _size{ 0 };
+		};
+	}
+}
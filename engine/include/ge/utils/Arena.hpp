@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <ge/utils/Span.hpp>
+
+namespace GE
+{
+	namespace Utils
+	{
+		// Bump allocator for trivially copyable data that dies together. Memory comes in blocks
+		// that never move, so spans stay valid until Reset(), which frees everything at once.
+		// Reserve() sizes the next block; a correct estimate makes the arena a single allocation.
+		// Allocation is not thread safe, reading handed out spans from other threads is.
+		class Arena
+		{
+		public:
+			struct Stats
+			{
+				size_t bytesReserved{ 0 };
+				size_t bytesUsed{ 0 };
+				uint32_t blocks{ 0 };
+			};
+
+			Arena() = default;
+			Arena(const Arena&) = delete;
+			Arena& operator=(const Arena&) = delete;
+
+			// Ensures the next bytes of allocations fit in a single block
+			void Reserve(size_t bytes);
+
+			template <typename T>
+			Span<T> Allocate(size_t count)
+			{
+				static_assert(std::is_trivially_copyable<T>::value, "Arena memory is never destructed");
+				if (count == 0)
+					return {};
+				return { static_cast<T*>(AllocateBytes(count * sizeof(T), alignof(T))), count };
+			}
+
+			template <typename T>
+			Span<T> Copy(const T* values, size_t count)
+			{
+				Span<T> span = Allocate<T>(count);
+				if (count)
+					std::memcpy(span.data(), values, count * sizeof(T));
+				return span;
+			}
+
+			template <typename T>
+			Span<T> Copy(const std::vector<T>& values)
+			{
+				return Copy(values.data(), values.size());
+			}
+
+			void Reset();
+
+			Stats GetStats() const { return _stats; }
+
+		private:
+			static constexpr size_t MinBlockSize = 1 << 20;
+
+			void* AllocateBytes(size_t bytes, size_t alignment);
+
+			std::vector<std::unique_ptr<char[]>> _blocks;
+			char* _cursor{ nullptr };
+			char* _end{ nullptr };
+			Stats _stats;
+		};
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace GE
+{
+	namespace Utils
+	{
+		// Shared flag polled by long running work between stages. Copies observe the same state.
+		class CancellationToken
+		{
+		public:
+			CancellationToken()
+				: _cancelled(std::make_shared<std::atomic<bool>>(false))
+			{}
+
+			void Cancel() { _cancelled->store(true, std::memory_order_release); }
+			void Reset() { _cancelled->store(false, std::memory_order_release); }
+			bool IsCancelled() const { return _cancelled->load(std::memory_order_acquire); }
+
+		private:
+			std::shared_ptr<std::atomic<bool>> _cancelled;
+		};
+	}
+}
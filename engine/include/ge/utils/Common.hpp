@@ -4,6 +4,7 @@
 
 #include <ge/utils/Assert.hpp>
 #include <ge/utils/BlobParser.hpp>
+#include <ge/utils/Cancellation.hpp>
 #include <ge/utils/FileLoading.hpp>
 #include <ge/utils/GuardedType.hpp>
 #include <ge/utils/Log.hpp>
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ge/utils/Span.hpp>
+
+namespace GE
+{
+	namespace Utils
+	{
+		uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+		// Identifies processed data by what it was built from and how. Bumping a processor's
+		// version invalidates everything it produced before.
+		struct DerivedDataKey
+		{
+			std::string processor;
+			uint32_t version{ 0 };
+			uint64_t sourceHash{ 0 };
+		};
+
+		// Appends 16-byte aligned sections so a cache file can be consumed in place.
+		class DerivedDataWriter
+		{
+		public:
+			template <typename T>
+			void Write(const T& value)
+			{
+				WriteBytes(&value, sizeof(T));
+			}
+
+			template <typename T>
+			void WriteArray(const std::vector<T>& values)
+			{
+				WriteArray(values.data(), values.size());
+			}
+
+			template <typename T>
+			void WriteArray(const Span<T>& values)
+			{
+				WriteArray(values.data(), values.size());
+			}
+
+			template <typename T>
+			void WriteArray(const T* values, size_t count)
+			{
+				uint64_t size = count * sizeof(T);
+				Write(size);
+				Align();
+				WriteBytes(values, static_cast<size_t>(size));
+			}
+
+			void WriteString(const std::string& value)
+			{
+				WriteArray(value.data(), value.size());
+			}
+
+			const std::vector<char>& Data() const { return _data; }
+
+		private:
+			void Align();
+			void WriteBytes(const void* data, size_t size);
+
+			std::vector<char> _data;
+		};
+
+		class DerivedDataReader
+		{
+		public:
+			DerivedDataReader(const std::vector<char>& data) : _data(data) {}
+
+			template <typename T>
+			bool Read(T& value)
+			{
+				return ReadBytes(&value, sizeof(T));
+			}
+
+			// Returns a pointer into the cache payload and the element count without copying.
+			template <typename T>
+			const T* ReadArray(size_t& count)
+			{
+				uint64_t size = 0;
+				if (Read(size))
+					Align();
+
+				if (_failed || size % sizeof(T) != 0 || size > _data.size() - _offset)
+				{
+					count = 0;
+					_failed = true;
+					return nullptr;
+				}
+
+				const T* values = reinterpret_cast<const T*>(_data.data() + _offset);
+				count = static_cast<size_t>(size / sizeof(T));
+				Skip(static_cast<size_t>(size));
+				return values;
+			}
+
+			template <typename T>
+			bool ReadArray(std::vector<T>& values)
+			{
+				size_t count = 0;
+				const T* data = ReadArray<T>(count);
+				values.assign(data, data + count);
+				return !_failed;
+			}
+
+			bool ReadString(std::string& value)
+			{
+				size_t count = 0;
+				const char* data = ReadArray<char>(count);
+				value.assign(data ? data : "", count);
+				return !_failed;
+			}
+
+			bool Failed() const { return _failed; }
+
+			// Bytes left in the payload, to bound counts read from it
+			size_t Remaining() const { return _data.size() - _offset; }
+
+		private:
+			void Align();
+			bool ReadBytes(void* data, size_t size);
+			void Skip(size_t size);
+
+			const std::vector<char>& _data;
+			size_t _offset{ 0 };
+			bool _failed{ false };
+		};
+
+		// On-disk store for post-processed assets (parsed meshes, decoded textures) so later
+		// launches can skip the processing step. Files live under resources/cache/.
+		class DerivedDataCache
+		{
+		public:
+			struct Stats
+			{
+				uint32_t hits{ 0 };
+				uint32_t misses{ 0 };
+				uint64_t bytesRead{ 0 };
+				uint64_t bytesWritten{ 0 };
+			};
+
+			static DerivedDataCache& Get() {
+				static DerivedDataCache cache;
+				return cache;
+			}
+
+			// Fills payload and returns true when a valid entry exists for key.
+			bool Load(const DerivedDataKey& key, std::vector<char>& payload);
+			void Store(const DerivedDataKey& key, const std::vector<char>& payload);
+
+			Stats GetStats() const;
+
+		private:
+			DerivedDataCache() {}
+
+			std::string PathFor(const DerivedDataKey& key) const;
+
+			std::atomic<uint32_t> _hits{ 0 };
+			std::atomic<uint32_t> _misses{ 0 };
+			std::atomic<uint64_t> _bytesRead{ 0 };
+			std::atomic<uint64_t> _bytesWritten{ 0 };
+			std::atomic<uint32_t> _nextTempFile{ 0 };	// Suffix of Store's temporary names
+		};
+	}
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace GE
+{
+	namespace Utils
+	{
+		// Max-heap that remembers where every key lives, so priorities can be changed
+		// (or entries removed) in place instead of re-queueing. Ties are served in
+		// insertion order.
+		template <typename Key, typename Hash = std::hash<Key>>
+		class IndexedPriorityQueue
+		{
+		public:
+			struct Entry
+			{
+				Key key;
+				float priority;
+				int64_t enqueuedAt;
+				uint64_t sequence;
+			};
+
+			bool Empty() const { return _heap.empty(); }
+			size_t Size() const { return _heap.size(); }
+			bool Contains(const Key& key) const { return _positions.count(key) > 0; }
+
+			void Push(const Key& key, float priority, int64_t timestamp)
+			{
+				if (Contains(key))
+				{
+					Update(key, priority);
+					return;
+				}
+
+				_heap.push_back({ key, priority, timestamp, _sequence++ });
+				_positions[key] = _heap.size() - 1;
+				SiftUp(_heap.size() - 1);
+			}
+
+			void Update(const Key& key, float priority)
+			{
+				auto it = _positions.find(key);
+				if (it == _positions.end())
+					return;
+
+				size_t index = it->second;
+				float previous = _heap[index].priority;
+				_heap[index].priority = priority;
+
+				if (priority > previous)
+					SiftUp(index);
+				else
+					SiftDown(index);
+			}
+
+			bool Remove(const Key& key)
+			{
+				auto it = _positions.find(key);
+				if (it == _positions.end())
+					return false;
+
+				size_t index = it->second;
+				size_t last = _heap.size() - 1;
+				if (index != last)
+				{
+					Swap(index, last);
+				}
+
+				_positions.erase(key);
+				_heap.pop_back();
+
+				if (index < _heap.size())
+				{
+					SiftUp(index);
+					SiftDown(index);
+				}
+				return true;
+			}
+
+			const Entry& Top() const { return _heap.front(); }
+
+			Entry Pop()
+			{
+				Entry top = _heap.front();
+				Remove(top.key);
+				return top;
+			}
+
+			// Recomputes every priority through fn(entry) and re-heapifies once, which is
+			// O(n) instead of O(n log n) for n individual updates.
+			template <typename Fn>
+			void Reprioritize(Fn&& fn)
+			{
+				for (auto& entry : _heap)
+				{
+					entry.priority = fn(static_cast<const Entry&>(entry));
+				}
+
+				for (size_t i = _heap.size() / 2; i-- > 0;)
+				{
+					SiftDown(i);
+				}
+			}
+
+			// Removes every entry for which fn(entry) returns true and hands it to out.
+			template <typename Fn>
+			void RemoveIf(Fn&& fn, std::vector<Entry>& out)
+			{
+				std::vector<Key> removed;
+				for (auto& entry : _heap)
+				{
+					if (fn(static_cast<const Entry&>(entry)))
+					{
+						out.push_back(entry);
+						removed.push_back(entry.key);
+					}
+				}
+
+				for (auto& key : removed)
+				{
+					Remove(key);
+				}
+			}
+
+			void Clear()
+			{
+				_heap.clear();
+				_positions.clear();
+			}
+
+			typename std::vector<Entry>::const_iterator begin() const { return _heap.begin(); }
+			typename std::vector<Entry>::const_iterator end() const { return _heap.end(); }
+
+		private:
+			bool Before(const Entry& a, const Entry& b) const
+			{
+				if (a.priority != b.priority)
+					return a.priority > b.priority;
+				return a.sequence < b.sequence;
+			}
+
+			void Swap(size_t a, size_t b)
+			{
+				std::swap(_heap[a], _heap[b]);
+				_positions[_heap[a].key] = a;
+				_positions[_heap[b].key] = b;
+			}
+
+			void SiftUp(size_t index)
+			{
+				while (index > 0)
+				{
+					size_t parent = (index - 1) / 2;
+					if (!Before(_heap[index], _heap[parent]))
+						break;
+
+					Swap(index, parent);
+					index = parent;
+				}
+			}
+
+			void SiftDown(size_t index)
+			{
+				for (;;)
+				{
+					size_t left = index * 2 + 1;
+					size_t right = left + 1;
+					size_t best = index;
+
+					if (left < _heap.size() && Before(_heap[left], _heap[best]))
+						best = left;
+					if (right < _heap.size() && Before(_heap[right], _heap[best]))
+						best = right;
+					if (best == index)
+						break;
+
+					Swap(index, best);
+					index = best;
+				}
+			}
+
+			std::vector<Entry> _heap;
+			std::unordered_map<Key, size_t, Hash> _positions;
+			uint64_t _sequence{ 0 };
+		};
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+namespace GE
+{
+	namespace Utils
+	{
+		// Non-owning view of a contiguous array. Mirrors the parts of std::span (C++20) the engine
+		// uses, so containers can be swapped for views without touching their readers.
+		template <typename T>
+		class Span
+		{
+		public:
+			Span() = default;
+			Span(T* data, size_t size) : _data(data), _size(size) {}
+
+			T* data() const { return _data; }
+			size_t size() const { return _size; }
+			bool empty() const { return _size == 0; }
+
+			T& operator[](size_t index) const { return _data[index]; }
+			T& front() const { return _data[0]; }
+			T& back() const { return _data[_size - 1]; }
+
+			T* begin() const { return _data; }
+			T* end() const { return _data + _size; }
+
+		private:
+			T* _data{ nullptr };
+			size_t _size{ 0 };
+		};
+	}
+}
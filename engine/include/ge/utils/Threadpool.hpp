@@ -1,6 +1,7 @@
 #pragma once
 
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <memory>
@@ -41,6 +42,13 @@ namespace GE
             }
 
             inline bool isEmpty() { return tasks.size() == 0; }
+            inline size_t Size() const { return workers.size(); }
+
+            // Runs work(i) for every i in [0, count) on up to maxThreads threads (0 for every worker)
+            // and returns once all are done. The calling thread claims items from the same counter
+            // as the workers, so it never waits on a task queued behind other work and may be a
+            // pool worker itself.
+            void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& work, uint32_t maxThreads = 0);
 
         private:
             std::vector<std::thread> workers;
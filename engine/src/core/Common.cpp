@@ -6,6 +6,11 @@
 
 namespace GE
 {
+	int64_t NowMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
 	Trace::Trace(std::string name)
 		: _name(name)
 	{
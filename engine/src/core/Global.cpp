@@ -1,6 +1,6 @@
 #include <ge/core/Global.hpp>
 
-#include <ge/utils/Common.hpp>
+#include <ge/utils/Log.hpp>
 
 namespace GE
 {
@@ -17,7 +17,7 @@ namespace GE
 
 	void Camera3DSink::Detach()
 	{
-		GE::GlobalDispatcher().sink<Camera3DData>().connect<&Camera3DSink::UpdateCameraData>(this);
+		GE::GlobalDispatcher().sink<Camera3DData>().disconnect<&Camera3DSink::UpdateCameraData>(this);
 	}
 
 	void Camera3DSink::UpdateCameraData(const Camera3DData& cameraData)
@@ -95,14 +95,15 @@ namespace GE
 			vkBindBufferMemory(*_core.device, buffer, bufferMemory, 0);
 		}
 
-		void VulkanIndexBuffer::Create(std::size_t size)
+		void VulkanIndexBuffer::Create(std::size_t size, VkIndexType indexType)
 		{
+			_indexType = indexType;
 			VulkanBuffer::Create(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, size);
 		}
 
 		void VulkanIndexBuffer::Bind(VkCommandBuffer& cmdBuffer)
 		{
-			vkCmdBindIndexBuffer(cmdBuffer, _buffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(cmdBuffer, _buffer, 0, _indexType);
 		}
 
 		void VulkanVertexBuffer::Create(std::size_t size)
@@ -0,0 +1,134 @@
+#include <ge/gfx/MeshBounds.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GE_MESH_BOUNDS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace GE
+{
+	namespace Gfx
+	{
+		namespace
+		{
+#ifdef GE_MESH_BOUNDS_SSE
+			// Four packed vec3s are three loads, x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3,
+			// shuffled into one register per component
+			inline void LoadTransposed(const float* p, __m128& x, __m128& y, __m128& z)
+			{
+				__m128 a = _mm_loadu_ps(p);
+				__m128 b = _mm_loadu_ps(p + 4);
+				__m128 c = _mm_loadu_ps(p + 8);
+
+				x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+				y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+				z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+			}
+
+			inline float HorizontalMin(__m128 v)
+			{
+				v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+				v = _mm_min_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_cvtss_f32(v);
+			}
+
+			inline float HorizontalMax(__m128 v)
+			{
+				v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+				v = _mm_max_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_cvtss_f32(v);
+			}
+
+			inline float HorizontalSum(__m128 v)
+			{
+				v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+				v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_cvtss_f32(v);
+			}
+#endif
+		}
+
+		MeshBounds ComputeMeshBounds(const glm::vec3* positions, size_t vertexCount)
+		{
+			MeshBounds bounds;
+			if (vertexCount == 0)
+				return bounds;
+
+			const float* p = &positions[0].x;
+			glm::vec3 min = positions[0];
+			glm::vec3 max = positions[0];
+			glm::vec3 sum{ 0.f };
+			size_t i = 0;
+
+#ifdef GE_MESH_BOUNDS_SSE
+			if (vertexCount >= 4)
+			{
+				__m128 minX = _mm_set1_ps(min.x), minY = _mm_set1_ps(min.y), minZ = _mm_set1_ps(min.z);
+				__m128 maxX = minX, maxY = minY, maxZ = minZ;
+				__m128 sumX = _mm_setzero_ps(), sumY = _mm_setzero_ps(), sumZ = _mm_setzero_ps();
+
+				for (; i + 4 <= vertexCount; i += 4)
+				{
+					__m128 x, y, z;
+					LoadTransposed(p + i * 3, x, y, z);
+
+					minX = _mm_min_ps(minX, x); minY = _mm_min_ps(minY, y); minZ = _mm_min_ps(minZ, z);
+					maxX = _mm_max_ps(maxX, x); maxY = _mm_max_ps(maxY, y); maxZ = _mm_max_ps(maxZ, z);
+					sumX = _mm_add_ps(sumX, x); sumY = _mm_add_ps(sumY, y); sumZ = _mm_add_ps(sumZ, z);
+				}
+
+				min = { HorizontalMin(minX), HorizontalMin(minY), HorizontalMin(minZ) };
+				max = { HorizontalMax(maxX), HorizontalMax(maxY), HorizontalMax(maxZ) };
+				sum = { HorizontalSum(sumX), HorizontalSum(sumY), HorizontalSum(sumZ) };
+			}
+#endif
+
+			for (; i < vertexCount; i++)
+			{
+				min = glm::min(min, positions[i]);
+				max = glm::max(max, positions[i]);
+				sum += positions[i];
+			}
+
+			glm::vec3 center = sum / static_cast<float>(vertexCount);
+			float radiusSquared = 0.f;
+			i = 0;
+
+#ifdef GE_MESH_BOUNDS_SSE
+			if (vertexCount >= 4)
+			{
+				__m128 centerX = _mm_set1_ps(center.x), centerY = _mm_set1_ps(center.y), centerZ = _mm_set1_ps(center.z);
+				__m128 maxDistance = _mm_setzero_ps();
+
+				for (; i + 4 <= vertexCount; i += 4)
+				{
+					__m128 x, y, z;
+					LoadTransposed(p + i * 3, x, y, z);
+
+					x = _mm_sub_ps(x, centerX);
+					y = _mm_sub_ps(y, centerY);
+					z = _mm_sub_ps(z, centerZ);
+					__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+					maxDistance = _mm_max_ps(maxDistance, distance);
+				}
+
+				radiusSquared = HorizontalMax(maxDistance);
+			}
+#endif
+
+			for (; i < vertexCount; i++)
+			{
+				glm::vec3 d = positions[i] - center;
+				radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+			}
+
+			bounds.aabb = { min, max };
+			bounds.centerOfMass = center;
+			bounds.radius = std::sqrt(radiusSquared);
+			return bounds;
+		}
+	}
+}
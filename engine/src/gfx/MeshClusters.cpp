@@ -0,0 +1,207 @@
+#include <ge/gfx/MeshClusters.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		namespace
+		{
+			void ComputeClusterBounds(MeshCluster& cluster, const uint32_t* indices, const glm::vec3* positions)
+			{
+				glm::vec3 min = positions[indices[0]];
+				glm::vec3 max = min;
+				glm::vec3 normalSum{ 0.f };
+
+				for (uint32_t i = 0; i < cluster.indexCount; i += 3)
+				{
+					const glm::vec3& a = positions[indices[i + 0]];
+					const glm::vec3& b = positions[indices[i + 1]];
+					const glm::vec3& c = positions[indices[i + 2]];
+
+					min = glm::min(min, glm::min(a, glm::min(b, c)));
+					max = glm::max(max, glm::max(a, glm::max(b, c)));
+
+					glm::vec3 normal = glm::cross(b - a, c - a);
+					float length = glm::length(normal);
+					if (length > 0.f)
+						normalSum += normal / length;
+				}
+
+				cluster.center = (min + max) * 0.5f;
+				cluster.radius = 0.f;
+				for (uint32_t i = 0; i < cluster.indexCount; i++)
+					cluster.radius = std::max(cluster.radius, glm::length(positions[indices[i]] - cluster.center));
+
+				cluster.coneAxis = glm::vec3{ 0.f };
+				cluster.coneCutoff = 1.f;
+
+				float axisLength = glm::length(normalSum);
+				if (axisLength <= 0.f)
+					return;
+
+				glm::vec3 axis = normalSum / axisLength;
+				float minDot = 1.f;
+				for (uint32_t i = 0; i < cluster.indexCount; i += 3)
+				{
+					const glm::vec3& a = positions[indices[i + 0]];
+					glm::vec3 normal = glm::cross(positions[indices[i + 1]] - a, positions[indices[i + 2]] - a);
+					float length = glm::length(normal);
+					if (length > 0.f)
+						minDot = std::min(minDot, glm::dot(axis, normal / length));
+				}
+
+				// Cones wider than a hemisphere can never reject anything
+				if (minDot <= 0.1f)
+					return;
+
+				cluster.coneAxis = axis;
+				cluster.coneCutoff = std::sqrt(1.f - minDot * minDot);
+			}
+		}
+
+		size_t BuildMeshClusters(std::vector<MeshCluster>& clusters, uint32_t* destination, const uint32_t* indices, size_t indexCount,
+			const glm::vec3* positions, size_t vertexCount, uint32_t firstIndex, size_t maxVertices, size_t maxTriangles)
+		{
+			size_t faceCount = indexCount / 3;
+			if (faceCount == 0)
+				return 0;
+
+			std::vector<uint32_t> source(indices, indices + indexCount);
+
+			std::vector<uint32_t> offsets(vertexCount + 1, 0);
+			for (size_t i = 0; i < indexCount; i++)
+				offsets[source[i] + 1]++;
+			for (size_t v = 0; v < vertexCount; v++)
+				offsets[v + 1] += offsets[v];
+
+			std::vector<uint32_t> adjacency(indexCount);
+			{
+				std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+				for (size_t i = 0; i < indexCount; i++)
+					adjacency[cursor[source[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+
+			std::vector<bool> emitted(faceCount, false);
+			std::vector<uint32_t> clusterOf(vertexCount, 0xFFFFFFFF);
+			std::vector<uint32_t> candidates;
+
+			size_t clustersBefore = clusters.size();
+			size_t output = 0;
+			size_t seedCursor = 0;
+
+			while (output < indexCount)
+			{
+				while (emitted[seedCursor])
+					seedCursor++;
+
+				uint32_t clusterId = static_cast<uint32_t>(clusters.size());
+				size_t clusterStart = output;
+				size_t numVertices = 0;
+				size_t numTriangles = 0;
+				glm::vec3 centroidSum{ 0.f };
+
+				candidates.clear();
+				candidates.push_back(static_cast<uint32_t>(seedCursor));
+
+				for (;;)
+				{
+					// Prefer triangles that add no new vertices, then the one nearest the cluster
+					int bestNew = 4;
+					float bestDistance = INFINITY;
+					uint32_t best = 0xFFFFFFFF;
+					glm::vec3 centroid = numVertices ? centroidSum / static_cast<float>(numVertices) : glm::vec3{ 0.f };
+
+					for (size_t c = 0; c < candidates.size();)
+					{
+						uint32_t f = candidates[c];
+						if (emitted[f])
+						{
+							candidates[c] = candidates.back();
+							candidates.pop_back();
+							continue;
+						}
+
+						int newVertices = 0;
+						for (int k = 0; k < 3; k++)
+							newVertices += clusterOf[source[f * 3 + k]] != clusterId;
+
+						if (numVertices + newVertices <= maxVertices)
+						{
+							float distance = numVertices ? glm::length(positions[source[f * 3]] - centroid) : 0.f;
+							if (newVertices < bestNew || (newVertices == bestNew && distance < bestDistance))
+							{
+								bestNew = newVertices;
+								bestDistance = distance;
+								best = f;
+							}
+						}
+						c++;
+					}
+
+					if (best == 0xFFFFFFFF)
+						break;
+
+					uint32_t f = best;
+					emitted[f] = true;
+					for (int k = 0; k < 3; k++)
+					{
+						uint32_t v = source[f * 3 + k];
+						destination[output++] = v;
+
+						if (clusterOf[v] == clusterId)
+							continue;
+
+						clusterOf[v] = clusterId;
+						centroidSum += positions[v];
+						numVertices++;
+
+						for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++)
+						{
+							if (!emitted[adjacency[a]])
+								candidates.push_back(adjacency[a]);
+						}
+					}
+
+					if (++numTriangles == maxTriangles)
+						break;
+				}
+
+				MeshCluster cluster;
+				cluster.firstIndex = firstIndex + static_cast<uint32_t>(clusterStart);
+				cluster.indexCount = static_cast<uint32_t>(output - clusterStart);
+				ComputeClusterBounds(cluster, destination + clusterStart, positions);
+				clusters.push_back(cluster);
+			}
+
+			return clusters.size() - clustersBefore;
+		}
+
+		size_t CullMeshClusters(std::vector<IndexRange>& ranges, const MeshCluster* clusters, size_t clusterCount,
+			const Math::Frustum& frustum, const glm::vec3& cameraPosition)
+		{
+			size_t triangles = 0;
+			for (size_t i = 0; i < clusterCount; i++)
+			{
+				const MeshCluster& cluster = clusters[i];
+
+				glm::vec3 toCluster = cluster.center - cameraPosition;
+				if (glm::dot(toCluster, cluster.coneAxis) >= cluster.coneCutoff * glm::length(toCluster) + cluster.radius)
+					continue;
+
+				if (!frustum.IsSphereVisible(cluster.center, cluster.radius))
+					continue;
+
+				triangles += cluster.indexCount / 3;
+				if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == cluster.firstIndex)
+					ranges.back().indexCount += cluster.indexCount;
+				else
+					ranges.push_back({ cluster.firstIndex, cluster.indexCount });
+			}
+
+			return triangles;
+		}
+	}
+}
@@ -0,0 +1,339 @@
+#include <ge/gfx/MeshOptimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		namespace
+		{
+			constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+			constexpr int CacheSize = 32;
+
+			// Scoring from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+			float VertexScore(int cachePosition, uint32_t liveTriangles)
+			{
+				if (liveTriangles == 0)
+					return -1.f;
+
+				float score = 0.f;
+				if (cachePosition >= 0)
+				{
+					if (cachePosition < 3)
+						score = 0.75f;
+					else
+						score = std::pow(1.f - (cachePosition - 3) * (1.f / (CacheSize - 3)), 1.5f);
+				}
+
+				return score + 2.f / std::sqrt(static_cast<float>(liveTriangles));
+			}
+
+			// Guards the in-place case (destination == indices)
+			const uint32_t* SourceIndices(uint32_t* destination, const uint32_t* indices, size_t indexCount, std::vector<uint32_t>& copy)
+			{
+				if (destination != indices)
+					return indices;
+
+				copy.assign(indices, indices + indexCount);
+				return copy.data();
+			}
+		}
+
+		void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+		{
+			std::vector<uint32_t> copy;
+			indices = SourceIndices(destination, indices, indexCount, copy);
+
+			size_t faceCount = indexCount / 3;
+			if (faceCount == 0)
+				return;
+
+			// Triangle adjacency per vertex; the live prefix of each range shrinks as triangles are emitted
+			std::vector<uint32_t> liveTriangles(vertexCount, 0);
+			for (size_t i = 0; i < indexCount; i++)
+				liveTriangles[indices[i]]++;
+
+			std::vector<uint32_t> offsets(vertexCount + 1, 0);
+			for (size_t v = 0; v < vertexCount; v++)
+				offsets[v + 1] = offsets[v] + liveTriangles[v];
+
+			std::vector<uint32_t> adjacency(indexCount);
+			{
+				std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+				for (size_t i = 0; i < indexCount; i++)
+					adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+
+			std::vector<int> cachePosition(vertexCount, -1);
+			std::vector<float> vertexScore(vertexCount);
+			for (size_t v = 0; v < vertexCount; v++)
+				vertexScore[v] = VertexScore(-1, liveTriangles[v]);
+
+			std::vector<float> triangleScore(faceCount);
+			std::vector<bool> emitted(faceCount, false);
+
+			size_t best = 0;
+			for (size_t f = 0; f < faceCount; f++)
+			{
+				triangleScore[f] = vertexScore[indices[f * 3 + 0]] + vertexScore[indices[f * 3 + 1]] + vertexScore[indices[f * 3 + 2]];
+				if (triangleScore[f] > triangleScore[best])
+					best = f;
+			}
+
+			uint32_t cache[CacheSize + 3];
+			size_t cacheCount = 0;
+			size_t inputCursor = 0;
+
+			for (size_t output = 0; output < faceCount; output++)
+			{
+				const uint32_t* triangle = &indices[best * 3];
+				destination[output * 3 + 0] = triangle[0];
+				destination[output * 3 + 1] = triangle[1];
+				destination[output * 3 + 2] = triangle[2];
+				emitted[best] = true;
+
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t v = triangle[k];
+					uint32_t* begin = &adjacency[offsets[v]];
+					uint32_t* end = begin + liveTriangles[v];
+					auto it = std::find(begin, end, static_cast<uint32_t>(best));
+					std::swap(*it, *(end - 1));
+					liveTriangles[v]--;
+				}
+
+				// Emitted triangle's vertices move to the front, everything else shifts back
+				uint32_t newCache[CacheSize + 3];
+				size_t newCount = 0;
+				newCache[newCount++] = triangle[0];
+				newCache[newCount++] = triangle[1];
+				newCache[newCount++] = triangle[2];
+				for (size_t i = 0; i < cacheCount; i++)
+				{
+					uint32_t v = cache[i];
+					if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+						newCache[newCount++] = v;
+				}
+
+				for (size_t i = 0; i < newCount; i++)
+				{
+					uint32_t v = newCache[i];
+					cachePosition[v] = i < CacheSize ? static_cast<int>(i) : -1;
+					vertexScore[v] = VertexScore(cachePosition[v], liveTriangles[v]);
+				}
+
+				cacheCount = std::min<size_t>(newCount, CacheSize);
+				std::copy(newCache, newCache + cacheCount, cache);
+
+				// Only triangles touching the cache changed score, so the next pick comes from them
+				float bestScore = -1.f;
+				size_t next = faceCount;
+				for (size_t i = 0; i < newCount; i++)
+				{
+					uint32_t v = newCache[i];
+					for (uint32_t a = offsets[v]; a < offsets[v] + liveTriangles[v]; a++)
+					{
+						uint32_t f = adjacency[a];
+						float score = vertexScore[indices[f * 3 + 0]] + vertexScore[indices[f * 3 + 1]] + vertexScore[indices[f * 3 + 2]];
+						triangleScore[f] = score;
+						if (score > bestScore)
+						{
+							bestScore = score;
+							next = f;
+						}
+					}
+				}
+
+				if (next == faceCount)
+				{
+					while (inputCursor < faceCount && emitted[inputCursor])
+						inputCursor++;
+					next = inputCursor;
+				}
+
+				best = next;
+			}
+		}
+
+		void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount)
+		{
+			std::vector<uint32_t> copy;
+			indices = SourceIndices(destination, indices, indexCount, copy);
+
+			size_t faceCount = indexCount / 3;
+			if (faceCount == 0)
+				return;
+
+			// Split at hard boundaries, where a triangle misses the cache on all three vertices.
+			// Reordering whole clusters then costs almost nothing in cache efficiency.
+			std::vector<uint32_t> clusters;
+			{
+				std::vector<uint64_t> insertedAt(vertexCount, 0);
+				uint64_t time = 0;
+				for (size_t f = 0; f < faceCount; f++)
+				{
+					int misses = 0;
+					for (int k = 0; k < 3; k++)
+					{
+						uint32_t v = indices[f * 3 + k];
+						if (insertedAt[v] == 0 || time - insertedAt[v] >= 16)
+						{
+							insertedAt[v] = ++time;
+							misses++;
+						}
+					}
+
+					if (misses == 3 || f == 0)
+						clusters.push_back(static_cast<uint32_t>(f));
+				}
+			}
+			clusters.push_back(static_cast<uint32_t>(faceCount));
+
+			glm::vec3 meshCentroid{ 0.f };
+			float meshArea = 0.f;
+			std::vector<glm::vec3> clusterCentroid(clusters.size() - 1, glm::vec3{ 0.f });
+			std::vector<glm::vec3> clusterNormal(clusters.size() - 1, glm::vec3{ 0.f });
+			std::vector<float> clusterArea(clusters.size() - 1, 0.f);
+
+			for (size_t c = 0; c + 1 < clusters.size(); c++)
+			{
+				for (uint32_t f = clusters[c]; f < clusters[c + 1]; f++)
+				{
+					const glm::vec3& a = positions[indices[f * 3 + 0]];
+					const glm::vec3& b = positions[indices[f * 3 + 1]];
+					const glm::vec3& d = positions[indices[f * 3 + 2]];
+
+					glm::vec3 normal = glm::cross(b - a, d - a);
+					float area = glm::length(normal);
+					glm::vec3 centroid = (a + b + d) / 3.f;
+
+					clusterCentroid[c] += centroid * area;
+					clusterNormal[c] += normal;
+					clusterArea[c] += area;
+				}
+
+				meshCentroid += clusterCentroid[c];
+				meshArea += clusterArea[c];
+			}
+
+			if (meshArea > 0.f)
+				meshCentroid /= meshArea;
+
+			std::vector<float> sortKey(clusters.size() - 1);
+			for (size_t c = 0; c < sortKey.size(); c++)
+			{
+				glm::vec3 centroid = clusterArea[c] > 0.f ? clusterCentroid[c] / clusterArea[c] : meshCentroid;
+				float length = glm::length(clusterNormal[c]);
+				glm::vec3 normal = length > 0.f ? clusterNormal[c] / length : glm::vec3{ 0.f };
+				sortKey[c] = glm::dot(centroid - meshCentroid, normal);
+			}
+
+			std::vector<uint32_t> order(sortKey.size());
+			for (uint32_t c = 0; c < order.size(); c++)
+				order[c] = c;
+
+			// Outward facing clusters far from the centre are the likeliest occluders
+			std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+			size_t output = 0;
+			for (uint32_t c : order)
+			{
+				size_t begin = clusters[c] * 3;
+				size_t end = clusters[c + 1] * 3;
+				std::copy(indices + begin, indices + end, destination + output);
+				output += end - begin;
+			}
+		}
+
+		size_t OptimizeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+		{
+			std::fill(remap, remap + vertexCount, InvalidIndex);
+
+			uint32_t next = 0;
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				uint32_t v = indices[i];
+				if (remap[v] == InvalidIndex)
+					remap[v] = next++;
+			}
+
+			return next;
+		}
+
+		void RemapIndexBuffer(uint32_t* destination, const uint32_t* indices, size_t indexCount, const uint32_t* remap)
+		{
+			for (size_t i = 0; i < indexCount; i++)
+				destination[i] = remap[indices[i]];
+		}
+
+		VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+		{
+			VertexCacheStatistics stats;
+			if (indexCount < 3)
+				return stats;
+
+			// FIFO post-transform cache, matching how most hardware batches vertices
+			std::vector<uint64_t> insertedAt(vertexCount, 0);
+			uint64_t referenced = 0;
+
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				uint32_t v = indices[i];
+				if (insertedAt[v] == 0)
+					referenced++;
+
+				if (insertedAt[v] == 0 || stats.verticesTransformed - insertedAt[v] >= cacheSize)
+					insertedAt[v] = ++stats.verticesTransformed;
+			}
+
+			stats.acmr = static_cast<float>(stats.verticesTransformed) / (indexCount / 3);
+			stats.atvr = static_cast<float>(stats.verticesTransformed) / referenced;
+			return stats;
+		}
+
+		VertexFetchStatistics AnalyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+		{
+			constexpr size_t LineSize = 64;
+			constexpr size_t CacheLines = 64;
+
+			VertexFetchStatistics stats;
+			if (indexCount == 0 || vertexSize == 0)
+				return stats;
+
+			std::vector<bool> referenced(vertexCount, false);
+			size_t uniqueVertices = 0;
+
+			size_t lines[CacheLines];
+			std::fill(lines, lines + CacheLines, ~size_t(0));
+			size_t nextLine = 0;
+
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				uint32_t v = indices[i];
+				if (!referenced[v])
+				{
+					referenced[v] = true;
+					uniqueVertices++;
+				}
+
+				size_t first = v * vertexSize / LineSize;
+				size_t last = (v * vertexSize + vertexSize - 1) / LineSize;
+				for (size_t line = first; line <= last; line++)
+				{
+					if (std::find(lines, lines + CacheLines, line) != lines + CacheLines)
+						continue;
+
+					lines[nextLine] = line;
+					nextLine = (nextLine + 1) % CacheLines;
+					stats.bytesFetched += LineSize;
+				}
+			}
+
+			stats.overfetch = static_cast<float>(stats.bytesFetched) / (uniqueVertices * vertexSize);
+			return stats;
+		}
+	}
+}
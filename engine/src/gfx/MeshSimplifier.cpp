@@ -0,0 +1,387 @@
+#include <ge/gfx/MeshSimplifier.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		namespace
+		{
+			constexpr float BorderWeight = 10.f;
+
+			enum class VertexKind : uint8_t
+			{
+				Manifold,	// Free to collapse onto any neighbour
+				Border,		// Only slides along its open border
+				Locked		// Attribute seam or non-manifold, never moves
+			};
+
+			struct Quadric
+			{
+				float a00{ 0 }, a11{ 0 }, a22{ 0 };
+				float a01{ 0 }, a02{ 0 }, a12{ 0 };
+				float b0{ 0 }, b1{ 0 }, b2{ 0 };
+				float c{ 0 };
+				float weight{ 0 };
+
+				void AddPlane(const glm::vec3& n, float d, float w)
+				{
+					a00 += n.x * n.x * w; a11 += n.y * n.y * w; a22 += n.z * n.z * w;
+					a01 += n.x * n.y * w; a02 += n.x * n.z * w; a12 += n.y * n.z * w;
+					b0 += n.x * d * w; b1 += n.y * d * w; b2 += n.z * d * w;
+					c += d * d * w;
+					weight += w;
+				}
+
+				void Add(const Quadric& q)
+				{
+					a00 += q.a00; a11 += q.a11; a22 += q.a22;
+					a01 += q.a01; a02 += q.a02; a12 += q.a12;
+					b0 += q.b0; b1 += q.b1; b2 += q.b2;
+					c += q.c;
+					weight += q.weight;
+				}
+
+				// Weighted mean squared distance from p to the accumulated planes
+				float Error(const glm::vec3& p) const
+				{
+					float rx = a00 * p.x + a01 * p.y + a02 * p.z;
+					float ry = a01 * p.x + a11 * p.y + a12 * p.z;
+					float rz = a02 * p.x + a12 * p.y + a22 * p.z;
+					float e = p.x * rx + p.y * ry + p.z * rz + 2.f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+					return weight > 0.f ? std::fabs(e) / weight : 0.f;
+				}
+			};
+
+			struct Collapse
+			{
+				uint32_t from;
+				uint32_t to;
+				float error;
+			};
+
+			uint64_t EdgeKey(uint32_t a, uint32_t b)
+			{
+				return (static_cast<uint64_t>(a) << 32) | b;
+			}
+
+			// Maps every vertex to the first vertex sharing its exact position, so split
+			// attribute seams are seen as one topological vertex.
+			std::vector<uint32_t> BuildPositionRemap(const glm::vec3* positions, size_t vertexCount)
+			{
+				std::vector<uint32_t> order(vertexCount);
+				for (uint32_t i = 0; i < vertexCount; i++)
+					order[i] = i;
+
+				auto less = [&](uint32_t a, uint32_t b) {
+					const glm::vec3& pa = positions[a];
+					const glm::vec3& pb = positions[b];
+					if (pa.x != pb.x) return pa.x < pb.x;
+					if (pa.y != pb.y) return pa.y < pb.y;
+					if (pa.z != pb.z) return pa.z < pb.z;
+					return a < b;
+				};
+				std::sort(order.begin(), order.end(), less);
+
+				std::vector<uint32_t> remap(vertexCount);
+				for (size_t i = 0; i < vertexCount; i++)
+				{
+					bool same = i > 0 && positions[order[i]] == positions[order[i - 1]];
+					remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+				}
+				return remap;
+			}
+
+			glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+			{
+				// Ericson, Real-Time Collision Detection 5.1.5
+				glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+				float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+				if (d1 <= 0.f && d2 <= 0.f) return a;
+
+				glm::vec3 bp = p - b;
+				float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+				if (d3 >= 0.f && d4 <= d3) return b;
+
+				float vc = d1 * d4 - d3 * d2;
+				if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) return a + ab * (d1 / (d1 - d3));
+
+				glm::vec3 cp = p - c;
+				float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+				if (d6 >= 0.f && d5 <= d6) return c;
+
+				float vb = d5 * d2 - d1 * d6;
+				if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) return a + ac * (d2 / (d2 - d6));
+
+				float va = d3 * d6 - d5 * d4;
+				if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+				float denom = 1.f / (va + vb + vc);
+				return a + ab * (vb * denom) + ac * (vc * denom);
+			}
+		}
+
+		size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount,
+			size_t targetIndexCount, float targetError, float* resultError)
+		{
+			std::vector<uint32_t> result(indices, indices + indexCount);
+			float maxError = 0.f;
+
+			if (resultError)
+				*resultError = 0.f;
+
+			if (indexCount < 3 || vertexCount == 0)
+			{
+				std::copy(result.begin(), result.end(), destination);
+				return result.size();
+			}
+
+			std::vector<uint32_t> positionRemap = BuildPositionRemap(positions, vertexCount);
+			std::vector<uint32_t> wedges(vertexCount, 0);
+			for (size_t v = 0; v < vertexCount; v++)
+				wedges[positionRemap[v]]++;
+
+			// Topology is classified on positions so seams do not look like open borders
+			std::unordered_set<uint64_t> edges;
+			edges.reserve(indexCount * 2);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				for (int k = 0; k < 3; k++)
+					edges.insert(EdgeKey(positionRemap[indices[i + k]], positionRemap[indices[i + (k + 1) % 3]]));
+			}
+
+			auto isOpen = [&](uint32_t a, uint32_t b) {
+				return edges.count(EdgeKey(positionRemap[b], positionRemap[a])) == 0;
+			};
+
+			std::vector<uint8_t> openEdges(vertexCount, 0);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t a = indices[i + k];
+					uint32_t b = indices[i + (k + 1) % 3];
+					if (isOpen(a, b))
+					{
+						openEdges[positionRemap[a]] = static_cast<uint8_t>(std::min(openEdges[positionRemap[a]] + 1, 255));
+						openEdges[positionRemap[b]] = static_cast<uint8_t>(std::min(openEdges[positionRemap[b]] + 1, 255));
+					}
+				}
+			}
+
+			std::vector<VertexKind> kind(vertexCount, VertexKind::Manifold);
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				uint32_t p = positionRemap[v];
+				if (wedges[p] > 1 || (openEdges[p] != 0 && openEdges[p] != 2))
+					kind[v] = VertexKind::Locked;
+				else if (openEdges[p] == 2)
+					kind[v] = VertexKind::Border;
+			}
+
+			glm::vec3 extentMin = positions[0], extentMax = positions[0];
+			for (size_t v = 1; v < vertexCount; v++)
+			{
+				extentMin = glm::min(extentMin, positions[v]);
+				extentMax = glm::max(extentMax, positions[v]);
+			}
+			glm::vec3 extent = extentMax - extentMin;
+			float scale = std::max(extent.x, std::max(extent.y, extent.z));
+			float errorLimit = targetError * scale;
+			float errorLimitSquared = errorLimit * errorLimit;
+
+			std::vector<Quadric> quadrics(vertexCount);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				const glm::vec3& p0 = positions[indices[i + 0]];
+				const glm::vec3& p1 = positions[indices[i + 1]];
+				const glm::vec3& p2 = positions[indices[i + 2]];
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+				if (area <= 0.f)
+					continue;
+
+				normal /= area;
+				float d = -glm::dot(normal, p0);
+				for (int k = 0; k < 3; k++)
+					quadrics[indices[i + k]].AddPlane(normal, d, area * 0.5f);
+
+				// A plane through each open edge, perpendicular to the face, pins the border in place
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t a = indices[i + k];
+					uint32_t b = indices[i + (k + 1) % 3];
+					if (!isOpen(a, b))
+						continue;
+
+					glm::vec3 edge = positions[b] - positions[a];
+					float length = glm::length(edge);
+					if (length <= 0.f)
+						continue;
+
+					glm::vec3 borderNormal = glm::normalize(glm::cross(edge / length, normal));
+					float borderD = -glm::dot(borderNormal, positions[a]);
+					quadrics[a].AddPlane(borderNormal, borderD, length * length * BorderWeight);
+					quadrics[b].AddPlane(borderNormal, borderD, length * length * BorderWeight);
+				}
+			}
+
+			auto canCollapse = [&](uint32_t from, uint32_t to) {
+				if (kind[from] == VertexKind::Locked || wedges[positionRemap[to]] > 1)
+					return false;
+				if (kind[from] == VertexKind::Border)
+					return kind[to] != VertexKind::Manifold && isOpen(from, to);
+				return true;
+			};
+
+			std::vector<Collapse> collapses;
+			std::vector<uint32_t> collapseTarget(vertexCount);
+			std::vector<bool> touched(vertexCount);
+			std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+			std::vector<uint32_t> adjacency;
+
+			// Each pass collapses a non-overlapping set of the cheapest edges, then rebuilds
+			while (result.size() > targetIndexCount)
+			{
+				collapses.clear();
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					for (int k = 0; k < 3; k++)
+					{
+						uint32_t a = result[i + k];
+						uint32_t b = result[i + (k + 1) % 3];
+
+						if (canCollapse(a, b))
+							collapses.push_back({ a, b, quadrics[a].Error(positions[b]) });
+						if (canCollapse(b, a))
+							collapses.push_back({ b, a, quadrics[b].Error(positions[a]) });
+					}
+				}
+
+				if (collapses.empty())
+					break;
+
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+				std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+				for (uint32_t v : result)
+					adjacencyOffsets[v + 1]++;
+				for (size_t v = 0; v < vertexCount; v++)
+					adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+				adjacency.resize(result.size());
+				{
+					std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+					for (size_t i = 0; i < result.size(); i++)
+						adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+
+				for (size_t v = 0; v < vertexCount; v++)
+					collapseTarget[v] = static_cast<uint32_t>(v);
+				std::fill(touched.begin(), touched.end(), false);
+
+				size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+				size_t trianglesRemoved = 0;
+				size_t applied = 0;
+
+				for (auto& collapse : collapses)
+				{
+					if (collapse.error > errorLimitSquared || trianglesRemoved >= trianglesToRemove)
+						break;
+					if (touched[collapse.from] || touched[collapse.to])
+						continue;
+
+					// Reject collapses that flip any surviving triangle around from
+					bool flips = false;
+					size_t removes = 0;
+					for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && !flips; a++)
+					{
+						const uint32_t* tri = &result[adjacency[a] * 3];
+						if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+						{
+							removes++;
+							continue;
+						}
+
+						glm::vec3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+						glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+						for (int k = 0; k < 3; k++)
+						{
+							if (tri[k] == collapse.from)
+								p[k] = positions[collapse.to];
+						}
+						glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+						flips = glm::dot(before, after) <= 0.f;
+					}
+
+					if (flips)
+						continue;
+
+					collapseTarget[collapse.from] = collapse.to;
+					quadrics[collapse.to].Add(quadrics[collapse.from]);
+					maxError = std::max(maxError, collapse.error);
+					trianglesRemoved += removes;
+					applied++;
+
+					// Everything sharing a triangle with from is frozen until the next pass
+					for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++)
+					{
+						const uint32_t* tri = &result[adjacency[a] * 3];
+						touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+					}
+				}
+
+				if (applied == 0)
+					break;
+
+				size_t write = 0;
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					uint32_t a = collapseTarget[result[i + 0]];
+					uint32_t b = collapseTarget[result[i + 1]];
+					uint32_t c = collapseTarget[result[i + 2]];
+					if (a == b || b == c || a == c)
+						continue;
+
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+				result.resize(write);
+			}
+
+			if (resultError)
+				*resultError = std::sqrt(maxError);
+
+			std::copy(result.begin(), result.end(), destination);
+			return result.size();
+		}
+
+		float MeasureSimplificationError(const uint32_t* indices, size_t indexCount, const uint32_t* lod, size_t lodIndexCount, const glm::vec3* positions)
+		{
+			std::vector<uint32_t> vertices(indices, indices + indexCount);
+			std::sort(vertices.begin(), vertices.end());
+			vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+			float maxDistance = 0.f;
+			for (uint32_t v : vertices)
+			{
+				const glm::vec3& p = positions[v];
+				float best = INFINITY;
+				for (size_t i = 0; i + 2 < lodIndexCount && best > 0.f; i += 3)
+				{
+					glm::vec3 closest = ClosestPointOnTriangle(p, positions[lod[i]], positions[lod[i + 1]], positions[lod[i + 2]]);
+					best = std::min(best, glm::length(p - closest));
+				}
+				maxDistance = std::max(maxDistance, best);
+			}
+
+			return lodIndexCount >= 3 ? maxDistance : 0.f;
+		}
+	}
+}
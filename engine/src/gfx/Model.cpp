@@ -1,5 +1,6 @@
 #include "ge/gfx/Model.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 #include <ge/core/Common.hpp>
@@ -7,6 +8,7 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
+#include <ge/gfx/ObjParser.hpp>
 #include <ge/utils/FileLoading.hpp>
 
 namespace
@@ -19,6 +21,331 @@ namespace
 			std::streambuf::setg(vec.data(), vec.data(), vec.data() + vec.size());
 		}
 	};
+
+	// Open addressing table from an OBJ attribute tuple (v/vt/vn plus material) to the
+	// vertex already emitted for it. Linear probing over a power of two table that is
+	// at least twice the number of face corners keeps probe chains short.
+	class VertexDeduplicator
+	{
+	public:
+		void Reset(size_t numCorners)
+		{
+			size_t capacity = 16;
+			while (capacity < numCorners * 2)
+				capacity <<= 1;
+
+			_entries.assign(capacity, Entry{});
+			_mask = capacity - 1;
+		}
+
+		uint32_t Find(const tinyobj::index_t& idx, int material, uint32_t next, bool& inserted)
+		{
+			Entry key{ idx.vertex_index, idx.texcoord_index, idx.normal_index, material, next };
+
+			for (size_t slot = Hash(key) & _mask;; slot = (slot + 1) & _mask)
+			{
+				Entry& entry = _entries[slot];
+				if (entry.index == Empty)
+				{
+					entry = key;
+					inserted = true;
+					return next;
+				}
+
+				if (entry.vertex == key.vertex && entry.texCoord == key.texCoord && entry.normal == key.normal && entry.material == key.material)
+				{
+					inserted = false;
+					return entry.index;
+				}
+			}
+		}
+
+	private:
+		static constexpr uint32_t Empty = 0xFFFFFFFF;
+
+		struct Entry
+		{
+			int vertex{ -1 };
+			int texCoord{ -1 };
+			int normal{ -1 };
+			int material{ -1 };
+			uint32_t index{ Empty };
+		};
+
+		static size_t Hash(const Entry& entry)
+		{
+			uint64_t h = static_cast<uint32_t>(entry.vertex) * 0x9E3779B97F4A7C15ull;
+			h ^= static_cast<uint32_t>(entry.texCoord) * 0xC2B2AE3D27D4EB4Full;
+			h ^= static_cast<uint32_t>(entry.normal) * 0x165667B19E3779F9ull;
+			h ^= static_cast<uint32_t>(entry.material) * 0x27D4EB2F165667C5ull;
+			return static_cast<size_t>(h ^ (h >> 29));
+		}
+
+		std::vector<Entry> _entries;
+		size_t _mask{ 0 };
+	};
+
+	// Growable working copy of one object. A single builder is reused for every shape so its
+	// vectors keep their capacity, and only the finished arrays are copied into the model arena.
+	struct ObjectBuilder
+	{
+		std::vector<glm::vec3> vertices;
+		std::vector<glm::vec2> texCoords;
+		std::vector<glm::vec3> normals;
+		std::vector<uint32_t> vertexMaterials;
+		std::vector<uint32_t> indices;
+		std::vector<GE::Gfx::ModelObject::LodLevel> lods;
+		std::vector<GE::Gfx::Submesh> submeshes;
+		std::vector<GE::Gfx::MeshCluster> clusters;
+		GE::Gfx::QuantizedVertexStreams quantized;
+
+		void Reset(size_t numCorners)
+		{
+			vertices.clear();
+			texCoords.clear();
+			normals.clear();
+			vertexMaterials.clear();
+			indices.clear();
+			lods.clear();
+			submeshes.clear();
+			clusters.clear();
+
+			vertices.reserve(numCorners);
+			texCoords.reserve(numCorners);
+			normals.reserve(numCorners);
+			vertexMaterials.reserve(numCorners);
+			indices.reserve(numCorners);
+		}
+	};
+
+	template <typename T>
+	void RemapStream(std::vector<T>& stream, const std::vector<uint32_t>& remap, size_t uniqueVertices)
+	{
+		if (stream.size() != remap.size())
+			return;
+
+		std::vector<T> remapped(uniqueVertices);
+		GE::Gfx::RemapVertexBuffer(remapped.data(), stream.data(), stream.size(), remap.data());
+		stream.swap(remapped);
+	}
+
+	// Stable counting sort of the triangles in one index range by material, appending a submesh
+	// for every material that occurs. Vertices never span materials since the material is part
+	// of the deduplication key, so the first corner decides. Buckets are material + 1, which
+	// wraps Submesh::NoMaterial around to the first one.
+	void SortByMaterial(std::vector<GE::Gfx::Submesh>& submeshes, uint32_t* indices, uint32_t firstIndex, uint32_t indexCount,
+		const std::vector<uint32_t>& vertexMaterials)
+	{
+		uint32_t* range = indices + firstIndex;
+		uint32_t numBuckets = 0;
+		for (uint32_t i = 0; i < indexCount; i += 3)
+			numBuckets = std::max(numBuckets, vertexMaterials[range[i]] + 2);
+
+		std::vector<uint32_t> offsets(numBuckets + 1, 0);
+		for (uint32_t i = 0; i < indexCount; i += 3)
+			offsets[vertexMaterials[range[i]] + 2] += 3;
+		for (uint32_t b = 0; b < numBuckets; b++)
+			offsets[b + 1] += offsets[b];
+
+		std::vector<uint32_t> sorted(indexCount);
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < indexCount; i += 3)
+		{
+			uint32_t& next = cursor[vertexMaterials[range[i]] + 1];
+			std::copy(range + i, range + i + 3, sorted.begin() + next);
+			next += 3;
+		}
+		std::copy(sorted.begin(), sorted.end(), range);
+
+		for (uint32_t b = 0; b < numBuckets; b++)
+		{
+			if (offsets[b + 1] > offsets[b])
+				submeshes.push_back({ firstIndex + offsets[b], offsets[b + 1] - offsets[b], b - 1 });
+		}
+	}
+
+	// Splits LOD0 into submeshes, then optimizes and clusters each one on its own so the
+	// material runs stay contiguous
+	void OptimizeObject(ObjectBuilder& object, const GE::Gfx::MeshOptimizerSettings& settings)
+	{
+		auto& indices = object.indices;
+		size_t vertexCount = object.vertices.size();
+		if (indices.empty())
+			return;
+
+		object.submeshes.clear();
+		SortByMaterial(object.submeshes, indices.data(), 0, static_cast<uint32_t>(indices.size()), object.vertexMaterials);
+
+		object.clusters.clear();
+		for (auto& submesh : object.submeshes)
+		{
+			uint32_t* range = indices.data() + submesh.firstIndex;
+
+			if (settings.vertexCache)
+				GE::Gfx::OptimizeVertexCache(range, range, submesh.indexCount, vertexCount);
+
+			if (settings.overdraw)
+				GE::Gfx::OptimizeOverdraw(range, range, submesh.indexCount, object.vertices.data(), vertexCount);
+
+			if (settings.clusters)
+			{
+				size_t firstCluster = object.clusters.size();
+				GE::Gfx::BuildMeshClusters(object.clusters, range, range, submesh.indexCount, object.vertices.data(), vertexCount, submesh.firstIndex);
+
+				// Clustering breaks up the global cache order, so restore it within each cluster
+				if (settings.vertexCache)
+				{
+					for (size_t c = firstCluster; c < object.clusters.size(); c++)
+					{
+						uint32_t* clusterRange = indices.data() + object.clusters[c].firstIndex;
+						GE::Gfx::OptimizeVertexCache(clusterRange, clusterRange, object.clusters[c].indexCount, vertexCount);
+					}
+				}
+			}
+		}
+
+		if (settings.vertexFetch)
+		{
+			std::vector<uint32_t> remap(vertexCount);
+			size_t uniqueVertices = GE::Gfx::OptimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertexCount);
+			GE::Gfx::RemapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+
+			RemapStream(object.vertices, remap, uniqueVertices);
+			RemapStream(object.texCoords, remap, uniqueVertices);
+			RemapStream(object.normals, remap, uniqueVertices);
+			RemapStream(object.vertexMaterials, remap, uniqueVertices);
+		}
+	}
+
+	// Appends successively simplified index ranges after the full resolution one. Levels are
+	// simplified as a whole, material boundaries are attribute seams the simplifier never moves,
+	// and then split into submeshes like LOD0.
+	void BuildLodChain(ObjectBuilder& object, const GE::Gfx::LodSettings& settings, const GE::Gfx::MeshOptimizerSettings& optimizer)
+	{
+		object.lods.clear();
+		object.lods.push_back({ 0, static_cast<uint32_t>(object.indices.size()), 0.f, 0, static_cast<uint32_t>(object.submeshes.size()) });
+
+		if (object.indices.size() / 3 < settings.minTriangles)
+			return;
+
+		std::vector<uint32_t> previous = object.indices;
+		float error = 0.f;
+		uint32_t maxLevels = std::min(settings.maxLevels, GE::Gfx::LodSettings::MaxLevels);
+
+		for (uint32_t level = 1; level < maxLevels; level++)
+		{
+			size_t target = static_cast<size_t>(previous.size() / 3 * settings.reduction) * 3;
+
+			std::vector<uint32_t> lod(previous.size());
+			float levelError = 0.f;
+			size_t count = GE::Gfx::SimplifyMesh(lod.data(), previous.data(), previous.size(), object.vertices.data(), object.vertices.size(), target, settings.maxError, &levelError);
+
+			// Not worth a level when the error budget stops the simplifier early
+			if (count == 0 || count > previous.size() * 9 / 10)
+				break;
+
+			lod.resize(count);
+
+			error += levelError;
+			uint32_t firstIndex = static_cast<uint32_t>(object.indices.size());
+			uint32_t firstSubmesh = static_cast<uint32_t>(object.submeshes.size());
+			object.indices.insert(object.indices.end(), lod.begin(), lod.end());
+			SortByMaterial(object.submeshes, object.indices.data(), firstIndex, static_cast<uint32_t>(count), object.vertexMaterials);
+			object.lods.push_back({ firstIndex, static_cast<uint32_t>(count), error, firstSubmesh, static_cast<uint32_t>(object.submeshes.size()) - firstSubmesh });
+
+			if (optimizer.vertexCache)
+			{
+				for (size_t i = firstSubmesh; i < object.submeshes.size(); i++)
+				{
+					uint32_t* range = object.indices.data() + object.submeshes[i].firstIndex;
+					GE::Gfx::OptimizeVertexCache(range, range, object.submeshes[i].indexCount, object.vertices.size());
+				}
+			}
+
+			if (count / 3 < settings.minTriangles)
+				break;
+
+			previous.swap(lod);
+		}
+	}
+
+	// Upper bound for the arena of freshly parsed shapes: every corner a unique vertex and every
+	// LOD level just under the 9/10 cutoff of BuildLodChain. Going over only costs another block.
+	size_t EstimateArenaBytes(const std::vector<tinyobj::shape_t>& shapes, GE::Gfx::VertexFormat format, const GE::Gfx::LodSettings& lodSettings)
+	{
+		size_t vertexSize = sizeof(glm::vec3);
+		if (format == GE::Gfx::VertexFormat::Quantized)
+			vertexSize += sizeof(GE::Gfx::QuantizedPosition) + sizeof(GE::Gfx::QuantizedTexCoord) + sizeof(GE::Gfx::QuantizedNormal);
+		else
+			vertexSize += sizeof(glm::vec2) + sizeof(glm::vec3);
+
+		uint32_t maxLevels = std::min(lodSettings.maxLevels, GE::Gfx::LodSettings::MaxLevels);
+		size_t bytes = 0;
+		for (auto& shape : shapes)
+		{
+			size_t corners = shape.mesh.indices.size();
+			size_t indices = corners;
+			size_t levelIndices = corners;
+			for (uint32_t level = 1; level < maxLevels; level++)
+			{
+				levelIndices = levelIndices * 9 / 10;
+				indices += levelIndices;
+			}
+
+			std::vector<bool> used;
+			for (int material : shape.mesh.material_ids)
+			{
+				size_t m = static_cast<size_t>(material + 1);	// -1 for no material
+				if (m >= used.size())
+					used.resize(m + 1);
+				used[m] = true;
+			}
+			size_t numSubmeshes = std::count(used.begin(), used.end(), true) * maxLevels;
+
+			bytes += corners * vertexSize + indices * sizeof(uint32_t);
+			bytes += numSubmeshes * sizeof(GE::Gfx::Submesh) + maxLevels * sizeof(GE::Gfx::ModelObject::LodLevel);
+			bytes += (corners / 3 / GE::Gfx::MaxClusterTriangles + numSubmeshes) * 2 * sizeof(GE::Gfx::MeshCluster);
+
+			// Alignment padding of the object's arrays
+			bytes += 8 * alignof(std::max_align_t);
+		}
+		return bytes;
+	}
+
+	// Copies the finished arrays into the arena. Quantized objects keep only the compact streams
+	// besides the float positions used for culling.
+	GE::Gfx::ModelObject PublishObject(const ObjectBuilder& builder, GE::Utils::Arena& arena, GE::Gfx::VertexFormat format)
+	{
+		GE::Gfx::ModelObject object;
+		object.vertices = arena.Copy(builder.vertices);
+		object.indices = arena.Copy(builder.indices);
+		object.lods = arena.Copy(builder.lods);
+		object.submeshes = arena.Copy(builder.submeshes);
+		object.clusters = arena.Copy(builder.clusters);
+
+		if (format == GE::Gfx::VertexFormat::Quantized)
+		{
+			object.quantized.positionOffset = builder.quantized.positionOffset;
+			object.quantized.positionScale = builder.quantized.positionScale;
+			object.quantized.positions = arena.Copy(builder.quantized.positions);
+			object.quantized.texCoords = arena.Copy(builder.quantized.texCoords);
+			object.quantized.normals = arena.Copy(builder.quantized.normals);
+		}
+		else
+		{
+			object.texCoords = arena.Copy(builder.texCoords);
+			object.normals = arena.Copy(builder.normals);
+		}
+		return object;
+	}
+
+	template <typename T>
+	GE::Utils::Span<T> ReadSpan(GE::Utils::DerivedDataReader& reader, GE::Utils::Arena& arena)
+	{
+		size_t count = 0;
+		const T* data = reader.ReadArray<T>(count);
+		return arena.Copy(data, count);
+	}
 }
 
 namespace GE
@@ -27,64 +354,133 @@ namespace GE
 	{
 		void Model::Load()
 		{
-			Load(_dataFromStorage);
+			if (_isLoaded || IsCancelled())
+				return;
+
+			int64_t begin = NowMicroseconds();
+			uint64_t settings = (optimizerSettings.vertexCache ? 1 : 0) | (optimizerSettings.vertexFetch ? 2 : 0) | (optimizerSettings.overdraw ? 4 : 0) | (optimizerSettings.clusters ? 8 : 0)
+				| (vertexFormat == VertexFormat::Quantized ? 16 : 0);
+			settings = Utils::HashBytes(&lodSettings, sizeof(lodSettings), settings);
+			uint64_t mtlHash = Utils::HashBytes(_mtl_data.data(), _mtl_data.size(), settings);
+			Utils::DerivedDataKey key{ "model", ProcessorVersion, Utils::HashBytes(_dataFromStorage.data(), _dataFromStorage.size(), mtlHash) };
+
+			if (LoadFromCache(key))
+			{
+				_isLoaded = true;
+				_dataFromStorage.clear();
+				_mtl_data.clear();
+			}
+			else
+			{
+				Load(_dataFromStorage);
+
+				if (_isLoaded)
+					SaveToCache(key);
+			}
+
+			if (_isLoaded)
+			{
+				_bytesResident = _arena.GetStats().bytesUsed;
+				Trace(Sys::ResourceStage::Parse, begin, _bytesResident);
+			}
 		}
 
 		void Model::LoadFromStorage()
 		{
+			if (IsCancelled())
+				return;
+
+			int64_t begin = NowMicroseconds();
 			_dataFromStorage = Utils::LoadFile(_path.c_str());
 			if (!_mtlPath.empty())
 				_mtl_data = Utils::LoadFile(_mtlPath.c_str());
+
+			_bytesRead = _dataFromStorage.size() + _mtl_data.size();
+			Trace(Sys::ResourceStage::StorageRead, begin, _bytesRead);
 		}
 
 		void Model::Load(std::vector<char>& data)
 		{
-			if (_isLoaded)
+			if (_isLoaded || IsCancelled())
 				return;
 
-			vectorwrapbuf<char> databuf(data);
-			std::istream is(&databuf);
+			objects.Clear();
+			materials.clear();
+			_arena.Reset();
 
 			tinyobj::attrib_t attrib;
 			std::vector<tinyobj::shape_t> shapes;
 
 			std::string warn;
 			std::string err;
-			bool result;
+			bool result = false;
 
-			if (!_mtlPath.empty())
+			if (parallelParser)
 			{
 				vectorwrapbuf<char> mtl_databuf(_mtl_data);
 				std::istream mtl_is(&mtl_databuf);
-				tinyobj::MaterialStreamReader mtl_ss(mtl_is);
-				result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &is, &mtl_ss);
+				result = ParseObj(data.data(), data.size(), _mtlPath.empty() ? nullptr : &mtl_is, attrib, shapes, materials, warn);
 			}
-			else
+
+			if (!result)
 			{
-				result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &is, nullptr);
+				vectorwrapbuf<char> databuf(data);
+				std::istream is(&databuf);
+				materials.clear();
+
+				if (!_mtlPath.empty())
+				{
+					vectorwrapbuf<char> mtl_databuf(_mtl_data);
+					std::istream mtl_is(&mtl_databuf);
+					tinyobj::MaterialStreamReader mtl_ss(mtl_is);
+					result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &is, &mtl_ss);
+				}
+				else
+				{
+					result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &is, nullptr);
+				}
 			}
 			GE_ASSERT(result, "Failed to load model: {}", _path.c_str());
 			GE_UNUSED(result);
 
+			// One block for every object when the estimate holds, allocated before any processing
+			_arena.Reserve(EstimateArenaBytes(shapes, vertexFormat, lodSettings));
+
+			uint64_t numCorners = 0;
+			VertexDeduplicator deduplicator;
+			ObjectBuilder object;
+
 			for (size_t s = 0; s < shapes.size(); s++) {
+				if (IsCancelled())
+					return;
+
+				auto& mesh = shapes[s].mesh;
 				size_t index_offset = 0;
-				ModelObject object;
+				object.Reset(mesh.indices.size());
+				deduplicator.Reset(mesh.indices.size());
 
-				for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-					size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
+				for (size_t f = 0; f < mesh.num_face_vertices.size(); f++) {
+					size_t fv = size_t(mesh.num_face_vertices[f]);
+					int material = mesh.material_ids[f];
 
-					object.centerOfMass = glm::vec3{ 0 };
 					for (size_t v = 0; v < fv; v++) {
-						tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
+						tinyobj::index_t idx = mesh.indices[index_offset + v];
+
+						bool inserted = false;
+						uint32_t index = deduplicator.Find(idx, material, static_cast<uint32_t>(object.vertices.size()), inserted);
+						object.indices.push_back(index);
+
+						if (!inserted)
+							continue;
+
 						tinyobj::real_t vx = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
 						tinyobj::real_t vy = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
 						tinyobj::real_t vz = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
 
 						object.vertices.push_back({ vx, vy, vz });
-						object.texture_id.push_back(static_cast<float>(shapes[s].mesh.material_ids[f]));
-
-						object.centerOfMass += object.vertices.back();
+						object.vertexMaterials.push_back(material < 0 ? Submesh::NoMaterial : static_cast<uint32_t>(material));
 
+						// Streams stay the same length as vertices so every index is valid in all of them
 						if (idx.normal_index >= 0) {
 							tinyobj::real_t nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
 							tinyobj::real_t ny = attrib.normals[3 * size_t(idx.normal_index) + 1];
@@ -92,6 +488,9 @@ namespace GE
 
 							object.normals.push_back({ nx, ny, nz });
 						}
+						else {
+							object.normals.push_back(glm::vec3{ 0.f });
+						}
 
 						if (idx.texcoord_index >= 0) {
 							tinyobj::real_t tx = attrib.texcoords[2 * size_t(idx.texcoord_index) + 0];
@@ -99,27 +498,194 @@ namespace GE
 
 							object.texCoords.push_back({ tx, ty });
 						}
+						else {
+							object.texCoords.push_back(glm::vec2{ 0.f });
+						}
 					}
 
 					index_offset += fv;
 				}
-				
-				object.centerOfMass /= object.vertices.size();
 
-				objects.push_back(object);
+				numCorners += object.indices.size();
+
+				OptimizeObject(object, optimizerSettings);
+				BuildLodChain(object, lodSettings, optimizerSettings);
+				if (vertexFormat == VertexFormat::Quantized)
+					QuantizeVertices(object.quantized, object.vertices.data(), object.texCoords.data(), object.normals.data(), object.vertices.size());
+
+				ModelObject published = PublishObject(object, _arena, vertexFormat);
+				published.bounds = ComputeMeshBounds(object.vertices.data(), object.vertices.size());
+				objects.Push(std::move(published));
 			}
 
+			if (_data)
+				LogIndexingStats(numCorners);
+
 			_isLoaded = true;
 			_dataFromStorage.clear();
-			_mtlPath.clear();
+			_mtl_data.clear();
+		}
+
+		void Model::LogIndexingStats(uint64_t numCorners) const
+		{
+			constexpr uint64_t vertexSize = sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3);
+			constexpr uint64_t quantizedVertexSize = sizeof(QuantizedPosition) + sizeof(QuantizedTexCoord) + sizeof(QuantizedNormal);
+			uint64_t uploadVertexSize = vertexFormat == VertexFormat::Quantized ? quantizedVertexSize : vertexSize;
+
+			uint64_t numVertices = 0;
+			uint64_t indexBytes = 0;
+			uint64_t invocations = 0;
+			uint64_t numClusters = 0;
+			uint64_t numSubmeshes = 0;
+			uint64_t lodTriangles[LodSettings::MaxLevels] = {};
+			for (auto& object : objects)
+			{
+				numVertices += object.vertices.size();
+				numClusters += object.clusters.size();
+				numSubmeshes += object.lods.front().numSubmeshes;
+				indexBytes += object.indices.size() * (object.vertices.size() <= 0xFFFF ? sizeof(uint16_t) : sizeof(uint32_t));
+				invocations += AnalyzeVertexCache(object.indices.data(), object.lods.front().indexCount, object.vertices.size()).verticesTransformed;
+
+				// Objects with a shorter chain keep drawing their last level
+				for (uint32_t level = 0; level < LodSettings::MaxLevels; level++)
+					lodTriangles[level] += object.lods[std::min<size_t>(level, object.lods.size() - 1)].indexCount / 3;
+			}
+
+			GE_INFO("{}: {} corners -> {} unique vertices, {:.2f} MB -> {:.2f} MB, vertex shader invocations {} -> {}",
+				_path.c_str(), numCorners, numVertices,
+				numCorners * vertexSize / (1024.0 * 1024.0), (numVertices * uploadVertexSize + indexBytes) / (1024.0 * 1024.0),
+				numCorners, invocations);
+
+			GE_INFO("{}: {} objects, {} material submeshes at LOD0", _path.c_str(), objects.Size(), numSubmeshes);
+
+			if (numClusters)
+				GE_INFO("{}: {} clusters, {:.1f} triangles per cluster", _path.c_str(), numClusters, double(lodTriangles[0]) / numClusters);
+
+			Utils::Arena::Stats arena = _arena.GetStats();
+			GE_INFO("{}: arena {:.2f} MB used of {:.2f} MB reserved in {} blocks", _path.c_str(),
+				arena.bytesUsed / (1024.0 * 1024.0), arena.bytesReserved / (1024.0 * 1024.0), arena.blocks);
+
+			for (uint32_t level = 1; level < std::min(lodSettings.maxLevels, LodSettings::MaxLevels); level++)
+				GE_INFO("{}: LOD{} {} triangles ({:.0f}% of LOD0)", _path.c_str(), level, lodTriangles[level], 100.0 * lodTriangles[level] / std::max<uint64_t>(lodTriangles[0], 1));
+		}
+
+		bool Model::LoadFromCache(const Utils::DerivedDataKey& key)
+		{
+			std::vector<char> payload;
+			if (!Utils::DerivedDataCache::Get().Load(key, payload))
+				return false;
+
+			Utils::DerivedDataReader reader(payload);
+
+			// The arrays are the bulk of the payload, so this is a single block
+			_arena.Reset();
+			_arena.Reserve(payload.size());
+
+			// Nothing is published until the whole payload checks out
+			// Counts are checked against what is left of the payload before allocating for them,
+			// every object and material at least holds the size field of each of its arrays
+			constexpr size_t MinObjectBytes = 10 * sizeof(uint64_t);
+			constexpr size_t MinMaterialBytes = 6 * sizeof(uint64_t);
+
+			uint32_t numObjects = 0;
+			reader.Read(numObjects);
+			if (reader.Failed() || numObjects > reader.Remaining() / MinObjectBytes)
+			{
+				GE_WARN("Discarding corrupt derived data for {}", _path.c_str());
+				_arena.Reset();
+				return false;
+			}
+
+			std::vector<ModelObject> cached(numObjects);
+			for (auto& object : cached)
+			{
+				object.vertices = ReadSpan<glm::vec3>(reader, _arena);
+				object.texCoords = ReadSpan<glm::vec2>(reader, _arena);
+				object.normals = ReadSpan<glm::vec3>(reader, _arena);
+				reader.Read(object.bounds);
+				object.indices = ReadSpan<uint32_t>(reader, _arena);
+				object.lods = ReadSpan<ModelObject::LodLevel>(reader, _arena);
+				object.submeshes = ReadSpan<Submesh>(reader, _arena);
+				object.clusters = ReadSpan<MeshCluster>(reader, _arena);
+				reader.Read(object.quantized.positionOffset);
+				reader.Read(object.quantized.positionScale);
+				object.quantized.positions = ReadSpan<QuantizedPosition>(reader, _arena);
+				object.quantized.texCoords = ReadSpan<QuantizedTexCoord>(reader, _arena);
+				object.quantized.normals = ReadSpan<QuantizedNormal>(reader, _arena);
+			}
+
+			uint32_t numMaterials = 0;
+			reader.Read(numMaterials);
+			bool badMaterials = numMaterials > reader.Remaining() / MinMaterialBytes;
+			materials.resize(badMaterials ? 0 : numMaterials);
+			for (auto& material : materials)
+			{
+				reader.ReadString(material.name);
+				reader.ReadString(material.ambient_texname);
+				reader.ReadString(material.diffuse_texname);
+				reader.ReadString(material.specular_texname);
+				reader.ReadString(material.bump_texname);
+				reader.ReadString(material.alpha_texname);
+			}
+
+			if (reader.Failed() || badMaterials)
+			{
+				GE_WARN("Discarding corrupt derived data for {}", _path.c_str());
+				materials.clear();
+				_arena.Reset();
+				return false;
+			}
+
+			for (auto& object : cached)
+				objects.Push(std::move(object));
+
+			return true;
+		}
+
+		void Model::SaveToCache(const Utils::DerivedDataKey& key) const
+		{
+			Utils::DerivedDataWriter writer;
+
+			writer.Write(static_cast<uint32_t>(objects.Size()));
+			for (auto& object : objects)
+			{
+				writer.WriteArray(object.vertices);
+				writer.WriteArray(object.texCoords);
+				writer.WriteArray(object.normals);
+				writer.Write(object.bounds);
+				writer.WriteArray(object.indices);
+				writer.WriteArray(object.lods);
+				writer.WriteArray(object.submeshes);
+				writer.WriteArray(object.clusters);
+				writer.Write(object.quantized.positionOffset);
+				writer.Write(object.quantized.positionScale);
+				writer.WriteArray(object.quantized.positions);
+				writer.WriteArray(object.quantized.texCoords);
+				writer.WriteArray(object.quantized.normals);
+			}
+
+			writer.Write(static_cast<uint32_t>(materials.size()));
+			for (auto& material : materials)
+			{
+				writer.WriteString(material.name);
+				writer.WriteString(material.ambient_texname);
+				writer.WriteString(material.diffuse_texname);
+				writer.WriteString(material.specular_texname);
+				writer.WriteString(material.bump_texname);
+				writer.WriteString(material.alpha_texname);
+			}
+
+			Utils::DerivedDataCache::Get().Store(key, writer.Data());
 		}
 
 		void Model::Unload()
 		{
 			_isLoaded = false;
+			_bytesResident = 0;
 
-			objects.clear();
+			objects.Clear();
 			materials.clear();
+			_arena.Reset();
 		}
 
 	}
@@ -0,0 +1,540 @@
+#include <ge/gfx/ObjParser.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <ge/core/Global.hpp>
+
+namespace
+{
+	constexpr size_t TargetChunkSize = 4 * 1024 * 1024;
+
+	inline bool IsSpace(char c) { return c == ' ' || c == '\t'; }
+	inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+	inline const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && IsSpace(*p))
+			p++;
+		return p;
+	}
+
+	inline const char* SkipSpacesAndReturns(const char* p, const char* end)
+	{
+		while (p < end && (IsSpace(*p) || *p == '\r'))
+			p++;
+		return p;
+	}
+
+	// Up to the next space, tab or carriage return
+	inline const char* TokenEnd(const char* p, const char* end)
+	{
+		while (p < end && !IsSpace(*p) && *p != '\r')
+			p++;
+		return p;
+	}
+
+	// tinyobj's tryParseDouble: digits accumulated in a double and scaled by pow(5, e) * 2^e.
+	// Not correctly rounded, but using anything else would change the loaded positions.
+	bool TryParseDouble(const char* s, const char* end, double* result)
+	{
+		if (s >= end)
+			return false;
+
+		double mantissa = 0.0;
+		int exponent = 0;
+		char sign = '+';
+		char exponentSign = '+';
+		const char* curr = s;
+		int read = 0;
+		bool leadingDot = false;
+
+		if (*curr == '+' || *curr == '-')
+		{
+			sign = *curr;
+			curr++;
+			if (curr != end && *curr == '.')
+				leadingDot = true;
+		}
+		else if (*curr == '.')
+			leadingDot = true;
+		else if (!IsDigit(*curr))
+			return false;
+
+		if (!leadingDot)
+		{
+			while (curr != end && IsDigit(*curr))
+			{
+				mantissa *= 10;
+				mantissa += static_cast<int>(*curr - '0');
+				curr++;
+				read++;
+			}
+			if (read == 0)
+				return false;
+		}
+
+		if (curr != end)
+		{
+			if (*curr == '.')
+			{
+				static const double powLut[] = { 1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001 };
+				constexpr int lutEntries = sizeof(powLut) / sizeof(powLut[0]);
+
+				curr++;
+				read = 1;
+				while (curr != end && IsDigit(*curr))
+				{
+					mantissa += static_cast<int>(*curr - '0') * (read < lutEntries ? powLut[read] : std::pow(10.0, -read));
+					read++;
+					curr++;
+				}
+			}
+			else if (*curr != 'e' && *curr != 'E')
+				curr = end;
+
+			if (curr != end && (*curr == 'e' || *curr == 'E'))
+			{
+				curr++;
+				if (curr != end && (*curr == '+' || *curr == '-'))
+				{
+					exponentSign = *curr;
+					curr++;
+				}
+				else if (curr == end || !IsDigit(*curr))
+					return false;
+
+				read = 0;
+				while (curr != end && IsDigit(*curr))
+				{
+					exponent *= 10;
+					exponent += static_cast<int>(*curr - '0');
+					curr++;
+					read++;
+				}
+				exponent *= exponentSign == '+' ? 1 : -1;
+				if (read == 0)
+					return false;
+			}
+		}
+
+		*result = (sign == '+' ? 1 : -1) * (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+		return true;
+	}
+
+	inline float ParseReal(const char*& p, const char* end)
+	{
+		p = SkipSpaces(p, end);
+		const char* tokenEnd = TokenEnd(p, end);
+		double value = 0.0;
+		TryParseDouble(p, tokenEnd, &value);
+		p = tokenEnd;
+		return static_cast<float>(value);
+	}
+
+	// atoi on a line that is not NUL terminated
+	inline int ParseInt(const char* p, const char* end)
+	{
+		while (p < end && (IsSpace(*p) || *p == '\r' || *p == '\v' || *p == '\f'))
+			p++;
+
+		bool negative = false;
+		if (p < end && (*p == '+' || *p == '-'))
+			negative = *p++ == '-';
+
+		int value = 0;
+		while (p < end && IsDigit(*p))
+			value = value * 10 + (*p++ - '0');
+		return negative ? -value : value;
+	}
+
+	inline const char* IndexEnd(const char* p, const char* end)
+	{
+		while (p < end && *p != '/' && !IsSpace(*p) && *p != '\r')
+			p++;
+		return p;
+	}
+
+	enum class EventType
+	{
+		Group,
+		Object,
+		UseMaterial,
+		MaterialLibrary,
+		Smoothing
+	};
+
+	// Records that change how the faces after them are grouped, replayed in order during the merge
+	struct ChunkEvent
+	{
+		EventType type;
+		size_t face;	// Number of chunk faces before the record
+		std::string name;
+		unsigned int smoothingGroup{ 0 };
+	};
+
+	struct ObjChunk
+	{
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> texCoords;
+
+		std::vector<tinyobj::index_t> corners;	// Three per face
+		std::vector<uint32_t> relativeCorners;	// corner * 3 + stream of negative indices that need the chunk base
+		std::vector<ChunkEvent> events;
+
+		// Scratch for the face being parsed, reused across lines
+		std::vector<tinyobj::index_t> faceCorners;
+		std::vector<std::array<bool, 3>> faceRelative;
+
+		bool supported{ true };
+	};
+
+	// tinyobj's fixIndex, with negative indices resolved against the chunk local count
+	inline bool FixIndex(int index, int count, int& result, bool& relative)
+	{
+		relative = index < 0;
+		if (index > 0)
+			result = index - 1;
+		else if (index < 0)
+			result = count + index;
+		else
+			return false;
+		return true;
+	}
+
+	bool ParseFace(const char* p, const char* end, ObjChunk& chunk)
+	{
+		int counts[3] = {
+			static_cast<int>(chunk.positions.size() / 3),
+			static_cast<int>(chunk.texCoords.size() / 2),
+			static_cast<int>(chunk.normals.size() / 3)
+		};
+
+		auto& corners = chunk.faceCorners;
+		auto& relative = chunk.faceRelative;
+		corners.clear();
+		relative.clear();
+
+		p = SkipSpaces(p, end);
+		while (p < end && *p != '\r')
+		{
+			corners.push_back({ -1, -1, -1 });
+			relative.push_back({});
+
+			tinyobj::index_t& corner = corners.back();
+			bool* cornerRelative = relative.back().data();
+			if (!FixIndex(ParseInt(p, end), counts[0], corner.vertex_index, cornerRelative[0]))
+				return false;
+			p = IndexEnd(p, end);
+
+			if (p < end && *p == '/')
+			{
+				p++;
+				if (p < end && *p == '/')
+				{
+					p++;
+					if (!FixIndex(ParseInt(p, end), counts[2], corner.normal_index, cornerRelative[2]))
+						return false;
+					p = IndexEnd(p, end);
+				}
+				else
+				{
+					if (!FixIndex(ParseInt(p, end), counts[1], corner.texcoord_index, cornerRelative[1]))
+						return false;
+					p = IndexEnd(p, end);
+
+					if (p < end && *p == '/')
+					{
+						p++;
+						if (!FixIndex(ParseInt(p, end), counts[2], corner.normal_index, cornerRelative[2]))
+							return false;
+						p = IndexEnd(p, end);
+					}
+				}
+			}
+
+			p = SkipSpacesAndReturns(p, end);
+		}
+
+		// tinyobj drops faces with fewer than three corners and fans the rest around the first
+		// corner, as (0, i - 1, i)
+		for (size_t i = 2; i < corners.size(); i++)
+		{
+			for (size_t source : { size_t(0), i - 1, i })
+			{
+				uint32_t corner = static_cast<uint32_t>(chunk.corners.size());
+				for (uint32_t stream = 0; stream < 3; stream++)
+				{
+					if (relative[source][stream])
+						chunk.relativeCorners.push_back(corner * 3 + stream);
+				}
+				chunk.corners.push_back(corners[source]);
+			}
+		}
+		return true;
+	}
+
+	// Space separated names after the keyword, joined by single spaces
+	std::string ParseGroupName(const char* p, const char* end)
+	{
+		std::string name;
+		bool first = true;
+		p = SkipSpacesAndReturns(p, end);
+		while (p < end)
+		{
+			const char* tokenEnd = TokenEnd(p, end);
+			if (!first)
+				name += ' ';
+			name.append(p, tokenEnd);
+			first = false;
+			p = SkipSpacesAndReturns(tokenEnd, end);
+		}
+		return name;
+	}
+
+	// Stops early once any chunk has hit a record that sends the whole file to tinyobj
+	void ParseChunk(const char* p, const char* end, ObjChunk& chunk, const std::atomic<bool>& failed)
+	{
+		while (p < end && chunk.supported && !failed.load(std::memory_order_relaxed))
+		{
+			// Lines end at \n, \r\n or a lone \r, as in tinyobj's safeGetline
+			const char* lineEnd = p;
+			while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+				lineEnd++;
+
+			const char* next = lineEnd;
+			if (next < end && *next == '\r')
+				next++;
+			if (next < end && *next == '\n')
+				next++;
+
+			const char* token = SkipSpaces(p, lineEnd);
+			p = next;
+
+			size_t length = lineEnd - token;
+			if (length == 0 || token[0] == '#')
+				continue;
+
+			size_t face = chunk.corners.size() / 3;
+			if (length > 1 && token[0] == 'v' && IsSpace(token[1]))
+			{
+				token += 2;
+				for (int i = 0; i < 3; i++)
+					chunk.positions.push_back(ParseReal(token, lineEnd));
+			}
+			else if (length > 2 && token[0] == 'v' && token[1] == 'n' && IsSpace(token[2]))
+			{
+				token += 3;
+				for (int i = 0; i < 3; i++)
+					chunk.normals.push_back(ParseReal(token, lineEnd));
+			}
+			else if (length > 2 && token[0] == 'v' && token[1] == 't' && IsSpace(token[2]))
+			{
+				token += 3;
+				for (int i = 0; i < 2; i++)
+					chunk.texCoords.push_back(ParseReal(token, lineEnd));
+			}
+			else if (length > 1 && token[0] == 'f' && IsSpace(token[1]))
+			{
+				if (!ParseFace(token + 2, lineEnd, chunk))
+					chunk.supported = false;
+			}
+			else if (length > 1 && (token[0] == 'l' || token[0] == 'p') && IsSpace(token[1]))
+			{
+				chunk.supported = false;
+			}
+			else if (length > 1 && (token[0] == 'g' || token[0] == 'o') && IsSpace(token[1]))
+			{
+				// Object names keep the rest of the line verbatim, group names are re-joined tokens
+				ChunkEvent event{ token[0] == 'g' ? EventType::Group : EventType::Object, face };
+				event.name = token[0] == 'g' ? ParseGroupName(token + 1, lineEnd) : std::string(token + 2, lineEnd);
+				chunk.events.push_back(std::move(event));
+			}
+			else if (length > 6 && std::strncmp(token, "usemtl", 6) == 0 && IsSpace(token[6]))
+			{
+				chunk.events.push_back({ EventType::UseMaterial, face, std::string(token + 7, lineEnd) });
+			}
+			else if (length > 6 && std::strncmp(token, "mtllib", 6) == 0 && IsSpace(token[6]))
+			{
+				chunk.events.push_back({ EventType::MaterialLibrary, face, std::string(token + 7, lineEnd) });
+			}
+			else if (length > 1 && token[0] == 's' && IsSpace(token[1]))
+			{
+				token = SkipSpaces(token + 2, lineEnd);
+				if (token == lineEnd || *token == '\r')
+					continue;
+
+				ChunkEvent event{ EventType::Smoothing, face };
+				if (lineEnd - token >= 3 && std::strncmp(token, "off", 3) == 0)
+					event.smoothingGroup = 0;
+				else
+					event.smoothingGroup = static_cast<unsigned int>(std::max(ParseInt(token, lineEnd), 0));
+				chunk.events.push_back(std::move(event));
+			}
+		}
+	}
+
+	class ShapeBuilder
+	{
+	public:
+		ShapeBuilder(std::vector<tinyobj::shape_t>& shapes)
+			: _shapes(shapes)
+		{}
+
+		void Flush()
+		{
+			if (!_shape.mesh.indices.empty())
+			{
+				_shape.name = _name;
+				_shapes.push_back(std::move(_shape));
+			}
+			_shape = tinyobj::shape_t();
+		}
+
+		void SetName(std::string name) { _name = std::move(name); }
+
+		void AddFaces(const tinyobj::index_t* corners, size_t numFaces, int material, unsigned int smoothingGroup)
+		{
+			auto& mesh = _shape.mesh;
+			mesh.indices.insert(mesh.indices.end(), corners, corners + numFaces * 3);
+			mesh.num_face_vertices.insert(mesh.num_face_vertices.end(), numFaces, static_cast<unsigned char>(3));
+			mesh.material_ids.insert(mesh.material_ids.end(), numFaces, material);
+			mesh.smoothing_group_ids.insert(mesh.smoothing_group_ids.end(), numFaces, smoothingGroup);
+		}
+
+	private:
+		std::vector<tinyobj::shape_t>& _shapes;
+		tinyobj::shape_t _shape;
+		std::string _name;
+	};
+}
+
+namespace GE
+{
+	namespace Gfx
+	{
+		bool ParseObj(const char* data, size_t size, std::istream* mtlStream, tinyobj::attrib_t& attrib,
+			std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& materials, std::string& warn,
+			uint32_t maxThreads)
+		{
+			// Chunks start right after a \n, which is always a line start
+			std::vector<std::pair<size_t, size_t>> ranges;
+			for (size_t begin = 0; begin < size;)
+			{
+				size_t end = std::min(begin + TargetChunkSize, size);
+				const void* newline = end < size ? std::memchr(data + end, '\n', size - end) : nullptr;
+				end = newline ? static_cast<const char*>(newline) - data + 1 : size;
+
+				ranges.push_back({ begin, end });
+				begin = end;
+			}
+
+			// The caller works too, so nested loads finish even when every worker is busy
+			std::vector<ObjChunk> chunks(ranges.size());
+			std::atomic<bool> failed{ false };
+			GlobalThreadPool().ParallelFor(static_cast<uint32_t>(ranges.size()), [&](uint32_t i) {
+				ParseChunk(data + ranges[i].first, data + ranges[i].second, chunks[i], failed);
+				if (!chunks[i].supported)
+					failed = true;
+			}, maxThreads);
+
+			if (failed)
+				return false;
+
+			attrib = tinyobj::attrib_t();
+			shapes.clear();
+			materials.clear();
+
+			size_t numPositions = 0, numNormals = 0, numTexCoords = 0;
+			for (auto& chunk : chunks)
+			{
+				numPositions += chunk.positions.size();
+				numNormals += chunk.normals.size();
+				numTexCoords += chunk.texCoords.size();
+			}
+			attrib.vertices.reserve(numPositions);
+			attrib.normals.reserve(numNormals);
+			attrib.texcoords.reserve(numTexCoords);
+
+			std::map<std::string, int> materialMap;
+			ShapeBuilder builder(shapes);
+			int material = -1;
+			unsigned int smoothingGroup = 0;
+
+			for (auto& chunk : chunks)
+			{
+				int base[3] = {
+					static_cast<int>(attrib.vertices.size() / 3),
+					static_cast<int>(attrib.texcoords.size() / 2),
+					static_cast<int>(attrib.normals.size() / 3)
+				};
+
+				for (uint32_t relative : chunk.relativeCorners)
+				{
+					tinyobj::index_t& corner = chunk.corners[relative / 3];
+					switch (relative % 3)
+					{
+					case 0: corner.vertex_index += base[0]; break;
+					case 1: corner.texcoord_index += base[1]; break;
+					case 2: corner.normal_index += base[2]; break;
+					}
+				}
+
+				attrib.vertices.insert(attrib.vertices.end(), chunk.positions.begin(), chunk.positions.end());
+				attrib.normals.insert(attrib.normals.end(), chunk.normals.begin(), chunk.normals.end());
+				attrib.texcoords.insert(attrib.texcoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+
+				size_t face = 0;
+				size_t numFaces = chunk.corners.size() / 3;
+				for (size_t e = 0; e <= chunk.events.size(); e++)
+				{
+					size_t until = e < chunk.events.size() ? chunk.events[e].face : numFaces;
+					builder.AddFaces(chunk.corners.data() + face * 3, until - face, material, smoothingGroup);
+					face = until;
+
+					if (e == chunk.events.size())
+						break;
+
+					auto& event = chunk.events[e];
+					switch (event.type)
+					{
+					case EventType::Group:
+					case EventType::Object:
+						builder.Flush();
+						builder.SetName(event.name);
+						break;
+					case EventType::UseMaterial:
+					{
+						auto it = materialMap.find(event.name);
+						if (it == materialMap.end())
+							warn += "material [ '" + event.name + "' ] not found in .mtl\n";
+						material = it != materialMap.end() ? it->second : -1;
+						break;
+					}
+					case EventType::MaterialLibrary:
+						if (mtlStream && !event.name.empty())
+						{
+							std::string err;
+							tinyobj::MaterialStreamReader reader(*mtlStream);
+							reader(event.name, &materials, &materialMap, &warn, &err);
+							warn += err;
+						}
+						break;
+					case EventType::Smoothing:
+						smoothingGroup = event.smoothingGroup;
+						break;
+					}
+				}
+			}
+
+			builder.Flush();
+			return true;
+		}
+	}
+}
@@ -5,6 +5,7 @@
 
 #include <ge/gfx/Swapchain.hpp>
 #include <ge/utils/Common.hpp>
+#include <ge/utils/DerivedDataCache.hpp>
 
 namespace GE
 {
@@ -197,12 +198,46 @@ namespace GE
 		}
 
 		void VulkanTexture::LoadFromStorage(const std::string& path)
+		{
+			LoadFromMemory(Utils::LoadFile(path.c_str()));
+		}
+
+		void VulkanTexture::LoadFromMemory(const std::vector<char>& data)
 		{
 			GE_ASSERT(!_loaded.Get(), "Texture already loaded");
 
+			Utils::DerivedDataKey key{ "texture", ProcessorVersion, Utils::HashBytes(data.data(), data.size()) };
+
+			std::vector<char> payload;
+			if (Utils::DerivedDataCache::Get().Load(key, payload))
+			{
+				Utils::DerivedDataReader reader(payload);
+				reader.Read(_width);
+				reader.Read(_height);
+				reader.Read(_channels);
+
+				size_t size = 0;
+				const unsigned char* pixels = reader.ReadArray<unsigned char>(size);
+				if (!reader.Failed() && size == static_cast<size_t>(_width) * _height * 4)
+				{
+					_pixels = (unsigned char*)STBI_MALLOC(size);
+					memcpy(_pixels, pixels, size);
+					return;
+				}
+			}
+
 			stbi_set_flip_vertically_on_load(true);
-			auto data = Utils::LoadFile(path.c_str());
 			_pixels = stbi_load_from_memory((unsigned char*)data.data(), static_cast<int>(data.size()), &_width, &_height, &_channels, STBI_rgb_alpha);
+
+			if (_pixels)
+			{
+				Utils::DerivedDataWriter writer;
+				writer.Write(_width);
+				writer.Write(_height);
+				writer.Write(_channels);
+				writer.WriteArray(_pixels, static_cast<size_t>(_width) * _height * 4);
+				Utils::DerivedDataCache::Get().Store(key, writer.Data());
+			}
 		}
 
 		void VulkanTexture::LoadFromEngineResources(const std::string& path)
@@ -221,6 +256,15 @@ namespace GE
 
 		}
 
+		void VulkanTexture::ReleaseStorage()
+		{
+			if (_pixels)
+			{
+				stbi_image_free(_pixels);
+				_pixels = nullptr;
+			}
+		}
+
 		void VulkanTexture::CopyBufferToImage(VkCommandBuffer& cmdBuffer)
 		{
 			VkBufferImageCopy region{};
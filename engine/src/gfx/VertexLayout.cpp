@@ -0,0 +1,65 @@
+#include <ge/gfx/VertexLayout.hpp>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		namespace
+		{
+			struct StreamFormat
+			{
+				VertexStream stream;
+				uint32_t location;
+				VkFormat format;
+				uint32_t stride;
+			};
+
+			const StreamFormat FloatStreams[] = {
+				{ VertexStreamPosition, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) },
+				{ VertexStreamTexCoord, 1, VK_FORMAT_R32G32_SFLOAT, sizeof(glm::vec2) },
+				{ VertexStreamNormal, 2, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) },
+			};
+
+			const StreamFormat QuantizedStreams[] = {
+				{ VertexStreamPosition, 0, VK_FORMAT_R16G16B16A16_UNORM, sizeof(QuantizedPosition) },
+				{ VertexStreamTexCoord, 1, VK_FORMAT_R16G16_SFLOAT, sizeof(QuantizedTexCoord) },
+				{ VertexStreamNormal, 2, VK_FORMAT_R16G16_SNORM, sizeof(QuantizedNormal) },
+			};
+
+			constexpr uint32_t NumStreams = sizeof(FloatStreams) / sizeof(FloatStreams[0]);
+
+			const StreamFormat* GetStreamFormats(VertexFormat format)
+			{
+				return format == VertexFormat::Quantized ? QuantizedStreams : FloatStreams;
+			}
+		}
+
+		VertexInputLayout GetVertexInputLayout(VertexFormat format, uint32_t streams)
+		{
+			VertexInputLayout layout;
+			const StreamFormat* formats = GetStreamFormats(format);
+			for (uint32_t i = 0; i < NumStreams; i++)
+			{
+				if (!(streams & formats[i].stream))
+					continue;
+
+				uint32_t binding = static_cast<uint32_t>(layout.bindings.size());
+				layout.bindings.push_back({ binding, formats[i].stride, VK_VERTEX_INPUT_RATE_VERTEX });
+				layout.attributes.push_back({ formats[i].location, binding, formats[i].format, 0 });
+			}
+			return layout;
+		}
+
+		uint32_t GetVertexSize(VertexFormat format, uint32_t streams)
+		{
+			uint32_t size = 0;
+			const StreamFormat* formats = GetStreamFormats(format);
+			for (uint32_t i = 0; i < NumStreams; i++)
+			{
+				if (streams & formats[i].stream)
+					size += formats[i].stride;
+			}
+			return size;
+		}
+	}
+}
@@ -0,0 +1,206 @@
+#include <ge/gfx/VertexQuantization.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace GE
+{
+	namespace Gfx
+	{
+		uint16_t FloatToHalf(float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			uint32_t sign = (bits >> 16) & 0x8000;
+			int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+			uint32_t mantissa = bits & 0x7FFFFF;
+
+			// NaN stays NaN, everything else too large saturates to infinity
+			if (((bits >> 23) & 0xFF) == 0xFF)
+				return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+			if (exponent >= 31)
+				return static_cast<uint16_t>(sign | 0x7C00);
+
+			if (exponent <= 0)
+			{
+				if (exponent < -10)
+					return static_cast<uint16_t>(sign);
+
+				// Subnormal, round to nearest even
+				mantissa |= 0x800000;
+				uint32_t shift = static_cast<uint32_t>(14 - exponent);
+				uint32_t half = mantissa >> shift;
+				uint32_t remainder = mantissa & ((1u << shift) - 1);
+				uint32_t midpoint = 1u << (shift - 1);
+				if (remainder > midpoint || (remainder == midpoint && (half & 1)))
+					half++;
+				return static_cast<uint16_t>(sign | half);
+			}
+
+			uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+			uint32_t remainder = mantissa & 0x1FFF;
+			if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+				half++;	// May carry into the exponent, which is the correct rounding
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		float HalfToFloat(uint16_t value)
+		{
+			uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+			uint32_t exponent = (value >> 10) & 0x1F;
+			uint32_t mantissa = value & 0x3FF;
+
+			uint32_t bits;
+			if (exponent == 0x1F)
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			else if (exponent != 0)
+				bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+			else if (mantissa == 0)
+				bits = sign;
+			else
+			{
+				// Normalize the subnormal
+				exponent = 127 - 15 + 1;
+				while (!(mantissa & 0x400))
+				{
+					mantissa <<= 1;
+					exponent--;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+			}
+
+			float result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		QuantizedNormal EncodeOctahedral(const glm::vec3& normal)
+		{
+			float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+			if (sum <= 0.f)
+				return { 0, 0 };
+
+			float x = normal.x / sum;
+			float y = normal.y / sum;
+			if (normal.z < 0.f)
+			{
+				// Fold the lower hemisphere over the diagonals
+				float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+				float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+				x = fx;
+				y = fy;
+			}
+
+			return {
+				static_cast<int16_t>(std::lround(glm::clamp(x, -1.f, 1.f) * 32767.f)),
+				static_cast<int16_t>(std::lround(glm::clamp(y, -1.f, 1.f) * 32767.f))
+			};
+		}
+
+		glm::vec3 DecodeOctahedral(QuantizedNormal encoded)
+		{
+			// Matches the snorm fetch and decode in the quantized vertex shaders
+			float x = std::max(encoded.x / 32767.f, -1.f);
+			float y = std::max(encoded.y / 32767.f, -1.f);
+			glm::vec3 n{ x, y, 1.f - std::abs(x) - std::abs(y) };
+
+			float t = std::max(-n.z, 0.f);
+			n.x += n.x >= 0.f ? -t : t;
+			n.y += n.y >= 0.f ? -t : t;
+			return glm::normalize(n);
+		}
+
+		glm::vec3 DequantizePosition(const QuantizedVertexStreams& streams, size_t vertex)
+		{
+			const QuantizedPosition& q = streams.positions[vertex];
+			return streams.positionOffset + streams.positionScale * glm::vec3{ q.x / 65535.f, q.y / 65535.f, q.z / 65535.f };
+		}
+
+		void QuantizeVertices(QuantizedVertexStreams& streams, const glm::vec3* positions, const glm::vec2* texCoords,
+			const glm::vec3* normals, size_t vertexCount)
+		{
+			streams = QuantizedVertexStreams{};
+			if (vertexCount == 0)
+				return;
+
+			glm::vec3 min = positions[0];
+			glm::vec3 max = positions[0];
+			for (size_t i = 1; i < vertexCount; i++)
+			{
+				min = glm::min(min, positions[i]);
+				max = glm::max(max, positions[i]);
+			}
+
+			streams.positionOffset = min;
+			streams.positionScale = max - min;
+
+			glm::vec3 inverseScale{
+				streams.positionScale.x > 0.f ? 65535.f / streams.positionScale.x : 0.f,
+				streams.positionScale.y > 0.f ? 65535.f / streams.positionScale.y : 0.f,
+				streams.positionScale.z > 0.f ? 65535.f / streams.positionScale.z : 0.f
+			};
+
+			streams.positions.resize(vertexCount);
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				glm::vec3 q = glm::clamp((positions[i] - min) * inverseScale, 0.f, 65535.f);
+				streams.positions[i] = {
+					static_cast<uint16_t>(q.x + .5f),
+					static_cast<uint16_t>(q.y + .5f),
+					static_cast<uint16_t>(q.z + .5f),
+					0
+				};
+			}
+
+			if (texCoords)
+			{
+				streams.texCoords.resize(vertexCount);
+				for (size_t i = 0; i < vertexCount; i++)
+					streams.texCoords[i] = { FloatToHalf(texCoords[i].x), FloatToHalf(texCoords[i].y) };
+			}
+
+			if (normals)
+			{
+				streams.normals.resize(vertexCount);
+				for (size_t i = 0; i < vertexCount; i++)
+					streams.normals[i] = EncodeOctahedral(normals[i]);
+			}
+		}
+
+		QuantizationError MeasureQuantizationError(const QuantizedVertexStreams& streams, const glm::vec3* positions,
+			const glm::vec2* texCoords, const glm::vec3* normals, size_t vertexCount)
+		{
+			QuantizationError error;
+			vertexCount = std::min(vertexCount, streams.positions.size());
+
+			for (size_t i = 0; i < vertexCount; i++)
+				error.position = std::max(error.position, glm::length(DequantizePosition(streams, i) - positions[i]));
+
+			if (texCoords && streams.texCoords.size() >= vertexCount)
+			{
+				for (size_t i = 0; i < vertexCount; i++)
+				{
+					glm::vec2 uv{ HalfToFloat(streams.texCoords[i].u), HalfToFloat(streams.texCoords[i].v) };
+					glm::vec2 d = uv - texCoords[i];
+					error.texCoord = std::max(error.texCoord, std::max(std::abs(d.x), std::abs(d.y)));
+				}
+			}
+
+			if (normals && streams.normals.size() >= vertexCount)
+			{
+				float minCos = 1.f;
+				for (size_t i = 0; i < vertexCount; i++)
+				{
+					float length = glm::length(normals[i]);
+					if (length > 0.f)
+						minCos = std::min(minCos, glm::dot(DecodeOctahedral(streams.normals[i]), normals[i] / length));
+				}
+				error.normal = std::acos(glm::clamp(minCos, -1.f, 1.f)) * 57.2957795f;
+			}
+
+			return error;
+		}
+	}
+}
@@ -0,0 +1,286 @@
+#include <ge/math/Bvh.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+
+namespace GE
+{
+	namespace Math
+	{
+		namespace
+		{
+			float HalfArea(const glm::vec3& min, const glm::vec3& max)
+			{
+				glm::vec3 d = max - min;
+				return d.x * d.y + d.y * d.z + d.z * d.x;
+			}
+		}
+
+		struct Bvh::Builder
+		{
+			static constexpr uint32_t NumBins = 16;
+
+			// Leaves grow past MaxLeafItems only when SAH says splitting does not pay off
+			static constexpr uint32_t MaxSahLeafItems = 4 * MaxLeafItems;
+
+			struct Bin
+			{
+				glm::vec3 min{ FLT_MAX };
+				glm::vec3 max{ -FLT_MAX };
+				uint32_t count{ 0 };
+			};
+
+			Bvh& bvh;
+			const AABB* boxes;
+			std::vector<glm::vec3> centroids;
+
+			void BuildNode(uint32_t first, uint32_t count, uint32_t depth)
+			{
+				bvh._depth = std::max(bvh._depth, depth);
+				uint32_t index = static_cast<uint32_t>(bvh._nodes.size());
+				bvh._nodes.push_back({});
+
+				glm::vec3 min{ FLT_MAX }, max{ -FLT_MAX };
+				glm::vec3 centroidMin{ FLT_MAX }, centroidMax{ -FLT_MAX };
+				for (uint32_t i = first; i < first + count; i++)
+				{
+					uint32_t item = bvh._items[i];
+					min = glm::min(min, boxes[item].min);
+					max = glm::max(max, boxes[item].max);
+					centroidMin = glm::min(centroidMin, centroids[item]);
+					centroidMax = glm::max(centroidMax, centroids[item]);
+				}
+
+				if (count > MaxLeafItems && depth < MaxDepth)
+				{
+					uint32_t middle = Split(first, count, HalfArea(min, max), centroidMin, centroidMax);
+					if (middle != first)
+					{
+						BuildNode(first, middle - first, depth + 1);
+						BuildNode(middle, first + count - middle, depth + 1);
+					}
+				}
+
+				// Children were pushed after this node, so index it rather than hold a reference
+				Node& node = bvh._nodes[index];
+				node.min = min;
+				node.max = max;
+				node.firstItem = first;
+				node.skip = static_cast<uint32_t>(bvh._nodes.size());
+			}
+
+			// Partitions the items and returns the first of the right half, or first for a leaf
+			uint32_t Split(uint32_t first, uint32_t count, float area, const glm::vec3& centroidMin, const glm::vec3& centroidMax)
+			{
+				uint32_t* items = bvh._items.data();
+				float bestCost = FLT_MAX;
+				int bestAxis = -1;
+				uint32_t bestBin = 0;
+
+				for (int axis = 0; axis < 3; axis++)
+				{
+					float extent = centroidMax[axis] - centroidMin[axis];
+					if (extent <= 0.f)
+						continue;
+
+					Bin bins[NumBins];
+					float scale = NumBins / extent;
+					for (uint32_t i = first; i < first + count; i++)
+					{
+						uint32_t item = items[i];
+						Bin& bin = bins[BinOf(centroids[item][axis], centroidMin[axis], scale)];
+						bin.min = glm::min(bin.min, boxes[item].min);
+						bin.max = glm::max(bin.max, boxes[item].max);
+						bin.count++;
+					}
+
+					// Sweep from the right, then evaluate every plane sweeping from the left
+					float rightCost[NumBins];
+					Bin right;
+					for (uint32_t b = NumBins - 1; b > 0; b--)
+					{
+						right.min = glm::min(right.min, bins[b].min);
+						right.max = glm::max(right.max, bins[b].max);
+						right.count += bins[b].count;
+						rightCost[b] = right.count ? right.count * HalfArea(right.min, right.max) : 0.f;
+					}
+
+					Bin left;
+					for (uint32_t b = 1; b < NumBins; b++)
+					{
+						left.min = glm::min(left.min, bins[b - 1].min);
+						left.max = glm::max(left.max, bins[b - 1].max);
+						left.count += bins[b - 1].count;
+						if (left.count == 0 || left.count == count)
+							continue;
+
+						float cost = left.count * HalfArea(left.min, left.max) + rightCost[b];
+						if (cost < bestCost)
+						{
+							bestCost = cost;
+							bestAxis = axis;
+							bestBin = b;
+						}
+					}
+				}
+
+				if (bestAxis >= 0 && bestCost >= count * area && count <= MaxSahLeafItems)
+					return first;
+
+				if (bestAxis >= 0)
+				{
+					float scale = NumBins / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+					uint32_t* middle = std::partition(items + first, items + first + count, [&](uint32_t item) {
+						return BinOf(centroids[item][bestAxis], centroidMin[bestAxis], scale) < bestBin;
+					});
+					return static_cast<uint32_t>(middle - items);
+				}
+
+				// Coincident centroids cannot be binned, halve them to keep leaves small
+				return first + count / 2;
+			}
+
+			static uint32_t BinOf(float value, float min, float scale)
+			{
+				return std::min(NumBins - 1, static_cast<uint32_t>((value - min) * scale));
+			}
+		};
+
+		struct Bvh::Culler
+		{
+			const Bvh& bvh;
+			const Frustum& frustum;
+			std::vector<uint32_t>& visible;
+			uint8_t* nodePlanes;	// Null unless culling coherently
+			uint8_t* itemPlanes;
+			CullStats stats;
+
+			bool Classify(const AABB& box, uint32_t& mask, uint8_t* planes, uint32_t index) const
+			{
+				return planes ? frustum.ClassifyBox(box.min, box.max, mask, planes[index]) : frustum.ClassifyBox(box.min, box.max, mask);
+			}
+
+			void Visit(uint32_t index, uint32_t mask)
+			{
+				const Node& node = bvh._nodes[index];
+				stats.nodesVisited++;
+				if (!Classify({ node.min, node.max }, mask, nodePlanes, index))
+					return;
+
+				uint32_t end = bvh._nodes[node.skip].firstItem;
+				if (mask == 0)
+				{
+					stats.subtreesAccepted++;
+					visible.insert(visible.end(), bvh._items.begin() + node.firstItem, bvh._items.begin() + end);
+					return;
+				}
+
+				if (node.skip == index + 1)
+				{
+					for (uint32_t i = node.firstItem; i < end; i++)
+					{
+						uint32_t itemMask = mask;
+						stats.itemsTested++;
+						if (Classify(bvh._itemBounds[i], itemMask, itemPlanes, i))
+							visible.push_back(bvh._items[i]);
+					}
+					return;
+				}
+
+				Visit(index + 1, mask);
+				Visit(bvh._nodes[index + 1].skip, mask);
+			}
+		};
+
+		void Bvh::Build(const AABB* boxes, size_t count)
+		{
+			Clear();
+			if (count == 0)
+				return;
+
+			Builder builder{ *this, boxes };
+			builder.centroids.resize(count);
+			for (size_t i = 0; i < count; i++)
+				builder.centroids[i] = (boxes[i].min + boxes[i].max) * .5f;
+
+			_items.resize(count);
+			std::iota(_items.begin(), _items.end(), 0);
+			_nodes.reserve(2 * count / MaxLeafItems + 2);
+			builder.BuildNode(0, static_cast<uint32_t>(count), 0);
+			_nodes.push_back({ glm::vec3{ 0.f }, static_cast<uint32_t>(_nodes.size() + 1), glm::vec3{ 0.f }, static_cast<uint32_t>(count) });
+
+			_itemBounds.resize(count);
+			for (size_t i = 0; i < count; i++)
+				_itemBounds[i] = boxes[_items[i]];
+
+			_nodePlanes.assign(_nodes.size(), Frustum::NoPlane);
+			_itemPlanes.assign(count, Frustum::NoPlane);
+		}
+
+		void Bvh::Refit(const AABB* boxes)
+		{
+			if (Empty())
+				return;
+
+			for (size_t i = 0; i < _items.size(); i++)
+				_itemBounds[i] = boxes[_items[i]];
+
+			// Children follow their parent, so walking back from the sentinel sees them first
+			for (size_t index = _nodes.size() - 1; index-- > 0;)
+			{
+				Node& node = _nodes[index];
+				glm::vec3 min{ FLT_MAX }, max{ -FLT_MAX };
+				if (node.skip == index + 1)
+				{
+					for (uint32_t i = node.firstItem; i < _nodes[node.skip].firstItem; i++)
+					{
+						min = glm::min(min, _itemBounds[i].min);
+						max = glm::max(max, _itemBounds[i].max);
+					}
+				}
+				else
+				{
+					const Node& left = _nodes[index + 1];
+					const Node& right = _nodes[left.skip];
+					min = glm::min(left.min, right.min);
+					max = glm::max(left.max, right.max);
+				}
+				node.min = min;
+				node.max = max;
+			}
+		}
+
+		void Bvh::Clear()
+		{
+			_nodes.clear();
+			_items.clear();
+			_itemBounds.clear();
+			_nodePlanes.clear();
+			_itemPlanes.clear();
+			_depth = 0;
+		}
+
+		void Bvh::Cull(const Frustum& frustum, std::vector<uint32_t>& visible, CullStats* stats) const
+		{
+			if (Empty())
+				return;
+
+			Culler culler{ *this, frustum, visible, nullptr, nullptr };
+			culler.Visit(0, Frustum::AllPlanes);
+			if (stats)
+				*stats = culler.stats;
+		}
+
+		void Bvh::CullCoherent(const Frustum& frustum, std::vector<uint32_t>& visible, CullStats* stats)
+		{
+			if (Empty())
+				return;
+
+			Culler culler{ *this, frustum, visible, _nodePlanes.data(), _itemPlanes.data() };
+			culler.Visit(0, Frustum::AllPlanes);
+			if (stats)
+				*stats = culler.stats;
+		}
+	}
+}
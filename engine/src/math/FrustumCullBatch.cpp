@@ -0,0 +1,270 @@
+#include <ge/math/FrustumCullBatch.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GE_CULL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GE_TARGET(isa)
+#else
+#define GE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace GE
+{
+	namespace Math
+	{
+		namespace
+		{
+			// Per plane, the component arrays holding the box corner furthest along the normal,
+			// so the kernels need no per box select
+			struct CullSetup
+			{
+				float nx[Frustum::NumPlanes], ny[Frustum::NumPlanes], nz[Frustum::NumPlanes], w[Frustum::NumPlanes];
+				const float* px[Frustum::NumPlanes];
+				const float* py[Frustum::NumPlanes];
+				const float* pz[Frustum::NumPlanes];
+				glm::vec3 cornerMin;
+				glm::vec3 cornerMax;
+			};
+
+			CullSetup MakeSetup(const Frustum& frustum, const BoundsSoA& bounds)
+			{
+				CullSetup setup;
+				for (int p = 0; p < Frustum::NumPlanes; p++)
+				{
+					const glm::vec4& plane = frustum.GetPlanes()[p];
+					setup.nx[p] = plane.x;
+					setup.ny[p] = plane.y;
+					setup.nz[p] = plane.z;
+					setup.w[p] = plane.w;
+					setup.px[p] = plane.x >= 0.f ? bounds.MaxX() : bounds.MinX();
+					setup.py[p] = plane.y >= 0.f ? bounds.MaxY() : bounds.MinY();
+					setup.pz[p] = plane.z >= 0.f ? bounds.MaxZ() : bounds.MinZ();
+				}
+
+				setup.cornerMin = frustum.GetCornerMin();
+				setup.cornerMax = frustum.GetCornerMax();
+				return setup;
+			}
+
+			// Every kernel evaluates ((nx * px + ny * py) + nz * pz) + w in this order, so all
+			// levels produce identical masks
+			void CullScalar(const CullSetup& s, const BoundsSoA& bounds, size_t count, uint64_t* visible)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					bool outside = bounds.MaxX()[i] < s.cornerMin.x || bounds.MinX()[i] > s.cornerMax.x
+						|| bounds.MaxY()[i] < s.cornerMin.y || bounds.MinY()[i] > s.cornerMax.y
+						|| bounds.MaxZ()[i] < s.cornerMin.z || bounds.MinZ()[i] > s.cornerMax.z;
+
+					for (int p = 0; p < Frustum::NumPlanes && !outside; p++)
+						outside = ((s.nx[p] * s.px[p][i] + s.ny[p] * s.py[p][i]) + s.nz[p] * s.pz[p][i]) + s.w[p] < 0.f;
+
+					if (!outside)
+						visible[i / 64] |= uint64_t(1) << (i % 64);
+				}
+			}
+
+#ifdef GE_CULL_X86
+			GE_TARGET("sse2")
+			void CullSse(const CullSetup& s, const BoundsSoA& bounds, size_t count, uint64_t* visible)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 cornerMinX = _mm_set1_ps(s.cornerMin.x), cornerMinY = _mm_set1_ps(s.cornerMin.y), cornerMinZ = _mm_set1_ps(s.cornerMin.z);
+				const __m128 cornerMaxX = _mm_set1_ps(s.cornerMax.x), cornerMaxY = _mm_set1_ps(s.cornerMax.y), cornerMaxZ = _mm_set1_ps(s.cornerMax.z);
+
+				for (size_t i = 0; i < count; i += 4)
+				{
+					__m128 outside = _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(bounds.MaxX() + i), cornerMinX), _mm_cmpgt_ps(_mm_loadu_ps(bounds.MinX() + i), cornerMaxX));
+					outside = _mm_or_ps(outside, _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(bounds.MaxY() + i), cornerMinY), _mm_cmpgt_ps(_mm_loadu_ps(bounds.MinY() + i), cornerMaxY)));
+					outside = _mm_or_ps(outside, _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(bounds.MaxZ() + i), cornerMinZ), _mm_cmpgt_ps(_mm_loadu_ps(bounds.MinZ() + i), cornerMaxZ)));
+
+					for (int p = 0; p < Frustum::NumPlanes; p++)
+					{
+						__m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.nx[p]), _mm_loadu_ps(s.px[p] + i)), _mm_mul_ps(_mm_set1_ps(s.ny[p]), _mm_loadu_ps(s.py[p] + i)));
+						d = _mm_add_ps(_mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(s.nz[p]), _mm_loadu_ps(s.pz[p] + i))), _mm_set1_ps(s.w[p]));
+						outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+					}
+
+					uint64_t bits = static_cast<uint32_t>(~_mm_movemask_ps(outside)) & 0xF;
+					visible[i / 64] |= bits << (i % 64);
+				}
+			}
+
+			GE_TARGET("avx2")
+			void CullAvx2(const CullSetup& s, const BoundsSoA& bounds, size_t count, uint64_t* visible)
+			{
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 cornerMinX = _mm256_set1_ps(s.cornerMin.x), cornerMinY = _mm256_set1_ps(s.cornerMin.y), cornerMinZ = _mm256_set1_ps(s.cornerMin.z);
+				const __m256 cornerMaxX = _mm256_set1_ps(s.cornerMax.x), cornerMaxY = _mm256_set1_ps(s.cornerMax.y), cornerMaxZ = _mm256_set1_ps(s.cornerMax.z);
+
+				for (size_t i = 0; i < count; i += 8)
+				{
+					__m256 outside = _mm256_or_ps(_mm256_cmp_ps(_mm256_loadu_ps(bounds.MaxX() + i), cornerMinX, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_loadu_ps(bounds.MinX() + i), cornerMaxX, _CMP_GT_OQ));
+					outside = _mm256_or_ps(outside, _mm256_or_ps(_mm256_cmp_ps(_mm256_loadu_ps(bounds.MaxY() + i), cornerMinY, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_loadu_ps(bounds.MinY() + i), cornerMaxY, _CMP_GT_OQ)));
+					outside = _mm256_or_ps(outside, _mm256_or_ps(_mm256_cmp_ps(_mm256_loadu_ps(bounds.MaxZ() + i), cornerMinZ, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_loadu_ps(bounds.MinZ() + i), cornerMaxZ, _CMP_GT_OQ)));
+
+					for (int p = 0; p < Frustum::NumPlanes; p++)
+					{
+						__m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s.nx[p]), _mm256_loadu_ps(s.px[p] + i)), _mm256_mul_ps(_mm256_set1_ps(s.ny[p]), _mm256_loadu_ps(s.py[p] + i)));
+						d = _mm256_add_ps(_mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(s.nz[p]), _mm256_loadu_ps(s.pz[p] + i))), _mm256_set1_ps(s.w[p]));
+						outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, zero, _CMP_LT_OQ));
+					}
+
+					uint64_t bits = static_cast<uint32_t>(~_mm256_movemask_ps(outside)) & 0xFF;
+					visible[i / 64] |= bits << (i % 64);
+				}
+			}
+
+			GE_TARGET("avx512f")
+			void CullAvx512(const CullSetup& s, const BoundsSoA& bounds, size_t count, uint64_t* visible)
+			{
+				const __m512 zero = _mm512_setzero_ps();
+				const __m512 cornerMinX = _mm512_set1_ps(s.cornerMin.x), cornerMinY = _mm512_set1_ps(s.cornerMin.y), cornerMinZ = _mm512_set1_ps(s.cornerMin.z);
+				const __m512 cornerMaxX = _mm512_set1_ps(s.cornerMax.x), cornerMaxY = _mm512_set1_ps(s.cornerMax.y), cornerMaxZ = _mm512_set1_ps(s.cornerMax.z);
+
+				for (size_t i = 0; i < count; i += 16)
+				{
+					__mmask16 outside = _mm512_cmp_ps_mask(_mm512_loadu_ps(bounds.MaxX() + i), cornerMinX, _CMP_LT_OQ) | _mm512_cmp_ps_mask(_mm512_loadu_ps(bounds.MinX() + i), cornerMaxX, _CMP_GT_OQ);
+					outside |= _mm512_cmp_ps_mask(_mm512_loadu_ps(bounds.MaxY() + i), cornerMinY, _CMP_LT_OQ) | _mm512_cmp_ps_mask(_mm512_loadu_ps(bounds.MinY() + i), cornerMaxY, _CMP_GT_OQ);
+					outside |= _mm512_cmp_ps_mask(_mm512_loadu_ps(bounds.MaxZ() + i), cornerMinZ, _CMP_LT_OQ) | _mm512_cmp_ps_mask(_mm512_loadu_ps(bounds.MinZ() + i), cornerMaxZ, _CMP_GT_OQ);
+
+					for (int p = 0; p < Frustum::NumPlanes; p++)
+					{
+						__m512 d = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(s.nx[p]), _mm512_loadu_ps(s.px[p] + i)), _mm512_mul_ps(_mm512_set1_ps(s.ny[p]), _mm512_loadu_ps(s.py[p] + i)));
+						d = _mm512_add_ps(_mm512_add_ps(d, _mm512_mul_ps(_mm512_set1_ps(s.nz[p]), _mm512_loadu_ps(s.pz[p] + i))), _mm512_set1_ps(s.w[p]));
+						outside |= _mm512_cmp_ps_mask(d, zero, _CMP_LT_OQ);
+					}
+
+					uint64_t bits = static_cast<uint16_t>(~outside);
+					visible[i / 64] |= bits << (i % 64);
+				}
+			}
+#endif
+
+			SimdLevel DetectSimdLevel()
+			{
+#if !defined(GE_CULL_X86)
+				return SimdLevel::Scalar;
+#elif defined(_MSC_VER)
+				int info[4];
+				__cpuid(info, 0);
+				int maxLeaf = info[0];
+
+				__cpuid(info, 1);
+				bool sse2 = (info[3] & (1 << 26)) != 0;
+				bool osxsave = (info[2] & (1 << 27)) != 0;
+				bool avx = (info[2] & (1 << 28)) != 0;
+				if (!sse2)
+					return SimdLevel::Scalar;
+				if (!osxsave || !avx || maxLeaf < 7)
+					return SimdLevel::Sse;
+
+				// The OS must save the YMM (and for AVX-512 the opmask and ZMM) state
+				unsigned long long xcr0 = _xgetbv(0);
+				if ((xcr0 & 0x6) != 0x6)
+					return SimdLevel::Sse;
+
+				__cpuidex(info, 7, 0);
+				if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+					return SimdLevel::Avx512;
+				return (info[1] & (1 << 5)) ? SimdLevel::Avx2 : SimdLevel::Sse;
+#else
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx512f"))
+					return SimdLevel::Avx512;
+				if (__builtin_cpu_supports("avx2"))
+					return SimdLevel::Avx2;
+				if (__builtin_cpu_supports("sse2"))
+					return SimdLevel::Sse;
+				return SimdLevel::Scalar;
+#endif
+			}
+		}
+
+		void BoundsSoA::Clear()
+		{
+			_size = 0;
+			for (auto* component : { &_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ })
+				component->clear();
+		}
+
+		void BoundsSoA::Reserve(size_t count)
+		{
+			size_t padded = (count + Padding - 1) / Padding * Padding;
+			for (auto* component : { &_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ })
+				component->reserve(padded);
+		}
+
+		uint32_t BoundsSoA::Push(const glm::vec3& min, const glm::vec3& max)
+		{
+			// Grow a whole padding block at a time, the kernels read it and mask the results
+			if (_size == _minX.size())
+			{
+				for (auto* component : { &_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ })
+					component->resize(_size + Padding, 0.f);
+			}
+
+			_minX[_size] = min.x;
+			_minY[_size] = min.y;
+			_minZ[_size] = min.z;
+			_maxX[_size] = max.x;
+			_maxY[_size] = max.y;
+			_maxZ[_size] = max.z;
+			return static_cast<uint32_t>(_size++);
+		}
+
+		const char* ToString(SimdLevel level)
+		{
+			switch (level)
+			{
+			case SimdLevel::Scalar: return "scalar";
+			case SimdLevel::Sse: return "sse";
+			case SimdLevel::Avx2: return "avx2";
+			case SimdLevel::Avx512: return "avx512";
+			}
+			return "unknown";
+		}
+
+		SimdLevel ActiveSimdLevel()
+		{
+			static const SimdLevel level = DetectSimdLevel();
+			return level;
+		}
+
+		void CullBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint64_t* visible)
+		{
+			CullBoxes(frustum, bounds, visible, ActiveSimdLevel());
+		}
+
+		void CullBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint64_t* visible, SimdLevel level)
+		{
+			size_t count = bounds.Size();
+			size_t words = VisibilityWords(count);
+			if (count == 0)
+				return;
+
+			std::memset(visible, 0, words * sizeof(uint64_t));
+			CullSetup setup = MakeSetup(frustum, bounds);
+
+			switch (std::min(level, ActiveSimdLevel()))
+			{
+#ifdef GE_CULL_X86
+			case SimdLevel::Avx512: CullAvx512(setup, bounds, count, visible); break;
+			case SimdLevel::Avx2: CullAvx2(setup, bounds, count, visible); break;
+			case SimdLevel::Sse: CullSse(setup, bounds, count, visible); break;
+#endif
+			default: CullScalar(setup, bounds, count, visible); break;
+			}
+
+			// The vector kernels also test the padding
+			if (count % 64)
+				visible[words - 1] &= (uint64_t(1) << (count % 64)) - 1;
+		}
+	}
+}
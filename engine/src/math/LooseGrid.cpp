@@ -0,0 +1,385 @@
+#include <ge/math/LooseGrid.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace GE
+{
+	namespace Math
+	{
+		namespace
+		{
+			// Keeps floor() of far away points inside int
+			constexpr float MaxCoord = 1073741824.f;
+
+			// A hash probe costs about this many entries of a linear scan over the occupied list
+			constexpr double ProbeCost = 16.0;
+
+			constexpr size_t MinTableSize = 64;
+
+			size_t HashOf(uint32_t level, const glm::ivec3& coord)
+			{
+				uint64_t h = static_cast<uint32_t>(coord.x) * 0x9E3779B97F4A7C15ull;
+				h ^= static_cast<uint32_t>(coord.y) * 0xC2B2AE3D27D4EB4Full;
+				h ^= static_cast<uint32_t>(coord.z) * 0x165667B19E3779F9ull;
+				h ^= level * 0x27D4EB2F165667C5ull;
+				return static_cast<size_t>(h ^ (h >> 29));
+			}
+
+			bool Overlaps(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB, const glm::vec3& maxB)
+			{
+				return minA.x <= maxB.x && maxA.x >= minB.x && minA.y <= maxB.y && maxA.y >= minB.y && minA.z <= maxB.z && maxA.z >= minB.z;
+			}
+
+			bool Contains(const glm::vec3& outerMin, const glm::vec3& outerMax, const glm::vec3& min, const glm::vec3& max)
+			{
+				return outerMin.x <= min.x && outerMin.y <= min.y && outerMin.z <= min.z && max.x <= outerMax.x && max.y <= outerMax.y && max.z <= outerMax.z;
+			}
+
+			float DistanceSquared(const glm::vec3& point, const glm::vec3& min, const glm::vec3& max)
+			{
+				glm::vec3 d = glm::max(glm::max(min - point, point - max), glm::vec3{ 0.f });
+				return glm::dot(d, d);
+			}
+
+			float FarthestSquared(const glm::vec3& point, const glm::vec3& min, const glm::vec3& max)
+			{
+				glm::vec3 d = glm::max(glm::abs(point - min), glm::abs(max - point));
+				return glm::dot(d, d);
+			}
+		}
+
+		LooseGrid::LooseGrid(float cellSize)
+		{
+			for (uint32_t level = 0; level < MaxLevels; level++)
+				_levels[level].size = cellSize * static_cast<float>(1u << level);
+			Clear();
+		}
+
+		uint32_t LooseGrid::Insert(const AABB& bounds, uint32_t value)
+		{
+			uint32_t handle = _freeItem;
+			if (handle != InvalidHandle)
+				_freeItem = _items[handle].slot;
+			else
+			{
+				handle = static_cast<uint32_t>(_items.size());
+				_items.emplace_back();
+			}
+
+			_items[handle].bounds = bounds;
+			_items[handle].value = value;
+			Attach(handle, KeyOf(bounds));
+			_numItems++;
+			return handle;
+		}
+
+		void LooseGrid::Update(uint32_t handle, const AABB& bounds)
+		{
+			Item& item = _items[handle];
+			item.bounds = bounds;
+
+			CellKey key = KeyOf(bounds);
+			if (key == item.key)
+				return;
+
+			Detach(handle);
+			Attach(handle, key);
+		}
+
+		void LooseGrid::Remove(uint32_t handle)
+		{
+			Detach(handle);
+			_items[handle].cell = InvalidHandle;
+			_items[handle].slot = _freeItem;
+			_freeItem = handle;
+			_numItems--;
+		}
+
+		void LooseGrid::Clear()
+		{
+			_items.clear();
+			_freeItem = InvalidHandle;
+			_numItems = 0;
+			_cells.clear();
+			_freeCells.clear();
+			_table.assign(MinTableSize, { {}, InvalidHandle });
+			for (Level& level : _levels)
+			{
+				level.margin = level.size * .5f;
+				level.first = glm::ivec3{ INT_MAX, INT_MAX, INT_MAX };
+				level.last = glm::ivec3{ INT_MIN, INT_MIN, INT_MIN };
+				level.occupied.clear();
+			}
+		}
+
+		LooseGrid::CellKey LooseGrid::KeyOf(const AABB& bounds) const
+		{
+			glm::vec3 size = bounds.max - bounds.min;
+			float extent = std::max({ size.x, size.y, size.z });
+
+			uint32_t level = 0;
+			while (level < MaxLevels - 1 && _levels[level].size < extent)
+				level++;
+
+			return { level, CoordOf(level, (bounds.min + bounds.max) * .5f) };
+		}
+
+		glm::ivec3 LooseGrid::CoordOf(uint32_t level, const glm::vec3& point) const
+		{
+			glm::vec3 cell = glm::clamp(point / _levels[level].size, -MaxCoord, MaxCoord);
+			return { static_cast<int>(std::floor(cell.x)), static_cast<int>(std::floor(cell.y)), static_cast<int>(std::floor(cell.z)) };
+		}
+
+		void LooseGrid::LooseBounds(const Level& level, const glm::ivec3& coord, glm::vec3& min, glm::vec3& max) const
+		{
+			glm::vec3 corner{ coord.x * level.size, coord.y * level.size, coord.z * level.size };
+			min = corner - glm::vec3{ level.margin };
+			max = corner + glm::vec3{ level.size + level.margin };
+		}
+
+		uint32_t LooseGrid::FindCell(const CellKey& key) const
+		{
+			size_t mask = _table.size() - 1;
+			for (size_t i = HashOf(key.level, key.coord) & mask;; i = (i + 1) & mask)
+			{
+				const Slot& slot = _table[i];
+				if (slot.cell == InvalidHandle || slot.key == key)
+					return slot.cell;
+			}
+		}
+
+		uint32_t LooseGrid::FindOrAddCell(const CellKey& key)
+		{
+			// Keep the table at most half full
+			if (2 * (NumCells() + 1) > _table.size())
+				GrowTable();
+
+			size_t mask = _table.size() - 1;
+			size_t i = HashOf(key.level, key.coord) & mask;
+			for (; _table[i].cell != InvalidHandle; i = (i + 1) & mask)
+			{
+				if (_table[i].key == key)
+					return _table[i].cell;
+			}
+
+			uint32_t index;
+			if (!_freeCells.empty())
+			{
+				index = _freeCells.back();
+				_freeCells.pop_back();
+			}
+			else
+			{
+				index = static_cast<uint32_t>(_cells.size());
+				_cells.emplace_back();
+			}
+			_table[i] = { key, index };
+
+			// The item list keeps its capacity from the cell's previous use
+			Cell& cell = _cells[index];
+			Level& level = _levels[key.level];
+			cell.key = key;
+			cell.occupiedSlot = static_cast<uint32_t>(level.occupied.size());
+			level.occupied.push_back({ key.coord, index });
+			level.first = glm::min(level.first, key.coord);
+			level.last = glm::max(level.last, key.coord);
+			return index;
+		}
+
+		void LooseGrid::EraseSlot(const CellKey& key)
+		{
+			size_t mask = _table.size() - 1;
+			size_t hole = HashOf(key.level, key.coord) & mask;
+			while (!(_table[hole].key == key))
+				hole = (hole + 1) & mask;
+
+			// Shift back later entries of the run that the hole would cut off from their home slot
+			for (size_t i = (hole + 1) & mask; _table[i].cell != InvalidHandle; i = (i + 1) & mask)
+			{
+				size_t home = HashOf(_table[i].key.level, _table[i].key.coord) & mask;
+				if (((i - home) & mask) >= ((i - hole) & mask))
+				{
+					_table[hole] = _table[i];
+					hole = i;
+				}
+			}
+			_table[hole].cell = InvalidHandle;
+		}
+
+		void LooseGrid::GrowTable()
+		{
+			std::vector<Slot> old(2 * _table.size(), { {}, InvalidHandle });
+			old.swap(_table);
+
+			size_t mask = _table.size() - 1;
+			for (const Slot& slot : old)
+			{
+				if (slot.cell == InvalidHandle)
+					continue;
+
+				size_t i = HashOf(slot.key.level, slot.key.coord) & mask;
+				while (_table[i].cell != InvalidHandle)
+					i = (i + 1) & mask;
+				_table[i] = slot;
+			}
+		}
+
+		void LooseGrid::Attach(uint32_t handle, const CellKey& key)
+		{
+			// Only the coarsest level takes boxes larger than its cells
+			Item& item = _items[handle];
+			glm::vec3 size = item.bounds.max - item.bounds.min;
+			float& margin = _levels[key.level].margin;
+			margin = std::max(margin, std::max({ size.x, size.y, size.z }) * .5f);
+
+			uint32_t index = FindOrAddCell(key);
+			Cell& cell = _cells[index];
+			item.key = key;
+			item.cell = index;
+			item.slot = static_cast<uint32_t>(cell.items.size());
+			cell.items.push_back(handle);
+		}
+
+		void LooseGrid::Detach(uint32_t handle)
+		{
+			Item& item = _items[handle];
+			Cell& cell = _cells[item.cell];
+
+			uint32_t last = cell.items.back();
+			cell.items[item.slot] = last;
+			_items[last].slot = item.slot;
+			cell.items.pop_back();
+
+			if (!cell.items.empty())
+				return;
+
+			auto& occupied = _levels[cell.key.level].occupied;
+			occupied[cell.occupiedSlot] = occupied.back();
+			_cells[occupied.back().cell].occupiedSlot = cell.occupiedSlot;
+			occupied.pop_back();
+
+			EraseSlot(cell.key);
+			_freeCells.push_back(item.cell);
+		}
+
+		template <typename Visitor>
+		void LooseGrid::ForEachCell(const glm::vec3& min, const glm::vec3& max, Visitor&& visit) const
+		{
+			for (uint32_t index = 0; index < MaxLevels; index++)
+			{
+				const Level& level = _levels[index];
+				if (level.occupied.empty())
+					continue;
+
+				// Cells outside the used coordinates cannot be occupied
+				glm::ivec3 first = glm::max(level.first, CoordOf(index, min - glm::vec3{ level.margin }));
+				glm::ivec3 last = glm::min(level.last, CoordOf(index, max + glm::vec3{ level.margin }));
+				if (first.x > last.x || first.y > last.y || first.z > last.z)
+					continue;
+
+				// Probe the covered cells when that is cheaper than scanning the packed occupied list
+				double covered = double(last.x - first.x + 1) * double(last.y - first.y + 1) * double(last.z - first.z + 1);
+				if (covered * ProbeCost <= double(level.occupied.size()))
+				{
+					for (int z = first.z; z <= last.z; z++)
+						for (int y = first.y; y <= last.y; y++)
+							for (int x = first.x; x <= last.x; x++)
+							{
+								glm::ivec3 coord{ x, y, z };
+								uint32_t cell = FindCell({ index, coord });
+								if (cell != InvalidHandle)
+									visit(level, coord, cell);
+							}
+				}
+				else
+				{
+					for (const OccupiedCell& cell : level.occupied)
+					{
+						const glm::ivec3& coord = cell.coord;
+						if (coord.x >= first.x && coord.x <= last.x && coord.y >= first.y && coord.y <= last.y && coord.z >= first.z && coord.z <= last.z)
+							visit(level, coord, cell.cell);
+					}
+				}
+			}
+		}
+
+		void LooseGrid::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& values, QueryStats* stats) const
+		{
+			QueryStats local;
+			ForEachCell(frustum.GetCornerMin(), frustum.GetCornerMax(), [&](const Level& level, const glm::ivec3& coord, uint32_t cell) {
+				local.cellsVisited++;
+
+				glm::vec3 min, max;
+				LooseBounds(level, coord, min, max);
+				uint32_t mask = Frustum::AllPlanes;
+				if (!frustum.ClassifyBox(min, max, mask))
+					return;
+
+				for (uint32_t handle : _cells[cell].items)
+				{
+					const Item& item = _items[handle];
+					uint32_t itemMask = mask;
+					local.itemsTested += mask != 0;
+					if (mask == 0 || frustum.ClassifyBox(item.bounds.min, item.bounds.max, itemMask))
+						values.push_back(item.value);
+				}
+			});
+
+			if (stats)
+				*stats = local;
+		}
+
+		void LooseGrid::QueryBox(const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<uint32_t>& values, QueryStats* stats) const
+		{
+			QueryStats local;
+			ForEachCell(queryMin, queryMax, [&](const Level& level, const glm::ivec3& coord, uint32_t cell) {
+				local.cellsVisited++;
+
+				glm::vec3 min, max;
+				LooseBounds(level, coord, min, max);
+				if (!Overlaps(min, max, queryMin, queryMax))
+					return;
+
+				bool inside = Contains(queryMin, queryMax, min, max);
+				for (uint32_t handle : _cells[cell].items)
+				{
+					const Item& item = _items[handle];
+					local.itemsTested += !inside;
+					if (inside || Overlaps(item.bounds.min, item.bounds.max, queryMin, queryMax))
+						values.push_back(item.value);
+				}
+			});
+
+			if (stats)
+				*stats = local;
+		}
+
+		void LooseGrid::QuerySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& values, QueryStats* stats) const
+		{
+			QueryStats local;
+			float radiusSquared = radius * radius;
+			ForEachCell(center - glm::vec3{ radius }, center + glm::vec3{ radius }, [&](const Level& level, const glm::ivec3& coord, uint32_t cell) {
+				local.cellsVisited++;
+
+				glm::vec3 min, max;
+				LooseBounds(level, coord, min, max);
+				if (DistanceSquared(center, min, max) > radiusSquared)
+					return;
+
+				bool inside = FarthestSquared(center, min, max) <= radiusSquared;
+				for (uint32_t handle : _cells[cell].items)
+				{
+					const Item& item = _items[handle];
+					local.itemsTested += !inside;
+					if (inside || DistanceSquared(center, item.bounds.min, item.bounds.max) <= radiusSquared)
+						values.push_back(item.value);
+				}
+			});
+
+			if (stats)
+				*stats = local;
+		}
+	}
+}
@@ -0,0 +1,301 @@
+#include <ge/math/OcclusionBuffer.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GE_OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+namespace GE
+{
+	namespace Math
+	{
+		namespace
+		{
+			constexpr uint32_t TileSize = OcclusionBuffer::TileWidth * OcclusionBuffer::TileHeight;
+
+			// Triangles are clipped to w >= NearW, the near plane of any sensible projection is further out
+			constexpr float NearW = 1e-3f;
+
+			size_t TileOffset(uint32_t tileX, uint32_t tileY)
+			{
+				return (size_t(tileY) * OcclusionBuffer::TilesX + tileX) * TileSize;
+			}
+
+			bool AllOutside(const glm::vec4* clip, int axis, float sign)
+			{
+				return clip[0].w + sign * clip[0][axis] < 0.f && clip[1].w + sign * clip[1][axis] < 0.f && clip[2].w + sign * clip[2][axis] < 0.f;
+			}
+		}
+
+		OcclusionBuffer::OcclusionBuffer()
+			: _depth(size_t(Width) * Height, 0.f)
+			, _tileFar(size_t(TilesX) * TilesY, 0.f)
+		{
+		}
+
+		void OcclusionBuffer::Begin(const glm::mat4& viewProjection)
+		{
+			_viewProjection = viewProjection;
+			_triangles.clear();
+		}
+
+		void OcclusionBuffer::AddOccluder(const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount)
+		{
+			for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+			{
+				glm::vec4 clip[3];
+				for (int k = 0; k < 3; k++)
+					clip[k] = _viewProjection * glm::vec4(vertices[indices[i + k]], 1.f);
+
+				if (AllOutside(clip, 0, 1.f) || AllOutside(clip, 0, -1.f) || AllOutside(clip, 1, 1.f) || AllOutside(clip, 1, -1.f))
+					continue;
+				if (clip[0].w < NearW && clip[1].w < NearW && clip[2].w < NearW)
+					continue;
+
+				// Clipping a triangle to one plane leaves at most a quad
+				glm::vec4 polygon[4];
+				int count = 0;
+				for (int k = 0; k < 3; k++)
+				{
+					const glm::vec4& a = clip[k];
+					const glm::vec4& b = clip[(k + 1) % 3];
+					float da = a.w - NearW, db = b.w - NearW;
+					if (da >= 0.f)
+						polygon[count++] = a;
+					if ((da >= 0.f) != (db >= 0.f))
+						polygon[count++] = a + (b - a) * (da / (da - db));
+				}
+
+				for (int k = 1; k + 1 < count; k++)
+					SetupTriangle(polygon[0], polygon[k], polygon[k + 1]);
+			}
+		}
+
+		void OcclusionBuffer::SetupTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2)
+		{
+			const glm::vec4* v[3] = { &v0, &v1, &v2 };
+			double x[3], y[3], z[3];
+			for (int k = 0; k < 3; k++)
+			{
+				double invW = 1.0 / v[k]->w;
+				x[k] = (v[k]->x * invW * .5 + .5) * Width;
+				y[k] = (v[k]->y * invW * .5 + .5) * Height;
+				z[k] = invW;
+			}
+
+			// Occluders are drawn two sided, so wind every triangle counter clockwise
+			double area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+			if (std::abs(area) < 1e-6)
+				return;
+			if (area < 0.0)
+			{
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				std::swap(z[1], z[2]);
+				area = -area;
+			}
+
+			// Pixels whose center lies in the bounding rectangle
+			double minX = std::max(std::min({ x[0], x[1], x[2] }), -1.0);
+			double maxX = std::min(std::max({ x[0], x[1], x[2] }), double(Width));
+			double minY = std::max(std::min({ y[0], y[1], y[2] }), -1.0);
+			double maxY = std::min(std::max({ y[0], y[1], y[2] }), double(Height));
+			int firstX = std::max(0, static_cast<int>(std::ceil(minX - .5)));
+			int lastX = std::min(int(Width) - 1, static_cast<int>(std::floor(maxX - .5)));
+			int firstY = std::max(0, static_cast<int>(std::ceil(minY - .5)));
+			int lastY = std::min(int(Height) - 1, static_cast<int>(std::floor(maxY - .5)));
+			if (firstX > lastX || firstY > lastY)
+				return;
+
+			// Edge k runs from vertex k to the next and is positive inside. The barycentric weight
+			// of a vertex is the edge opposite it over the area, which gives the 1/w plane.
+			Triangle triangle;
+			double a[3], b[3], c[3];
+			for (int k = 0; k < 3; k++)
+			{
+				int next = (k + 1) % 3;
+				a[k] = y[k] - y[next];
+				b[k] = x[next] - x[k];
+				c[k] = x[k] * y[next] - y[k] * x[next];
+				triangle.edgeA[k] = static_cast<float>(a[k]);
+				triangle.edgeB[k] = static_cast<float>(b[k]);
+				triangle.edgeC[k] = c[k];
+			}
+			triangle.depthA = static_cast<float>((a[1] * z[0] + a[2] * z[1] + a[0] * z[2]) / area);
+			triangle.depthB = static_cast<float>((b[1] * z[0] + b[2] * z[1] + b[0] * z[2]) / area);
+			triangle.depthC = (c[1] * z[0] + c[2] * z[1] + c[0] * z[2]) / area;
+
+			triangle.firstTileX = firstX / int(TileWidth);
+			triangle.lastTileX = lastX / int(TileWidth);
+			triangle.firstTileY = firstY / int(TileHeight);
+			triangle.lastTileY = lastY / int(TileHeight);
+			_triangles.push_back(triangle);
+		}
+
+		void OcclusionBuffer::Rasterize(uint32_t firstRow, uint32_t endRow)
+		{
+			std::fill(_depth.begin() + TileOffset(0, firstRow), _depth.begin() + TileOffset(0, endRow), 0.f);
+
+			for (const Triangle& triangle : _triangles)
+			{
+				int firstTileY = std::max(triangle.firstTileY, int(firstRow));
+				int lastTileY = std::min(triangle.lastTileY, int(endRow) - 1);
+				for (int tileY = firstTileY; tileY <= lastTileY; tileY++)
+				{
+					for (int tileX = triangle.firstTileX; tileX <= triangle.lastTileX; tileX++)
+					{
+						// Edges and depth at the tile's first pixel center
+						double originX = tileX * double(TileWidth) + .5;
+						double originY = tileY * double(TileHeight) + .5;
+						float e[3];
+						bool outside = false;
+						for (int k = 0; k < 3; k++)
+						{
+							e[k] = static_cast<float>(triangle.edgeA[k] * originX + triangle.edgeB[k] * originY + triangle.edgeC[k]);
+							float largest = e[k] + std::max(triangle.edgeA[k], 0.f) * (TileWidth - 1) + std::max(triangle.edgeB[k], 0.f) * (TileHeight - 1);
+							outside |= largest < 0.f;
+						}
+						if (outside)
+							continue;
+
+						float z = static_cast<float>(triangle.depthA * originX + triangle.depthB * originY + triangle.depthC);
+						float* depth = _depth.data() + TileOffset(tileX, tileY);
+
+						// Every path computes (origin + b * row) + a * column, masked lanes write 0
+						// and 1/w is positive, so max() both tests and keeps the nearest
+#ifdef GE_OCCLUSION_SSE
+						const __m128 zero = _mm_setzero_ps();
+						const __m128 columns0 = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+						const __m128 columns1 = _mm_setr_ps(4.f, 5.f, 6.f, 7.f);
+						for (uint32_t row = 0; row < TileHeight; row++)
+						{
+							__m128 inside0 = _mm_castsi128_ps(_mm_set1_epi32(-1));
+							__m128 inside1 = inside0;
+							for (int k = 0; k < 3; k++)
+							{
+								__m128 rowValue = _mm_set1_ps(e[k] + triangle.edgeB[k] * row);
+								__m128 a = _mm_set1_ps(triangle.edgeA[k]);
+								inside0 = _mm_and_ps(inside0, _mm_cmpge_ps(_mm_add_ps(rowValue, _mm_mul_ps(a, columns0)), zero));
+								inside1 = _mm_and_ps(inside1, _mm_cmpge_ps(_mm_add_ps(rowValue, _mm_mul_ps(a, columns1)), zero));
+							}
+
+							__m128 rowDepth = _mm_set1_ps(z + triangle.depthB * row);
+							__m128 a = _mm_set1_ps(triangle.depthA);
+							float* pixels = depth + row * TileWidth;
+							_mm_storeu_ps(pixels, _mm_max_ps(_mm_loadu_ps(pixels), _mm_and_ps(inside0, _mm_add_ps(rowDepth, _mm_mul_ps(a, columns0)))));
+							_mm_storeu_ps(pixels + 4, _mm_max_ps(_mm_loadu_ps(pixels + 4), _mm_and_ps(inside1, _mm_add_ps(rowDepth, _mm_mul_ps(a, columns1)))));
+						}
+#else
+						for (uint32_t row = 0; row < TileHeight; row++)
+						{
+							for (uint32_t column = 0; column < TileWidth; column++)
+							{
+								bool inside = true;
+								for (int k = 0; k < 3; k++)
+									inside &= (e[k] + triangle.edgeB[k] * row) + triangle.edgeA[k] * column >= 0.f;
+
+								float value = (z + triangle.depthB * row) + triangle.depthA * column;
+								float& pixel = depth[row * TileWidth + column];
+								pixel = std::max(pixel, inside ? value : 0.f);
+							}
+						}
+#endif
+					}
+				}
+			}
+
+			for (uint32_t tileY = firstRow; tileY < endRow; tileY++)
+			{
+				for (uint32_t tileX = 0; tileX < TilesX; tileX++)
+				{
+					const float* depth = _depth.data() + TileOffset(tileX, tileY);
+					_tileFar[tileY * TilesX + tileX] = *std::min_element(depth, depth + TileSize);
+				}
+			}
+		}
+
+		bool OcclusionBuffer::IsBoxVisible(const glm::vec3& min, const glm::vec3& max) const
+		{
+			float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+			float nearest = 0.f;
+			for (int corner = 0; corner < 8; corner++)
+			{
+				glm::vec3 point{ corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z };
+				glm::vec4 clip = _viewProjection * glm::vec4(point, 1.f);
+				if (clip.w <= NearW)
+					return true;
+
+				float invW = 1.f / clip.w;
+				float x = (clip.x * invW * .5f + .5f) * Width;
+				float y = (clip.y * invW * .5f + .5f) * Height;
+				minX = std::min(minX, x);
+				maxX = std::max(maxX, x);
+				minY = std::min(minY, y);
+				maxY = std::max(maxY, y);
+				nearest = std::max(nearest, invW);
+			}
+
+			// Off screen boxes are left to frustum culling
+			if (maxX < 0.f || minX > float(Width) || maxY < 0.f || minY > float(Height))
+				return true;
+
+			// Every pixel the box's rectangle touches, at least the one it falls in
+			int firstX = std::min(static_cast<int>(std::floor(std::max(minX, 0.f))), int(Width) - 1);
+			int lastX = std::max(static_cast<int>(std::ceil(std::min(maxX, float(Width)))) - 1, firstX);
+			int firstY = std::min(static_cast<int>(std::floor(std::max(minY, 0.f))), int(Height) - 1);
+			int lastY = std::max(static_cast<int>(std::ceil(std::min(maxY, float(Height)))) - 1, firstY);
+
+			for (int tileY = firstY / int(TileHeight); tileY <= lastY / int(TileHeight); tileY++)
+			{
+				for (int tileX = firstX / int(TileWidth); tileX <= lastX / int(TileWidth); tileX++)
+				{
+					if (nearest < _tileFar[tileY * TilesX + tileX])
+						continue;
+
+					// Some pixel of the tile is not in front, check those the box covers
+					int firstColumn = std::max(firstX - tileX * int(TileWidth), 0);
+					int lastColumn = std::min(lastX - tileX * int(TileWidth), int(TileWidth) - 1);
+					int firstRow = std::max(firstY - tileY * int(TileHeight), 0);
+					int lastRow = std::min(lastY - tileY * int(TileHeight), int(TileHeight) - 1);
+					const float* depth = _depth.data() + TileOffset(tileX, tileY);
+
+#ifdef GE_OCCLUSION_SSE
+					const __m128 columns0 = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+					const __m128 columns1 = _mm_setr_ps(4.f, 5.f, 6.f, 7.f);
+					const __m128 first = _mm_set1_ps(float(firstColumn)), last = _mm_set1_ps(float(lastColumn));
+					const __m128 covered0 = _mm_and_ps(_mm_cmpge_ps(columns0, first), _mm_cmple_ps(columns0, last));
+					const __m128 covered1 = _mm_and_ps(_mm_cmpge_ps(columns1, first), _mm_cmple_ps(columns1, last));
+					const __m128 boxDepth = _mm_set1_ps(nearest);
+					for (int row = firstRow; row <= lastRow; row++)
+					{
+						const float* pixels = depth + row * TileWidth;
+						__m128 open0 = _mm_and_ps(covered0, _mm_cmple_ps(_mm_loadu_ps(pixels), boxDepth));
+						__m128 open1 = _mm_and_ps(covered1, _mm_cmple_ps(_mm_loadu_ps(pixels + 4), boxDepth));
+						if (_mm_movemask_ps(_mm_or_ps(open0, open1)))
+							return true;
+					}
+#else
+					for (int row = firstRow; row <= lastRow; row++)
+					{
+						for (int column = firstColumn; column <= lastColumn; column++)
+						{
+							if (depth[row * TileWidth + column] <= nearest)
+								return true;
+						}
+					}
+#endif
+				}
+			}
+			return false;
+		}
+
+		float OcclusionBuffer::DepthAt(uint32_t x, uint32_t y) const
+		{
+			return _depth[TileOffset(x / TileWidth, y / TileHeight) + (y % TileHeight) * TileWidth + x % TileWidth];
+		}
+	}
+}
@@ -0,0 +1,413 @@
+#include <ge/math/PotentiallyVisibleSet.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/core/Global.hpp>
+#include <ge/math/FrustumCullBatch.hpp>
+#include <ge/math/OcclusionBuffer.hpp>
+#include <ge/math/ShadowCull.hpp>
+#include <ge/utils/DerivedDataCache.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		namespace
+		{
+			constexpr uint32_t PvsMagic = 0x31535650; // "PVS1"
+
+			// Shorter runs of equal bytes are cheaper left in a literal
+			constexpr size_t MinRun = 3;
+
+			void WriteVarint(std::vector<uint8_t>& out, size_t value)
+			{
+				while (value >= 0x80)
+				{
+					out.push_back(static_cast<uint8_t>(value | 0x80));
+					value >>= 7;
+				}
+				out.push_back(static_cast<uint8_t>(value));
+			}
+
+			size_t ReadVarint(const uint8_t*& data, const uint8_t* end)
+			{
+				size_t value = 0;
+				for (uint32_t shift = 0; data < end && shift < 64; shift += 7)
+				{
+					uint8_t byte = *data++;
+					value |= size_t(byte & 0x7F) << shift;
+					if (!(byte & 0x80))
+						break;
+				}
+				return value;
+			}
+
+			void WriteLiterals(std::vector<uint8_t>& out, const uint8_t* bytes, size_t count)
+			{
+				if (count == 0)
+					return;
+				WriteVarint(out, count << 1 | 1);
+				out.insert(out.end(), bytes, bytes + count);
+			}
+
+			// A run of one byte value is (length << 1, value), count literal bytes are (count << 1 | 1, bytes)
+			void EncodeBytes(const uint8_t* bytes, size_t size, std::vector<uint8_t>& out)
+			{
+				size_t literals = 0;
+				size_t i = 0;
+				while (i < size)
+				{
+					size_t run = 1;
+					while (i + run < size && bytes[i + run] == bytes[i])
+						run++;
+
+					if (run < MinRun)
+					{
+						i += run;
+						continue;
+					}
+
+					WriteLiterals(out, bytes + literals, i - literals);
+					WriteVarint(out, run << 1);
+					out.push_back(bytes[i]);
+					i += run;
+					literals = i;
+				}
+				WriteLiterals(out, bytes + literals, size - literals);
+			}
+
+			// XORs the coded bytes into bytes, which start out zero for a plain set
+			void DecodeBytes(const uint8_t* data, const uint8_t* end, uint8_t* bytes, size_t size)
+			{
+				size_t written = 0;
+				while (data < end && written < size)
+				{
+					size_t header = ReadVarint(data, end);
+					size_t count = std::min(header >> 1, size - written);
+					if (header & 1)
+					{
+						count = std::min<size_t>(count, end - data);
+						for (size_t i = 0; i < count; i++)
+							bytes[written + i] ^= data[i];
+						data += std::min<size_t>(header >> 1, end - data);
+					}
+					else if (data < end)
+					{
+						uint8_t value = *data++;
+						for (size_t i = 0; value && i < count; i++)
+							bytes[written + i] ^= value;
+					}
+					written += count;
+				}
+			}
+
+			glm::vec3 SamplePoint(const glm::vec3& cellMin, float cellSize, uint32_t sample, std::mt19937& random)
+			{
+				if (sample == 0)
+					return cellMin + glm::vec3(cellSize * .5f);
+
+				// Corners pulled in slightly, so a sample never sits on a neighbour's boundary
+				if (sample <= 8)
+				{
+					uint32_t corner = sample - 1;
+					glm::vec3 offset{ corner & 1 ? .99f : .01f, corner & 2 ? .99f : .01f, corner & 4 ? .99f : .01f };
+					return cellMin + offset * cellSize;
+				}
+
+				std::uniform_real_distribution<float> unit(.01f, .99f);
+				float x = unit(random), y = unit(random), z = unit(random);
+				return cellMin + glm::vec3(x, y, z) * cellSize;
+			}
+
+			// ORs every cell's bits with those of the cells within distance along one axis
+			void DilateAxis(const std::vector<uint64_t>& in, std::vector<uint64_t>& out, const glm::uvec3& cells, size_t words, int axis, uint32_t distance)
+			{
+				out.assign(in.size(), 0);
+				size_t stride = axis == 0 ? 1 : axis == 1 ? cells.x : size_t(cells.x) * cells.y;
+				for (uint32_t z = 0; z < cells.z; z++)
+				{
+					for (uint32_t y = 0; y < cells.y; y++)
+					{
+						for (uint32_t x = 0; x < cells.x; x++)
+						{
+							glm::uvec3 position{ x, y, z };
+							size_t cell = x + cells.x * (y + size_t(cells.y) * z);
+							uint32_t first = position[axis] - std::min(position[axis], distance);
+							uint32_t last = std::min(position[axis] + distance, cells[axis] - 1);
+
+							uint64_t* bits = out.data() + cell * words;
+							for (uint32_t p = first; p <= last; p++)
+							{
+								const uint64_t* neighbour = in.data() + (cell + (size_t(p) - position[axis]) * stride) * words;
+								for (size_t w = 0; w < words; w++)
+									bits[w] |= neighbour[w];
+							}
+						}
+					}
+				}
+			}
+		}
+
+		void PotentiallyVisibleSet::Reset(const glm::vec3& origin, float cellSize, const glm::uvec3& cells, uint32_t numObjects)
+		{
+			_origin = origin;
+			_cellSize = cellSize;
+			_cells = cells;
+			_numObjects = numObjects;
+			_cellSets.assign(size_t(cells.x) * cells.y * cells.z, NoSet);
+			_setOffsets.assign(1, 0);
+			_data.clear();
+			_setsByHash.clear();
+		}
+
+		void PotentiallyVisibleSet::SetCell(uint32_t cell, const uint64_t* bits)
+		{
+			size_t words = VisibilityWords(_numObjects);
+			std::vector<uint64_t> other;
+
+			uint64_t hash = Utils::HashBytes(bits, words * sizeof(uint64_t));
+			auto range = _setsByHash.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				Decode(it->second, other);
+				if (std::equal(other.begin(), other.end(), bits))
+				{
+					_cellSets[cell] = it->second;
+					return;
+				}
+			}
+
+			// Plain, or as the difference to the set of the previous cell along an axis when that
+			// codes shorter. Only plain sets serve as a base, so decoding never chains.
+			std::vector<uint8_t> coded, delta;
+			WriteVarint(coded, 0);
+			EncodeBytes(reinterpret_cast<const uint8_t*>(bits), words * sizeof(uint64_t), coded);
+
+			size_t strides[3] = { 1, _cells.x, size_t(_cells.x) * _cells.y };
+			for (size_t stride : strides)
+			{
+				uint32_t base = cell >= stride ? SetOf(static_cast<uint32_t>(cell - stride)) : NoSet;
+				if (base == NoSet || BaseOf(base) != NoSet)
+					continue;
+
+				Decode(base, other);
+				for (size_t w = 0; w < words; w++)
+					other[w] ^= bits[w];
+
+				delta.clear();
+				WriteVarint(delta, size_t(base) + 1);
+				EncodeBytes(reinterpret_cast<const uint8_t*>(other.data()), words * sizeof(uint64_t), delta);
+				if (delta.size() < coded.size())
+					coded.swap(delta);
+			}
+
+			uint32_t set = NumSets();
+			_data.insert(_data.end(), coded.begin(), coded.end());
+			_setOffsets.push_back(static_cast<uint32_t>(_data.size()));
+			_setsByHash.emplace(hash, set);
+			_cellSets[cell] = set;
+		}
+
+		uint32_t PotentiallyVisibleSet::BaseOf(uint32_t set) const
+		{
+			const uint8_t* data = _data.data() + _setOffsets[set];
+			size_t base = ReadVarint(data, _data.data() + _setOffsets[set + 1]);
+			return base > 0 ? static_cast<uint32_t>(base - 1) : NoSet;
+		}
+
+		std::vector<char> PotentiallyVisibleSet::Serialize() const
+		{
+			Utils::DerivedDataWriter writer;
+			writer.Write(PvsMagic);
+			writer.Write(Version);
+			writer.Write(_origin);
+			writer.Write(_cellSize);
+			writer.Write(_cells);
+			writer.Write(_numObjects);
+			writer.WriteArray(_cellSets);
+			writer.WriteArray(_setOffsets);
+			writer.WriteArray(_data);
+			return writer.Data();
+		}
+
+		bool PotentiallyVisibleSet::Deserialize(const std::vector<char>& data)
+		{
+			Reset(glm::vec3(0.f), 1.f, glm::uvec3(0), 0);
+
+			Utils::DerivedDataReader reader(data);
+			uint32_t magic = 0, version = 0;
+			reader.Read(magic);
+			reader.Read(version);
+			if (magic != PvsMagic || version != Version)
+				return false;
+
+			reader.Read(_origin);
+			reader.Read(_cellSize);
+			reader.Read(_cells);
+			reader.Read(_numObjects);
+			reader.ReadArray(_cellSets);
+			reader.ReadArray(_setOffsets);
+			reader.ReadArray(_data);
+
+			bool valid = !reader.Failed() && _cellSize > 0.f && !_setOffsets.empty() && _setOffsets.back() == _data.size()
+				&& _cellSets.size() == size_t(_cells.x) * _cells.y * _cells.z
+				&& std::is_sorted(_setOffsets.begin(), _setOffsets.end());
+			for (uint32_t set : _cellSets)
+				valid = valid && (set == NoSet || set < NumSets());
+			for (uint32_t set = 0; valid && set < NumSets(); set++)
+			{
+				uint32_t base = BaseOf(set);
+				valid = base == NoSet || (base < NumSets() && BaseOf(base) == NoSet);
+			}
+
+			if (!valid)
+				Reset(glm::vec3(0.f), 1.f, glm::uvec3(0), 0);
+			return valid;
+		}
+
+		uint32_t PotentiallyVisibleSet::CellAt(const glm::vec3& position) const
+		{
+			glm::vec3 cell = glm::floor((position - _origin) / _cellSize);
+			if (cell.x < 0.f || cell.y < 0.f || cell.z < 0.f || cell.x >= float(_cells.x) || cell.y >= float(_cells.y) || cell.z >= float(_cells.z))
+				return NoCell;
+			return static_cast<uint32_t>(cell.x) + _cells.x * (static_cast<uint32_t>(cell.y) + _cells.y * static_cast<uint32_t>(cell.z));
+		}
+
+		void PotentiallyVisibleSet::Decode(uint32_t set, std::vector<uint64_t>& bits) const
+		{
+			bits.assign(VisibilityWords(_numObjects), 0);
+			if (set >= NumSets())
+				return;
+
+			uint32_t base = BaseOf(set);
+			if (base != NoSet)
+				Decode(base, bits);
+
+			const uint8_t* data = _data.data() + _setOffsets[set];
+			const uint8_t* end = _data.data() + _setOffsets[set + 1];
+			ReadVarint(data, end);
+			DecodeBytes(data, end, reinterpret_cast<uint8_t*>(bits.data()), bits.size() * sizeof(uint64_t));
+		}
+
+		glm::vec3 PotentiallyVisibleSet::CellMin(uint32_t cell) const
+		{
+			glm::uvec3 position{ cell % _cells.x, (cell / _cells.x) % _cells.y, cell / (_cells.x * _cells.y) };
+			return _origin + glm::vec3(position) * _cellSize;
+		}
+
+		PotentiallyVisibleSet BakePotentiallyVisibleSet(const AABB* objects, const Occluder* occluders, size_t count,
+			const PvsBakeSettings& settings, PvsBakeStats* stats)
+		{
+			glm::uvec3 cells = glm::max(glm::uvec3(glm::ceil((settings.max - settings.min) / settings.cellSize)), glm::uvec3(1));
+			PotentiallyVisibleSet pvs;
+			pvs.Reset(settings.min, settings.cellSize, cells, static_cast<uint32_t>(count));
+
+			// Far enough to see every object from anywhere in the volume
+			glm::vec3 sceneMin = settings.min, sceneMax = settings.min + glm::vec3(cells) * settings.cellSize;
+			for (size_t i = 0; i < count; i++)
+			{
+				sceneMin = glm::min(sceneMin, objects[i].min);
+				sceneMax = glm::max(sceneMax, objects[i].max);
+			}
+			float range = glm::length(sceneMax - sceneMin) + settings.cellSize;
+
+			// Vertically the 90 degrees of a cube face, horizontally wider, as the buffer is twice as wide
+			float aspect = float(OcclusionBuffer::Width) / float(OcclusionBuffer::Height);
+			glm::mat4 projection = glm::perspective(glm::radians(90.f), aspect, std::max(settings.cellSize * .01f, .01f), range);
+
+			uint32_t numCells = pvs.NumCells();
+			size_t words = VisibilityWords(count);
+			std::vector<uint64_t> cellBits(size_t(numCells) * words, 0);
+			std::vector<uint8_t> covered(numCells, 0);
+
+			std::atomic<uint32_t> nextCell{ 0 };
+			std::atomic<uint64_t> totalSamples{ 0 };
+			std::atomic<uint64_t> totalTriangles{ 0 };
+			// One item per thread, each claiming cells with its own buffer until none are left
+			uint32_t threads = std::max(settings.threads, 1u);
+			GlobalThreadPool().ParallelFor(threads, [&](uint32_t) {
+				OcclusionBuffer buffer;
+				std::vector<uint32_t> faceVisible[CubeFaces];
+				uint64_t samples = 0, triangles = 0;
+
+				for (uint32_t cell = nextCell++; cell < numCells; cell = nextCell++)
+				{
+					std::mt19937 random(cell);
+					uint64_t* bits = cellBits.data() + size_t(cell) * words;
+					glm::vec3 cellMin = pvs.CellMin(cell);
+
+					for (uint32_t sample = 0; sample < settings.samplesPerCell; sample++)
+					{
+						ShadowCubeCuller cube(projection, SamplePoint(cellMin, settings.cellSize, sample, random), range);
+						cube.Cull(objects, count, faceVisible);
+
+						for (uint32_t face = 0; face < CubeFaces; face++)
+						{
+							buffer.Begin(cube.GetFaceMatrix(face));
+							for (uint32_t i : faceVisible[face])
+							{
+								if (occluders[i].indexCount > 0)
+									buffer.AddOccluder(occluders[i].vertices, occluders[i].indices, occluders[i].indexCount);
+							}
+							triangles += buffer.NumTriangles();
+							buffer.Rasterize(0, OcclusionBuffer::TilesY);
+
+							for (uint32_t i : faceVisible[face])
+							{
+								if (!((bits[i / 64] >> (i % 64)) & 1) && buffer.IsBoxVisible(objects[i].min, objects[i].max))
+									bits[i / 64] |= uint64_t(1) << (i % 64);
+							}
+						}
+						samples++;
+					}
+
+					covered[cell] = std::any_of(bits, bits + words, [](uint64_t word) { return word != 0; });
+				}
+
+				totalSamples += samples;
+				totalTriangles += triangles;
+			});
+
+			if (settings.dilation > 0)
+			{
+				std::vector<uint64_t> dilated;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					DilateAxis(cellBits, dilated, cells, words, axis, settings.dilation);
+					cellBits.swap(dilated);
+				}
+			}
+
+			PvsBakeStats result;
+			result.cells = numCells;
+			result.samples = totalSamples;
+			result.triangles = totalTriangles;
+			for (uint32_t cell = 0; cell < numCells; cell++)
+			{
+				if (!covered[cell])
+				{
+					result.uncovered++;
+					continue;
+				}
+
+				const uint64_t* bits = cellBits.data() + size_t(cell) * words;
+				for (size_t w = 0; w < words; w++)
+				{
+					for (uint64_t word = bits[w]; word; word &= word - 1)
+						result.visibleBits++;
+				}
+				pvs.SetCell(cell, bits);
+			}
+
+			if (stats)
+				*stats = result;
+			return pvs;
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#include <ge/math/ScreenArea.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace GE
+{
+	namespace Math
+	{
+		float ProjectedSphereArea(const glm::vec3& center, float radius, const glm::mat4& view, float focalPixels)
+		{
+			glm::vec3 viewCenter = glm::vec3(view * glm::vec4(center, 1.f));
+			float depth = -viewCenter.z;
+			float radiusSquared = radius * radius;
+			float depthExcess = depth * depth - radiusSquared;
+			if (depth <= radius || depthExcess <= 0.f)
+				return std::numeric_limits<float>::infinity();
+
+			// pi * f^2 * sin^2(a) * cos(a) / (cos^2(t) - sin^2(a))^1.5, a the angle the sphere
+			// subtends and t the angle of its center off the view axis, multiplied through by d^3
+			float distanceSquared = glm::dot(viewCenter, viewCenter);
+			return 3.14159265f * focalPixels * focalPixels * radiusSquared * std::sqrt(distanceSquared - radiusSquared)
+				/ (depthExcess * std::sqrt(depthExcess));
+		}
+
+		float ProjectedBoxArea(const glm::vec3& min, const glm::vec3& max, const glm::mat4& view, float focalPixels)
+		{
+			return ProjectedSphereArea((min + max) * .5f, glm::length(max - min) * .5f, view, focalPixels);
+		}
+	}
+}
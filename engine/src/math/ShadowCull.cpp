@@ -0,0 +1,100 @@
+#include <ge/math/ShadowCull.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace GE
+{
+	namespace Math
+	{
+		glm::mat4 CubeFaceRotation(uint32_t face)
+		{
+			glm::mat4 view(1.f);
+			switch (face)
+			{
+			case 0: // POSITIVE_X
+				view = glm::rotate(view, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+				view = glm::rotate(view, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+				break;
+			case 1:	// NEGATIVE_X
+				view = glm::rotate(view, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+				view = glm::rotate(view, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+				break;
+			case 2:	// POSITIVE_Y
+				view = glm::rotate(view, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+				break;
+			case 3:	// NEGATIVE_Y
+				view = glm::rotate(view, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+				break;
+			case 4:	// POSITIVE_Z
+				view = glm::rotate(view, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+				break;
+			case 5:	// NEGATIVE_Z
+				view = glm::rotate(view, glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+				break;
+			}
+			return view;
+		}
+
+		uint32_t ShadowCubeCuller::Stats::Draws() const
+		{
+			uint32_t draws = 0;
+			for (uint32_t face = 0; face < CubeFaces; face++)
+				draws += faceDraws[face];
+			return draws;
+		}
+
+		ShadowCubeCuller::ShadowCubeCuller(const glm::mat4& projection, const glm::vec3& lightPosition, float range)
+			: _lightPosition(lightPosition), _range(range)
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1.f), -lightPosition);
+			for (uint32_t face = 0; face < CubeFaces; face++)
+			{
+				_faceMatrices[face] = projection * CubeFaceRotation(face) * model;
+				_faces[face] = Frustum(_faceMatrices[face]);
+			}
+		}
+
+		uint32_t ShadowCubeCuller::FaceMask(const glm::vec3& min, const glm::vec3& max) const
+		{
+			// Squared distance from the light to the nearest point of the box
+			glm::vec3 nearest = glm::clamp(_lightPosition, min, max) - _lightPosition;
+			if (glm::dot(nearest, nearest) > _range * _range)
+				return 0;
+
+			uint32_t mask = 0;
+			for (uint32_t face = 0; face < CubeFaces; face++)
+			{
+				if (_faces[face].IsBoxVisible(min, max))
+					mask |= 1u << face;
+			}
+			return mask;
+		}
+
+		void ShadowCubeCuller::Cull(const AABB* boxes, size_t count, std::vector<uint32_t> faceVisible[CubeFaces], Stats* stats) const
+		{
+			Stats result;
+			result.casters = static_cast<uint32_t>(count);
+			for (uint32_t face = 0; face < CubeFaces; face++)
+				faceVisible[face].clear();
+
+			for (size_t i = 0; i < count; i++)
+			{
+				uint32_t mask = FaceMask(boxes[i].min, boxes[i].max);
+				if (mask == 0)
+					continue;
+
+				result.inRange++;
+				for (uint32_t face = 0; face < CubeFaces; face++)
+				{
+					if (mask & (1u << face))
+						faceVisible[face].push_back(static_cast<uint32_t>(i));
+				}
+			}
+
+			for (uint32_t face = 0; face < CubeFaces; face++)
+				result.faceDraws[face] = static_cast<uint32_t>(faceVisible[face].size());
+			if (stats)
+				*stats = result;
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#include <ge/systems/ClusterCullingSystem.hpp>
+
+#include <ge/components/Common.hpp>
+#include <ge/core/Global.hpp>
+#include <ge/math/FrustumCull.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		void ClusterCullingSystem::Update(int64_t tsMicroseconds)
+		{
+			Math::Frustum frustum(_cameraData.projection * _cameraData.view);
+			Stats stats;
+
+			auto& registry = GlobalRegistry();
+			auto view = registry.view<ClusterCulling, const Visibility>();
+			view.each([&](const entt::entity entity, ClusterCulling& culling, const Visibility visibility) {
+				culling.ranges.clear();
+
+				// Coarser levels have their own index ranges, which the clusters do not cover
+				const LevelOfDetail* lod = registry.try_get<LevelOfDetail>(entity);
+				culling.active = _enabled && visibility && culling.numClusters > 0 && (!lod || lod->level == 0);
+				if (!culling.active)
+					return;
+
+				for (uint32_t i = 0; i < culling.numClusters; i++)
+					stats.objectTriangles += culling.clusters[i].indexCount / 3;
+
+				stats.clusterTriangles += Gfx::CullMeshClusters(culling.ranges, culling.clusters, culling.numClusters, frustum, _cameraData.position);
+				stats.ranges += static_cast<uint32_t>(culling.ranges.size());
+			});
+
+			_stats = stats;
+		}
+	}
+}
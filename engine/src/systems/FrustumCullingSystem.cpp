@@ -1,20 +1,415 @@
 #include <ge/systems/FrustumCullingSystem.hpp>
 
-#include <ge/components/Common.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include <ge/components/AABB.hpp>
+#include <ge/components/Dynamic.hpp>
+#include <ge/components/MinScreenArea.hpp>
+#include <ge/components/PvsObject.hpp>
 #include <ge/core/Global.hpp>
-#include <ge/math/FrustumCull.hpp>
+#include <ge/math/ScreenArea.hpp>
 
 namespace GE
 {
 	namespace Sys
 	{
+		FrustumCullingSystem::FrustumCullingSystem()
+			: GE::Sys::System("FrustumCullingSystem")
+		{
+			REGISTER_SYSTEM();
+		}
+
+		void FrustumCullingSystem::Attach()
+		{
+			auto& registry = GlobalRegistry();
+			registry.on_construct<AABB>().connect<&FrustumCullingSystem::OnBoundsCreated>(this);
+			registry.on_update<AABB>().connect<&FrustumCullingSystem::OnBoundsChanged>(this);
+			registry.on_destroy<AABB>().connect<&FrustumCullingSystem::OnBoundsDestroyed>(this);
+			registry.on_construct<Dynamic>().connect<&FrustumCullingSystem::OnDynamicCreated>(this);
+			registry.on_destroy<Dynamic>().connect<&FrustumCullingSystem::OnDynamicDestroyed>(this);
+
+			// Entities created before attaching never signalled
+			auto dynamicView = registry.view<const AABB, const Dynamic>();
+			for (const entt::entity entity : dynamicView)
+				AddDynamic(entity, dynamicView.get<const AABB>(entity));
+			auto staticView = registry.view<const AABB>(entt::exclude<Dynamic>);
+			for (const entt::entity entity : staticView)
+				AddStatic(entity, staticView.get<const AABB>(entity));
+			_resetAll = true;
+		}
+
+		void FrustumCullingSystem::Detach()
+		{
+			auto& registry = GlobalRegistry();
+			registry.on_construct<AABB>().disconnect<&FrustumCullingSystem::OnBoundsCreated>(this);
+			registry.on_update<AABB>().disconnect<&FrustumCullingSystem::OnBoundsChanged>(this);
+			registry.on_destroy<AABB>().disconnect<&FrustumCullingSystem::OnBoundsDestroyed>(this);
+			registry.on_construct<Dynamic>().disconnect<&FrustumCullingSystem::OnDynamicCreated>(this);
+			registry.on_destroy<Dynamic>().disconnect<&FrustumCullingSystem::OnDynamicDestroyed>(this);
+
+			_grid.Clear();
+			_gridHandles.clear();
+			_dynamicVisible.clear();
+			_bvh.Clear();
+			_entities.clear();
+			_statics.clear();
+			_staticBounds.clear();
+			_staticSlots.clear();
+			_removedStatics = 0;
+			_visible.clear();
+			_visibleSet.Clear();
+			_pvsSet = Math::PotentiallyVisibleSet::NoSet;
+			_staticDirty = true;
+			_refit = false;
+			_culled = false;
+		}
+
+		void FrustumCullingSystem::SetPotentiallyVisibleSet(const Math::PotentiallyVisibleSet* pvs)
+		{
+			_pvs = pvs;
+			_pvsSet = Math::PotentiallyVisibleSet::NoSet;
+			_pvsBits.clear();
+			_culled = false;
+		}
+
 		void FrustumCullingSystem::Update(int64_t tsMicroseconds)
 		{
-			Math::Frustum frustum(_cameraData.projection * _cameraData.view);
+			glm::mat4 viewProjection = _cameraData.projection * _cameraData.view;
+			_focalPixels = std::abs(_cameraData.projection[1][1]) * _screenHeight * .5f;
+			bool cameraMoved = !_culled || viewProjection != _culledViewProjection || _hierarchical != _culledHierarchical;
+			bool pvsChanged = UpdatePvs();
+			bool changed = cameraMoved || pvsChanged || _boundsVersion != _culledVersion;
+
+			_culled = true;
+			_culledHierarchical = _hierarchical;
+			_culledViewProjection = viewProjection;
+			_culledVersion = _boundsVersion;
+
+			if (_hierarchical)
+				UpdateHierarchical(viewProjection, cameraMoved);
+			else
+				UpdateLinear(viewProjection, changed);
+			_stats.reused = !changed;
+		}
+
+		void FrustumCullingSystem::UpdateLinear(const glm::mat4& viewProjection, bool changed)
+		{
+			// Leaves the hierarchy's and grid's visible lists stale
+			_resetAll = true;
 			auto view = GlobalRegistry().view<const AABB, Visibility>();
-			view.each([&](const AABB aabb, Visibility& visibility) {
-				visibility = frustum.IsBoxVisible(aabb.min, aabb.max);
-			});
+
+			if (changed)
+			{
+				// Gathered every frame, the copy is a fraction of the per box test it replaces
+				_bounds.Clear();
+				_entities.clear();
+				_pvsCulled = 0;
+				view.each([&](const entt::entity entity, const AABB aabb, Visibility& visibility) {
+					if (!InPvs(entity))
+					{
+						visibility = false;
+						_pvsCulled++;
+						return;
+					}
+
+					_bounds.Push(aabb.min, aabb.max);
+					_entities.push_back(entity);
+				});
+
+				_visibleBits.resize(Math::VisibilityWords(_entities.size()));
+				Math::CullBoxes(Math::Frustum(viewProjection), _bounds, _visibleBits.data());
+			}
+
+			Stats stats;
+			stats.entities = static_cast<uint32_t>(_entities.size()) + _pvsCulled;
+			stats.dynamic = static_cast<uint32_t>(_grid.Size());
+			stats.pvsCulled = _pvsCulled;
+			_visibleSet.Clear();
+			for (size_t i = 0; i < _entities.size(); i++)
+			{
+				Visibility& visibility = view.get<Visibility>(_entities[i]);
+				if ((_visibleBits[i / 64] >> (i % 64)) & 1)
+					Publish(_entities[i], view.get<const AABB>(_entities[i]), visibility, stats);
+				else
+					visibility = false;
+			}
+			stats.visible = static_cast<uint32_t>(_visibleSet.Size());
+			_stats = stats;
+		}
+
+		void FrustumCullingSystem::UpdateHierarchical(const glm::mat4& viewProjection, bool cameraMoved)
+		{
+			auto& registry = GlobalRegistry();
+			if (_quietFrames < QuietFramesRebuild)
+				_quietFrames++;
+			bool rebuild = WantsRebuild();
+			bool staticChanged = cameraMoved || _staticDirty || rebuild;
+			bool dynamicChanged = cameraMoved || _dynamicDirty;
+			_staticDirty = false;
+			_dynamicDirty = false;
+
+			// Only what was visible last frame needs resetting, keeping the cost off the hidden entities
+			if (_resetAll)
+			{
+				registry.view<const AABB, Visibility>().each([](const AABB&, Visibility& visibility) { visibility = false; });
+				_visible.clear();
+				_dynamicVisible.clear();
+				_resetAll = false;
+			}
+			if (staticChanged)
+			{
+				for (uint32_t slot : _visible)
+				{
+					if (_statics[slot] == entt::null)
+						continue;
+					if (Visibility* visibility = registry.try_get<Visibility>(_statics[slot]))
+						*visibility = false;
+				}
+			}
+			if (dynamicChanged)
+			{
+				for (uint32_t value : _dynamicVisible)
+				{
+					entt::entity entity = static_cast<entt::entity>(value);
+					if (!registry.valid(entity))
+						continue;
+					if (Visibility* visibility = registry.try_get<Visibility>(entity))
+						*visibility = false;
+				}
+			}
+
+			// Renumbers the slots, so after the reset above
+			if (rebuild)
+				Rebuild();
+			else if (_refit)
+			{
+				_bvh.Refit(_staticBounds.data());
+				_refit = false;
+			}
+
+			Stats stats;
+			Math::Frustum frustum;
+			if (staticChanged || dynamicChanged)
+				frustum = Math::Frustum(viewProjection);
+			if (staticChanged)
+			{
+				_visible.clear();
+				_bvh.CullCoherent(frustum, _visible, &stats.bvh);
+				for (uint32_t slot = static_cast<uint32_t>(_bvh.NumItems()); slot < _statics.size(); slot++)
+				{
+					if (_statics[slot] != entt::null && frustum.IsBoxVisible(_staticBounds[slot].min, _staticBounds[slot].max))
+						_visible.push_back(slot);
+				}
+			}
+			if (dynamicChanged)
+			{
+				_dynamicVisible.clear();
+				_grid.QueryFrustum(frustum, _dynamicVisible, &stats.grid);
+			}
+
+			// The hierarchy serves every cell, so the set filters what it returns
+			_visibleSet.Clear();
+			for (uint32_t slot : _visible)
+			{
+				entt::entity entity = _statics[slot];
+				Visibility* visibility = entity != entt::null ? registry.try_get<Visibility>(entity) : nullptr;
+				if (!visibility)
+					continue;
+				if (!InPvs(entity))
+				{
+					stats.pvsCulled++;
+					continue;
+				}
+				Publish(entity, _staticBounds[slot], *visibility, stats);
+			}
+			for (uint32_t value : _dynamicVisible)
+			{
+				entt::entity entity = static_cast<entt::entity>(value);
+				if (Visibility* visibility = registry.try_get<Visibility>(entity))
+					Publish(entity, registry.get<const AABB>(entity), *visibility, stats);
+			}
+
+			stats.entities = static_cast<uint32_t>(_staticSlots.size() + _grid.Size());
+			stats.dynamic = static_cast<uint32_t>(_grid.Size());
+			stats.pending = static_cast<uint32_t>(_statics.size() - _bvh.NumItems());
+			stats.visible = static_cast<uint32_t>(_visibleSet.Size());
+			_stats = stats;
+		}
+
+		void FrustumCullingSystem::Publish(entt::entity entity, const AABB& aabb, Visibility& visibility, Stats& stats)
+		{
+			const MinScreenArea* minArea = GlobalRegistry().try_get<const MinScreenArea>(entity);
+			float minPixels = minArea ? minArea->pixels : _minScreenArea;
+			if (minPixels > 0.f && _screenHeight && Math::ProjectedBoxArea(aabb.min, aabb.max, _cameraData.view, _focalPixels) < minPixels)
+			{
+				visibility = false;
+				stats.tooSmall++;
+				return;
+			}
+
+			visibility = true;
+			glm::vec3 toCenter = (aabb.min + aabb.max) * .5f - _cameraData.position;
+			_visibleSet.Push(entity, glm::dot(toCenter, toCenter));
+		}
+
+		bool FrustumCullingSystem::UpdatePvs()
+		{
+			uint32_t set = _pvs ? _pvs->SetOf(_pvs->CellAt(_cameraData.position)) : Math::PotentiallyVisibleSet::NoSet;
+			if (set == _pvsSet)
+				return false;
+
+			_pvsSet = set;
+			if (set != Math::PotentiallyVisibleSet::NoSet)
+				_pvs->Decode(set, _pvsBits);
+			return true;
+		}
+
+		bool FrustumCullingSystem::InPvs(entt::entity entity) const
+		{
+			if (_pvsSet == Math::PotentiallyVisibleSet::NoSet)
+				return true;
+
+			const PvsObject* object = GlobalRegistry().try_get<const PvsObject>(entity);
+			if (!object || object->index >= _pvs->NumObjects())
+				return true;
+			return (_pvsBits[object->index / 64] >> (object->index % 64)) & 1;
+		}
+
+		bool FrustumCullingSystem::WantsRebuild() const
+		{
+			size_t pending = _statics.size() - _bvh.NumItems();
+			if (pending > std::max(_bvh.NumItems(), MinPendingRebuild) || _removedStatics > _bvh.NumItems() / 2)
+				return true;
+			return (pending > 0 || _removedStatics > 0) && _quietFrames >= QuietFramesRebuild;
+		}
+
+		// Builds the pending statics in and drops the removed ones, from the bounds kept here
+		void FrustumCullingSystem::Rebuild()
+		{
+			uint32_t live = 0;
+			for (uint32_t slot = 0; slot < _statics.size(); slot++)
+			{
+				if (_statics[slot] == entt::null)
+					continue;
+				_statics[live] = _statics[slot];
+				_staticBounds[live] = _staticBounds[slot];
+				_staticSlots[_statics[live]] = live;
+				live++;
+			}
+			_statics.resize(live);
+			_staticBounds.resize(live);
+			_visible.clear();
+
+			_bvh.Build(_staticBounds.data(), _staticBounds.size());
+			_removedStatics = 0;
+			_refit = false;
+		}
+
+		void FrustumCullingSystem::OnBoundsCreated(entt::registry& registry, entt::entity entity)
+		{
+			BoundsChanged();
+			if (registry.view<const Dynamic>().contains(entity))
+				AddDynamic(entity, registry.get<const AABB>(entity));
+			else
+				AddStatic(entity, registry.get<const AABB>(entity));
+		}
+
+		void FrustumCullingSystem::OnBoundsChanged(entt::registry& registry, entt::entity entity)
+		{
+			BoundsChanged();
+			auto handle = _gridHandles.find(entity);
+			if (handle != _gridHandles.end())
+			{
+				_grid.Update(handle->second, registry.get<const AABB>(entity));
+				_dynamicDirty = true;
+				return;
+			}
+
+			auto slot = _staticSlots.find(entity);
+			if (slot != _staticSlots.end())
+			{
+				_staticBounds[slot->second] = registry.get<const AABB>(entity);
+				_refit |= slot->second < _bvh.NumItems();
+				_staticDirty = true;
+			}
+		}
+
+		void FrustumCullingSystem::OnBoundsDestroyed(entt::registry& registry, entt::entity entity)
+		{
+			BoundsChanged();
+			if (_gridHandles.count(entity))
+				RemoveDynamic(entity);
+			else
+				RemoveStatic(registry, entity);
+		}
+
+		void FrustumCullingSystem::OnDynamicCreated(entt::registry& registry, entt::entity entity)
+		{
+			// The entity leaves the hierarchy for the grid
+			if (const AABB* aabb = registry.try_get<const AABB>(entity))
+			{
+				BoundsChanged();
+				RemoveStatic(registry, entity);
+				AddDynamic(entity, *aabb);
+			}
+		}
+
+		void FrustumCullingSystem::OnDynamicDestroyed(entt::registry& registry, entt::entity entity)
+		{
+			if (_gridHandles.count(entity))
+			{
+				BoundsChanged();
+				RemoveDynamic(entity);
+				AddStatic(entity, registry.get<const AABB>(entity));
+			}
+		}
+
+		void FrustumCullingSystem::AddStatic(entt::entity entity, const AABB& bounds)
+		{
+			if (_staticSlots.count(entity))
+				return;
+
+			_staticSlots.emplace(entity, static_cast<uint32_t>(_statics.size()));
+			_statics.push_back(entity);
+			_staticBounds.push_back(bounds);
+			_staticDirty = true;
+			_quietFrames = 0;
+		}
+
+		// The slot stays until the next rebuild, only the entity is cleared from it
+		void FrustumCullingSystem::RemoveStatic(entt::registry& registry, entt::entity entity)
+		{
+			auto slot = _staticSlots.find(entity);
+			if (slot == _staticSlots.end())
+				return;
+
+			if (Visibility* visibility = registry.try_get<Visibility>(entity))
+				*visibility = false;
+
+			_statics[slot->second] = entt::null;
+			if (slot->second < _bvh.NumItems())
+				_removedStatics++;
+			_staticSlots.erase(slot);
+			_staticDirty = true;
+			_quietFrames = 0;
+		}
+
+		void FrustumCullingSystem::AddDynamic(entt::entity entity, const AABB& bounds)
+		{
+			if (!_gridHandles.count(entity))
+			{
+				_gridHandles.emplace(entity, _grid.Insert(bounds, static_cast<uint32_t>(entity)));
+				_dynamicDirty = true;
+			}
+		}
+
+		void FrustumCullingSystem::RemoveDynamic(entt::entity entity)
+		{
+			auto handle = _gridHandles.find(entity);
+			_grid.Remove(handle->second);
+			_gridHandles.erase(handle);
+			_dynamicDirty = true;
 		}
 	}
-}
\ No newline at end of file
+}
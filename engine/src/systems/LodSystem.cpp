@@ -0,0 +1,35 @@
+#include <ge/systems/LodSystem.hpp>
+
+#include <algorithm>
+
+#include <ge/components/Common.hpp>
+#include <ge/core/Global.hpp>
+#include <ge/gfx/Common.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		void LodSystem::Update(int64_t tsMicroseconds)
+		{
+			// projection[1][1] is cot(fov / 2), so this is the pixel size of one unit at distance 1
+			float focalPixels = std::abs(_cameraData.projection[1][1]) * Gfx::GetFrameHeight() * 0.5f;
+			float refine = _pixelError * (1.f + _hysteresis);
+			float coarsen = _pixelError * (1.f - _hysteresis);
+
+			auto view = GlobalRegistry().view<LevelOfDetail, const CenterOfMass>();
+			view.each([&](LevelOfDetail& lod, const CenterOfMass& centerOfMass) {
+				float distance = std::max(glm::length(centerOfMass - _cameraData.position) - lod.radius, 1e-3f);
+				float pixelsPerUnit = focalPixels / distance;
+
+				uint32_t level = std::min(lod.level, lod.numLevels - 1);
+				while (level > 0 && lod.errors[level] * pixelsPerUnit > refine)
+					level--;
+				while (level + 1 < lod.numLevels && lod.errors[level + 1] * pixelsPerUnit <= coarsen)
+					level++;
+
+				lod.level = level;
+			});
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#include <ge/systems/OcclusionCullingSystem.hpp>
+
+#include <algorithm>
+
+#include <ge/components/AABB.hpp>
+#include <ge/components/Occluder.hpp>
+#include <ge/components/Visibility.hpp>
+#include <ge/core/Common.hpp>
+#include <ge/core/Global.hpp>
+
+namespace
+{
+	// Box tests handed out at a time, enough to amortize claiming them
+	constexpr uint32_t OccludeesPerBatch = 256;
+}
+
+namespace GE
+{
+	namespace Sys
+	{
+		void OcclusionCullingSystem::Update(int64_t tsMicroseconds)
+		{
+			Stats stats;
+			if (_enabled)
+			{
+				DrawOccluders(stats);
+				TestOccludees(stats);
+			}
+			_stats = stats;
+		}
+
+		void OcclusionCullingSystem::DrawOccluders(Stats& stats)
+		{
+			int64_t begin = NowMicroseconds();
+			auto& registry = GlobalRegistry();
+
+			// Largest projected size first, the squared box diagonal over the squared distance
+			const VisibleSet& visibleSet = _cullingSys->GetVisibleSet();
+			_candidates.clear();
+			for (size_t i = 0; i < visibleSet.Size(); i++)
+			{
+				const Occluder* occluder = registry.try_get<const Occluder>(visibleSet.entities[i]);
+				if (!occluder || occluder->indexCount == 0)
+					continue;
+
+				const AABB& aabb = registry.get<const AABB>(visibleSet.entities[i]);
+				glm::vec3 diagonal = aabb.max - aabb.min;
+				_candidates.push_back({ glm::dot(diagonal, diagonal) / std::max(visibleSet.sortKeys[i], 1e-4f), visibleSet.entities[i] });
+			}
+
+			size_t numCandidates = std::min<size_t>(_candidates.size(), MaxOccluders);
+			std::partial_sort(_candidates.begin(), _candidates.begin() + numCandidates, _candidates.end(),
+				[](const Candidate& a, const Candidate& b) { return a.size > b.size; });
+
+			_buffer.Begin(_cameraData.projection * _cameraData.view);
+			uint32_t budget = 3 * MaxOccluderTriangles;
+			for (size_t i = 0; i < numCandidates; i++)
+			{
+				const Occluder& occluder = registry.get<const Occluder>(_candidates[i].entity);
+				if (occluder.indexCount > budget)
+					continue;
+
+				_buffer.AddOccluder(occluder.vertices, occluder.indices, occluder.indexCount);
+				budget -= occluder.indexCount;
+				stats.occluders++;
+			}
+			stats.triangles = static_cast<uint32_t>(_buffer.NumTriangles());
+
+			// One band of tile rows per thread, bands share no pixels
+			uint32_t bands = static_cast<uint32_t>(std::min<size_t>(Math::OcclusionBuffer::TilesY, GlobalThreadPool().Size() + 1));
+			GlobalThreadPool().ParallelFor(bands, [&](uint32_t band) {
+				_buffer.Rasterize(band * Math::OcclusionBuffer::TilesY / bands, (band + 1) * Math::OcclusionBuffer::TilesY / bands);
+			});
+			stats.rasterizeMicroseconds = NowMicroseconds() - begin;
+		}
+
+		void OcclusionCullingSystem::TestOccludees(Stats& stats)
+		{
+			int64_t begin = NowMicroseconds();
+			auto& registry = GlobalRegistry();
+
+			VisibleSet& visibleSet = _cullingSys->GetVisibleSet();
+			_occludeeBounds.clear();
+			for (entt::entity entity : visibleSet.entities)
+				_occludeeBounds.push_back(registry.get<const AABB>(entity));
+
+			uint32_t count = static_cast<uint32_t>(visibleSet.Size());
+			_occludeeVisible.resize(count);
+			GlobalThreadPool().ParallelFor((count + OccludeesPerBatch - 1) / OccludeesPerBatch, [&](uint32_t batch) {
+				uint32_t end = std::min(count, (batch + 1) * OccludeesPerBatch);
+				for (uint32_t i = batch * OccludeesPerBatch; i < end; i++)
+					_occludeeVisible[i] = _buffer.IsBoxVisible(_occludeeBounds[i].min, _occludeeBounds[i].max);
+			});
+
+			// Compacted in place, keeping the order
+			stats.tested = count;
+			uint32_t kept = 0;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (!_occludeeVisible[i])
+				{
+					registry.get<Visibility>(visibleSet.entities[i]) = false;
+					stats.occluded++;
+					continue;
+				}
+				visibleSet.entities[kept] = visibleSet.entities[i];
+				visibleSet.sortKeys[kept] = visibleSet.sortKeys[i];
+				kept++;
+			}
+			visibleSet.entities.resize(kept);
+			visibleSet.sortKeys.resize(kept);
+			stats.testMicroseconds = NowMicroseconds() - begin;
+		}
+	}
+}
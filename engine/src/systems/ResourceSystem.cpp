@@ -1,5 +1,10 @@
 #include <ge/systems/ResourceSystem.hpp>
 
+#include <algorithm>
+
+#include <ge/components/CenterOfMass.hpp>
+#include <ge/components/ResourceUsage.hpp>
+#include <ge/components/Visibility.hpp>
 #include <ge/core/Common.hpp>
 #include <ge/core/Global.hpp>
 #include <ge/events/ResourceEvents.hpp>
@@ -12,6 +17,12 @@ namespace GE
 {
 	namespace Sys
 	{
+		void Resource::Trace(ResourceStage stage, int64_t beginMicroseconds, uint64_t bytes) const
+		{
+			if (_data && _data->slot != ResourceId::InvalidIndex)
+				ResourceSystem::Get().Telemetry().Record(_data->slot, stage, beginMicroseconds, NowMicroseconds(), bytes);
+		}
+
 		ResourceSystem::ResourceSystem(const char* resourceManifest)
 			: System("ResourceSystem")
 			, _resourceManifest(resourceManifest)
@@ -21,63 +32,95 @@ namespace GE
 
 		void ResourceSystem::Update(int64_t tsMicroseconds)
 		{
+			UpdatePriorities();
+			AnnounceParts();
+
+			// Release() takes entries out of every queue under _mutex, so each is only checked
+			// under it as well
 			int loadedFromStorage = 0;
-			while (loadedFromStorage < 1 && !_loadFromDiskResources.empty())
+			while (loadedFromStorage < 1)
 			{
-				auto uuid = _loadFromDiskResources.front();
-				_resources[uuid]->LoadFromStorage();
-				_loadResources.push_back(uuid); 
+				uint32_t slot;
+				int64_t enqueuedAt;
+				{
+					LOCK(_mutex);
+					if (_loadFromDiskResources.Empty())
+						break;
+
+					auto request = _loadFromDiskResources.Pop();
+					slot = request.key;
+					enqueuedAt = request.enqueuedAt;
+					_requestTimes[slot] = enqueuedAt;
+				}
+				_telemetry.Record(slot, ResourceStage::Requested, enqueuedAt, NowMicroseconds());
+
+				_slots[slot].resource->LoadFromStorage();
 
 				LOCK(_mutex);
-				_loadFromDiskResources.pop_front();
+				_loadResources.push_back(slot); 
 				loadedFromStorage++;
 				
 				return;
 			}
 
-			while (!_loadResources.empty() && _numProcessing < 4)
+			while (_numProcessing < 4)
 			{
-				GE::Utils::UUID uuid;
+				uint32_t slot;
 				{
 					LOCK(_mutex);
-					uuid = _loadResources.front();
+					if (_loadResources.empty())
+						break;
+
+					slot = _loadResources.front();
 					_loadResources.pop_front();
 					_numProcessing++;
+
+					auto requested = _requestTimes.find(slot);
+					_partialLoads.push_back({ slot, requested != _requestTimes.end() ? requested->second : NowMicroseconds(), 0, false });
 				}
 
-				if (_resources[uuid]->LimitToMainThread()) {
-					_resources[uuid]->Load();
-					ResourceLoaded res {uuid};
-					GlobalDispatcher().trigger(res);
+				Resource* resource = _slots[slot].resource;
+				Utils::UUID uuid = _slots[slot].uuid;
+
+				if (resource->LimitToMainThread()) {
+					resource->Load();
+					if (!resource->IsCancelled())
+					{
+						ResourceLoaded res {uuid};
+						GlobalDispatcher().trigger(res);
+					}
 					{
 						LOCK(_mutex);
-						_numProcessing--;
+						FinishLoad(slot);
 					}
 					return;
 				}
 				else {
-					GlobalThreadPool().enqueue([this, uuid]() {
-						_resources[uuid]->Load();
+					GlobalThreadPool().enqueue([this, resource, slot, uuid]() {
+						resource->Load();
 
 						LOCK(_mutex);
-						_numProcessing--;
-
-						ResourceLoaded res {uuid};
-						GlobalDispatcher().trigger(res);
+						if (!resource->IsCancelled())
+						{
+							ResourceLoaded res {uuid};
+							GlobalDispatcher().trigger(res);
+						}
+						FinishLoad(slot);
 					});
 				}
 			}
 
 			int newlyFreed = 0;
-			while (newlyFreed < 6 && !_unloadResources.empty())
+			while (newlyFreed < 6)
 			{
 				LOCK(_mutex);
-				auto uuid = _unloadResources.front();
-				if (_resourceRefCounts[_unloadResources.front()] == 0)
+				if (_unloadResources.empty())
+					break;
+
+				auto slot = _unloadResources.front();
+				if (_slots[slot].refCount.load(std::memory_order_acquire) == 0 && _slots[slot].resource && _requestTimes.count(slot) == 0)
 				{
-					_resources[uuid]->Unload();
-					delete _resources[uuid];
-					_resources.erase(uuid);
+					DestroyResource(slot);
 					newlyFreed++;
 				}
 				_unloadResources.pop_front();
@@ -93,6 +136,8 @@ namespace GE
 			doc.Parse(data.data(), data.size());
 			GE_ASSERT(!doc.Error(), "Failed to parse Manifest!");
 
+			std::vector<std::pair<Utils::UUID, ResourceData>> available;
+
 			tinyxml2::XMLNode* pRoot = doc.RootElement();
 			if (pRoot != nullptr)
 			{
@@ -104,40 +149,56 @@ namespace GE
 						auto resource = category->FirstChildElement();
 						while (resource)
 						{
-							_availableResources[resource->Unsigned64Attribute("uuid")] = ResourceData(resource->Attribute("name"), resource->Attribute("path"));
-							_resourceRefCounts[resource->Unsigned64Attribute("uuid")] = 0;
+							available.emplace_back(Utils::UUID(resource->Unsigned64Attribute("uuid")), ResourceData(resource->Attribute("name"), resource->Attribute("path")));
 							resource = resource->NextSiblingElement();
 						}
 						category = category->NextSibling();
 					}
 				}
 			}
+
+			// The manifest is the full set of resources, so the slot table is sized once and never moves
+			_numSlots = static_cast<uint32_t>(available.size());
+			_slots = std::make_unique<ResourceSlot[]>(_numSlots);
+			_priorities.assign(_numSlots, 0.f);
+
+			for (uint32_t i = 0; i < _numSlots; i++)
+			{
+				_slots[i].uuid = available[i].first;
+				_slots[i].data = available[i].second;
+				_slots[i].data.slot = i;
+				_slotLookup[available[i].first] = i;
+			}
 		}
 
 		void ResourceSystem::Detach()
 		{
-			while (_numProcessing != 0); //Wait for threads to finish
+			CancelAllLoads();
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_idleCondition.wait(lock, [this]() { return _numProcessing == 0; });
 
-			LOCK(_mutex);
-			_availableResources.clear();
-			_resourceRefCounts.clear();
-			_loadFromDiskResources.clear();
-			_loadResources.clear();
 			_unloadResources.clear();
-			for (auto& resource : _resources)
+			_requestTimes.clear();
+			for (uint32_t i = 0; i < _numSlots; i++)
 			{
-				resource.second->Unload();
-				delete resource.second;
+				if (_slots[i].resource)
+					DestroyResource(i);
 			}
-			_resources.clear();
+
+			_slotLookup.clear();
+			_priorities.clear();
+			_numSlots = 0;
+			_slots.reset();
+			_draining = false;
 		}
 
 		Utils::UUID ResourceSystem::LookupResource(const std::string& path)
 		{
-			for (auto& [uuid, data] : _availableResources)
+			for (uint32_t i = 0; i < _numSlots; i++)
 			{
-				if (data.path == path) {
-					return uuid; 
+				if (_slots[i].data.path == path) {
+					return _slots[i].uuid; 
 				}
 			}
 
@@ -146,16 +207,321 @@ namespace GE
 
 		Resource* ResourceSystem::GetResource(Utils::UUID uuid)
 		{
-			auto resource = _resources[uuid];
-			return resource->_isLoaded ? resource : nullptr;
+			auto it = _slotLookup.find(uuid);
+			if (it == _slotLookup.end())
+				return nullptr;
+
+			auto resource = _slots[it->second].resource;
+			return resource && resource->_isLoaded ? resource : nullptr;
+		}
+
+		void ResourceSystem::SetPriorityCallback(PriorityCallback callback)
+		{
+			_priorityCallback = callback;
+		}
+
+		void ResourceSystem::CancelStaleLoads(float minPriority, int64_t minAgeMicroseconds)
+		{
+			LOCK(_mutex);
+			int64_t now = NowMicroseconds();
+
+			std::vector<Utils::IndexedPriorityQueue<uint32_t>::Entry> cancelled;
+			_loadFromDiskResources.RemoveIf([&](const auto& request) {
+				return request.priority < minPriority && (now - request.enqueuedAt) > minAgeMicroseconds;
+			}, cancelled);
+
+			for (auto& request : cancelled)
+			{
+				_parkedResources.push_back({ request.key, minPriority, request.enqueuedAt });
+			}
+		}
+
+		void ResourceSystem::CancelAllLoads()
+		{
+			LOCK(_mutex);
+			_draining = true;
+
+			for (auto& request : _loadFromDiskResources)
+			{
+				_unloadResources.push_back(request.key);
+			}
+			for (auto& parked : _parkedResources)
+			{
+				_unloadResources.push_back(parked.slot);
+			}
+			for (auto slot : _loadResources)
+			{
+				_unloadResources.push_back(slot);
+				_requestTimes.erase(slot);
+			}
+
+			_loadFromDiskResources.Clear();
+			_parkedResources.clear();
+			_loadResources.clear();
+
+			for (auto& [slot, requestedAt] : _requestTimes)
+			{
+				_slots[slot].resource->_cancellation.Cancel();
+			}
+		}
+
+		bool ResourceSystem::ExportTimeline(const std::string& path)
+		{
+			return _telemetry.ExportChromeTrace(path, [this](uint32_t slot) { return std::string(NameOf(slot)); });
+		}
+
+		StreamingStats ResourceSystem::GetStreamingStats()
+		{
+			LOCK(_mutex);
+			return _stats;
+		}
+
+		void ResourceSystem::UpdatePriorities()
+		{
+			// The waiting slots are copied out and their priorities computed without _mutex held,
+			// since the callback may call back into the resource system
+			std::vector<uint32_t> waiting;
+			{
+				LOCK(_mutex);
+				bool idle = _loadFromDiskResources.Empty() && _parkedResources.empty() && _requestTimes.empty() && _loadResources.empty();
+				if (idle && _visibleRequestedAt < 0 && _loadWaveStartedAt < 0)
+				{
+					_stats.pending = 0;
+					_stats.pendingVisible = 0;
+					_stats.cancelled = 0;
+					return;
+				}
+
+				for (auto& request : _loadFromDiskResources)
+					waiting.push_back(request.key);
+				for (auto& [slot, requestedAt] : _requestTimes)
+					waiting.push_back(slot);
+				for (auto& parked : _parkedResources)
+					waiting.push_back(parked.slot);
+			}
+
+			if (_priorityCallback)
+			{
+				for (auto slot : waiting)
+					_priorities[slot] = _priorityCallback(_slots[slot].uuid);
+			}
+			else
+				UpdateUsagePriorities();
+
+			// Requests queued since the copy keep the priority their slot had last
+			auto priorityOf = [this](uint32_t slot) { return _priorities[slot]; };
+
+			LOCK(_mutex);
+
+			uint32_t pendingVisible = 0;
+			_loadFromDiskResources.Reprioritize([&](const auto& request) {
+				float priority = priorityOf(request.key);
+				if (priority >= VisiblePriority)
+					pendingVisible++;
+				return priority;
+			});
+
+			for (auto& [slot, requestedAt] : _requestTimes)
+			{
+				if (priorityOf(slot) >= VisiblePriority)
+					pendingVisible++;
+			}
+
+			for (auto it = _parkedResources.begin(); it != _parkedResources.end();)
+			{
+				float priority = priorityOf(it->slot);
+				if (priority >= it->minPriority)
+				{
+					_loadFromDiskResources.Push(it->slot, priority, it->enqueuedAt);
+					it = _parkedResources.erase(it);
+				}
+				else
+					++it;
+			}
+
+			int64_t now = NowMicroseconds();
+			if (pendingVisible > 0 && _visibleRequestedAt < 0)
+			{
+				_visibleRequestedAt = now;
+			}
+			else if (pendingVisible == 0 && _visibleRequestedAt >= 0)
+			{
+				_stats.lastVisibleCompleteMicroseconds = now - _visibleRequestedAt;
+				_visibleRequestedAt = -1;
+				GE_INFO("Visible resources resident after {}ms", _stats.lastVisibleCompleteMicroseconds / 1000);
+			}
+
+			// Time every burst of loads from first request until the queues drain, split by
+			// how much came out of the derived-data cache, so warm and cold launches compare.
+			size_t pendingTotal = _loadFromDiskResources.Size() + _requestTimes.size() + _loadResources.size();
+			if (pendingTotal > 0 && _loadWaveStartedAt < 0)
+			{
+				_loadWaveStartedAt = now;
+				_loadWaveCacheStats = Utils::DerivedDataCache::Get().GetStats();
+			}
+			else if (pendingTotal == 0 && _loadWaveStartedAt >= 0)
+			{
+				auto cacheStats = Utils::DerivedDataCache::Get().GetStats();
+				uint32_t hits = cacheStats.hits - _loadWaveCacheStats.hits;
+				uint32_t misses = cacheStats.misses - _loadWaveCacheStats.misses;
+				const char* kind = misses == 0 ? "warm" : (hits == 0 ? "cold" : "partial");
+				GE_INFO("Resources loaded after {}ms ({} cache: {} hits, {} misses)", (now - _loadWaveStartedAt) / 1000, kind, hits, misses);
+				_loadWaveStartedAt = -1;
+			}
+
+			_stats.pending = static_cast<uint32_t>(_loadFromDiskResources.Size() + _requestTimes.size());
+			_stats.pendingVisible = pendingVisible;
+			_stats.cancelled = static_cast<uint32_t>(_parkedResources.size());
+		}
+
+		void ResourceSystem::UpdateUsagePriorities()
+		{
+			std::fill(_priorities.begin(), _priorities.end(), 0.f);
+
+			auto& registry = GlobalRegistry();
+			auto view = registry.view<const ResourceUsage, const CenterOfMass>();
+			view.each([&](const entt::entity entity, const ResourceUsage& usage, const CenterOfMass& centerOfMass) {
+				float priority = 1.f / (1.f + glm::length(centerOfMass - _cameraData.position));
+
+				const Visibility* visibility = registry.try_get<Visibility>(entity);
+				if (visibility && *visibility)
+					priority += VisiblePriority;
+
+				for (auto& uuid : usage.resources)
+				{
+					auto it = _slotLookup.find(uuid);
+					if (it != _slotLookup.end())
+						_priorities[it->second] = std::max(_priorities[it->second], priority);
+				}
+			});
 		}
 
-		void ResourceSystem::UnloadResource(const Utils::UUID& uuid)
+		void ResourceSystem::Release(ResourceId id)
 		{
+			// Under _mutex like AcquireResource, which could otherwise revive the slot between the
+			// last decrement and the destruction below
 			LOCK(_mutex);
-			_resourceRefCounts[uuid]--;
-			if (_resourceRefCounts[uuid] == 0 && _resources[uuid]->_isLoaded)
-				_unloadResources.push_back(uuid);
+			if (!IsAlive(id))
+				return;
+
+			ResourceSlot& slot = _slots[id.index];
+			if (slot.refCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				return;
+
+			// Not picked up by a loader yet, so nothing else can be touching it
+			if (_loadFromDiskResources.Remove(id.index))
+			{
+				DestroyResource(id.index);
+				return;
+			}
+
+			auto parked = std::find_if(_parkedResources.begin(), _parkedResources.end(), [&](const ParkedLoad& load) { return load.slot == id.index; });
+			if (parked != _parkedResources.end())
+			{
+				_parkedResources.erase(parked);
+				DestroyResource(id.index);
+				return;
+			}
+
+			// Read from storage but not handed to a loader yet
+			auto pending = std::find(_loadResources.begin(), _loadResources.end(), id.index);
+			if (pending != _loadResources.end())
+			{
+				_loadResources.erase(pending);
+				_requestTimes.erase(id.index);
+				DestroyResource(id.index);
+				return;
+			}
+
+			// A loader owns it right now; FinishLoad hands it back for destruction
+			if (_requestTimes.count(id.index) > 0)
+			{
+				slot.resource->_cancellation.Cancel();
+				return;
+			}
+
+			if (slot.resource && slot.resource->_isLoaded)
+				_unloadResources.push_back(id.index);
+		}
+
+		void ResourceSystem::FinishLoad(uint32_t index)
+		{
+			ResourceSlot& slot = _slots[index];
+
+			for (auto& partial : _partialLoads)
+			{
+				if (partial.slot == index)
+					partial.finished = true;
+			}
+
+			auto requested = _requestTimes.find(index);
+			if (requested != _requestTimes.end())
+			{
+				if (!slot.resource->IsCancelled())
+					_telemetry.Record(index, ResourceStage::Ready, requested->second, NowMicroseconds(), slot.resource->_bytesResident);
+				_requestTimes.erase(requested);
+			}
+
+			if (slot.resource->IsCancelled())
+			{
+				if (slot.refCount.load(std::memory_order_acquire) == 0 || _draining)
+				{
+					_unloadResources.push_back(index);
+				}
+				else
+				{
+					// Re-acquired while the cancelled load was winding down, so start over
+					slot.resource->_cancellation.Reset();
+					slot.resource->Unload();
+					_loadFromDiskResources.Push(index, 0.f, NowMicroseconds());
+				}
+			}
+
+			_numProcessing--;
+			_idleCondition.notify_all();
+		}
+
+		void ResourceSystem::AnnounceParts()
+		{
+			std::vector<ResourcePartLoaded> parts;
+			{
+				LOCK(_mutex);
+				for (auto it = _partialLoads.begin(); it != _partialLoads.end();)
+				{
+					// FinishLoad marks entries under this lock after Load() returned, so a finished
+					// entry announces everything in this pass before it is dropped
+					bool finished = it->finished;
+					Resource* resource = _slots[it->slot].resource;
+					bool live = resource && !resource->IsCancelled();
+					if (live)
+					{
+						uint32_t published = resource->PublishedParts();
+						if (it->announced == 0 && published > 0)
+							_telemetry.Record(it->slot, ResourceStage::FirstPart, it->requestedAt, NowMicroseconds());
+
+						for (; it->announced < published; it->announced++)
+							parts.push_back({ _slots[it->slot].uuid, it->announced });
+					}
+
+					if (finished || !live)
+						it = _partialLoads.erase(it);
+					else
+						++it;
+				}
+			}
+
+			// Outside the lock, handlers may acquire resources
+			for (auto& part : parts)
+				GlobalDispatcher().trigger(part);
+		}
+
+		void ResourceSystem::DestroyResource(uint32_t index)
+		{
+			ResourceSlot& slot = _slots[index];
+			slot.resource->Unload();
+			delete slot.resource;
+			slot.resource = nullptr;
+			slot.generation.fetch_add(1, std::memory_order_acq_rel);
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <ge/systems/ResourceTelemetry.hpp>
+
+#include <atomic>
+#include <fstream>
+
+#include <ge/utils/Log.hpp>
+#include <ge/utils/Mutex.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		namespace
+		{
+			// Small stable ids read better in trace viewers than hashed std::thread::ids
+			uint32_t CurrentThreadId()
+			{
+				static std::atomic<uint32_t> nextId{ 1 };
+				thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+				return id;
+			}
+
+			void WriteEscaped(std::ofstream& out, const std::string& text)
+			{
+				for (char c : text)
+				{
+					if (c == '"' || c == '\\')
+						out << '\\';
+					out << c;
+				}
+			}
+		}
+
+		const char* ToString(ResourceStage stage)
+		{
+			switch (stage)
+			{
+			case ResourceStage::Requested: return "Requested";
+			case ResourceStage::StorageRead: return "StorageRead";
+			case ResourceStage::Parse: return "Parse";
+			case ResourceStage::Upload: return "Upload";
+			case ResourceStage::FirstPart: return "FirstPart";
+			case ResourceStage::Ready: return "Ready";
+			default: return "Unknown";
+			}
+		}
+
+		ResourceTelemetry::ResourceTelemetry()
+		{
+			_events.resize(Capacity);
+		}
+
+		void ResourceTelemetry::Record(uint32_t slot, ResourceStage stage, int64_t beginMicroseconds, int64_t endMicroseconds, uint64_t bytes)
+		{
+			uint32_t thread = CurrentThreadId();
+
+			LOCK(_mutex);
+			_events[_next] = { slot, stage, thread, beginMicroseconds, endMicroseconds, bytes };
+			_next = (_next + 1) % Capacity;
+			_wrapped |= _next == 0;
+
+			auto& totals = _totals[static_cast<size_t>(stage)];
+			totals.count++;
+			totals.microseconds += endMicroseconds - beginMicroseconds;
+			totals.bytes += bytes;
+		}
+
+		void ResourceTelemetry::Clear()
+		{
+			LOCK(_mutex);
+			_next = 0;
+			_wrapped = false;
+			_totals = {};
+		}
+
+		std::vector<ResourceTimelineEvent> ResourceTelemetry::Snapshot() const
+		{
+			LOCK(_mutex);
+			std::vector<ResourceTimelineEvent> events;
+			if (_wrapped)
+			{
+				events.reserve(Capacity);
+				events.insert(events.end(), _events.begin() + _next, _events.end());
+			}
+			events.insert(events.end(), _events.begin(), _events.begin() + _next);
+			return events;
+		}
+
+		ResourceTelemetry::TotalsArray ResourceTelemetry::Totals() const
+		{
+			LOCK(_mutex);
+			return _totals;
+		}
+
+		bool ResourceTelemetry::ExportChromeTrace(const std::string& path, const std::function<std::string(uint32_t slot)>& nameOf) const
+		{
+			auto events = Snapshot();
+
+			std::ofstream out(path, std::ios::trunc);
+			if (!out)
+			{
+				GE_WARN("Failed to open {} for the resource timeline", path.c_str());
+				return false;
+			}
+
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				auto& event = events[i];
+				out << (i ? ",\n" : "\n") << "{\"name\":\"";
+				WriteEscaped(out, nameOf(event.slot));
+				out << "\",\"cat\":\"" << ToString(event.stage) << "\"";
+
+				bool instant = event.stage == ResourceStage::FirstPart || event.stage == ResourceStage::Ready;
+				if (instant)
+					out << ",\"ph\":\"i\",\"s\":\"t\"";
+				else
+					out << ",\"ph\":\"X\",\"dur\":" << (event.endMicroseconds - event.beginMicroseconds);
+
+				out << ",\"ts\":" << (instant ? event.endMicroseconds : event.beginMicroseconds)
+					<< ",\"pid\":1,\"tid\":" << event.thread
+					<< ",\"args\":{\"stage\":\"" << ToString(event.stage) << "\",\"bytes\":" << event.bytes << "}}";
+			}
+			out << "\n]}\n";
+
+			GE_INFO("Wrote {} resource timeline events to {}", events.size(), path.c_str());
+			return true;
+		}
+	}
+}
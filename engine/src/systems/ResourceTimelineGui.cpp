@@ -0,0 +1,147 @@
+#include <ge/systems/ResourceTimelineGui.hpp>
+
+#include <algorithm>
+#include <map>
+
+#include <imgui.h>
+
+#include <ge/systems/ResourceSystem.hpp>
+
+namespace GE
+{
+	namespace Sys
+	{
+		namespace
+		{
+			ImU32 StageColor(ResourceStage stage)
+			{
+				switch (stage)
+				{
+				case ResourceStage::Requested: return IM_COL32(110, 110, 110, 255);
+				case ResourceStage::StorageRead: return IM_COL32(70, 130, 220, 255);
+				case ResourceStage::Parse: return IM_COL32(230, 160, 40, 255);
+				case ResourceStage::Upload: return IM_COL32(200, 70, 200, 255);
+				case ResourceStage::FirstPart: return IM_COL32(40, 200, 200, 255);
+				case ResourceStage::Ready: return IM_COL32(80, 200, 80, 255);
+				default: return IM_COL32(255, 255, 255, 255);
+				}
+			}
+		}
+
+		ResourceTimelineGui::ResourceTimelineGui(const std::string& exportPath)
+			: System("ResourceTimelineGui")
+			, _exportPath(exportPath)
+		{
+		}
+
+		void ResourceTimelineGui::RenderGui()
+		{
+			auto& resourceSystem = ResourceSystem::Get();
+			auto& telemetry = resourceSystem.Telemetry();
+
+			if (ImGui::Begin("Resource Timeline"))
+			{
+				auto totals = telemetry.Totals();
+
+				if (ImGui::BeginTable("Stages", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+				{
+					ImGui::TableSetupColumn("Stage");
+					ImGui::TableSetupColumn("Count");
+					ImGui::TableSetupColumn("Total ms");
+					ImGui::TableSetupColumn("Avg ms");
+					ImGui::TableSetupColumn("MB");
+					ImGui::TableHeadersRow();
+
+					for (size_t i = 0; i < totals.size(); i++)
+					{
+						auto& stage = totals[i];
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(StageColor(static_cast<ResourceStage>(i))), "%s", ToString(static_cast<ResourceStage>(i)));
+						ImGui::TableNextColumn();
+						ImGui::Text("%u", stage.count);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.1f", stage.microseconds / 1000.0);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", stage.count ? stage.microseconds / 1000.0 / stage.count : 0.0);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", stage.bytes / (1024.0 * 1024.0));
+					}
+					ImGui::EndTable();
+				}
+
+				// FirstPart and Ready spans cover the whole request, so only the working stages compete here
+				ResourceStage dominant = ResourceStage::StorageRead;
+				for (auto stage : { ResourceStage::Parse, ResourceStage::Upload })
+				{
+					if (totals[static_cast<size_t>(stage)].microseconds > totals[static_cast<size_t>(dominant)].microseconds)
+						dominant = stage;
+				}
+
+				const char* verdict = dominant == ResourceStage::StorageRead ? "I/O" : (dominant == ResourceStage::Parse ? "parse" : "upload");
+				if (totals[static_cast<size_t>(dominant)].count > 0)
+					ImGui::Text("Loading is %s-bound", verdict);
+
+				if (ImGui::Button("Export Chrome trace"))
+					resourceSystem.ExportTimeline(_exportPath);
+				ImGui::SameLine();
+				if (ImGui::Button("Clear"))
+					telemetry.Clear();
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(120);
+				ImGui::SliderFloat("Window (s)", &_windowSeconds, 0.1f, 30.f, "%.1f");
+
+				auto events = telemetry.Snapshot();
+				if (!events.empty())
+				{
+					int64_t end = 0;
+					for (auto& event : events)
+					{
+						end = std::max(end, event.endMicroseconds);
+					}
+					int64_t begin = end - static_cast<int64_t>(_windowSeconds * 1000000.f);
+
+					std::map<uint32_t, int> rows;
+					for (auto& event : events)
+					{
+						if (event.endMicroseconds >= begin)
+							rows.emplace(event.thread, 0);
+					}
+					int row = 0;
+					for (auto& [thread, index] : rows)
+					{
+						index = row++;
+					}
+
+					const float rowHeight = 14.f;
+					ImVec2 origin = ImGui::GetCursorScreenPos();
+					float width = std::max(ImGui::GetContentRegionAvail().x, 1.f);
+					float scale = width / static_cast<float>(end - begin);
+					ImGui::InvisibleButton("Timeline", { width, rowHeight * std::max(row, 1) });
+
+					auto drawList = ImGui::GetWindowDrawList();
+					for (auto& event : events)
+					{
+						if (event.endMicroseconds < begin)
+							continue;
+
+						float y = origin.y + rows[event.thread] * rowHeight;
+						float x0 = origin.x + std::max<int64_t>(event.beginMicroseconds - begin, 0) * scale;
+						float x1 = std::max(origin.x + (event.endMicroseconds - begin) * scale, x0 + 1.f);
+						if (event.stage == ResourceStage::FirstPart || event.stage == ResourceStage::Ready)
+							x0 = x1 - 1.f;
+
+						drawList->AddRectFilled({ x0, y + 1.f }, { x1, y + rowHeight - 1.f }, StageColor(event.stage));
+
+						if (ImGui::IsMouseHoveringRect({ x0, y }, { x1, y + rowHeight }))
+						{
+							ImGui::SetTooltip("%s\n%s: %.2f ms, %.1f KB", resourceSystem.NameOf(event.slot), ToString(event.stage),
+								(event.endMicroseconds - event.beginMicroseconds) / 1000.0, event.bytes / 1024.0);
+						}
+					}
+				}
+			}
+			ImGui::End();
+		}
+	}
+}
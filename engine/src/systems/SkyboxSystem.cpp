@@ -79,8 +79,9 @@ namespace GE
 			char* dataBuffer = (char*)SKYBOX_CUBE;
 			std::vector<char> data(dataBuffer, dataBuffer + strlen(dataBuffer));
 
+			_skyboxModel.vertexFormat = Gfx::VertexFormat::Float;
 			_skyboxModel.Load(data);
-			_skyboxObject = _skyboxModel.objects.front();
+			_skyboxObject = _skyboxModel.objects.Front();
 
 			buffer.Create(_skyboxObject.vertices.size() * sizeof(glm::vec3));
 			buffer.Buffer(commandBuffers.GetBuffer(), _skyboxObject.vertices.data(), _skyboxObject.vertices.size() * sizeof(glm::vec3));
@@ -88,6 +89,9 @@ namespace GE
 			buffer2.Create(_skyboxObject.texCoords.size() * sizeof(glm::vec2));
 			buffer2.Buffer(commandBuffers.GetBuffer(), _skyboxObject.texCoords.data(), _skyboxObject.texCoords.size() * sizeof(glm::vec2));
 
+			ibo.Create(_skyboxObject.indices.size() * sizeof(uint32_t));
+			ibo.Buffer(commandBuffers.GetBuffer(), _skyboxObject.indices.data(), _skyboxObject.indices.size() * sizeof(uint32_t));
+
 			VkDescriptorImageInfo imageInfo{};
 			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			imageInfo.imageView = skyboxTexture.ImageView();
@@ -112,6 +116,7 @@ namespace GE
 
 			buffer.Destroy();
 			buffer2.Destroy();
+			ibo.Destroy();
 
 			defaultRenderPass.Destroy();
 
@@ -137,7 +142,8 @@ namespace GE
 			vkCmdPushConstants(currentBuffer, defaultRenderPass._pipeline->_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &push);
 
 			vkCmdBindDescriptorSets(currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, defaultRenderPass.Layout(), 0, 1, &descriptorPool.GetDescriptorSet(0, 0), 0, nullptr);
-			vkCmdDraw(currentBuffer, static_cast<uint32_t>(_skyboxObject.vertices.size()), 1, 0, 0);
+			ibo.Bind(currentBuffer);
+			vkCmdDrawIndexed(currentBuffer, static_cast<uint32_t>(_skyboxObject.indices.size()), 1, 0, 0, 0);
 
 			defaultRenderPass.End(currentBuffer);
 			commandBuffers.SubmitBuffer();
@@ -0,0 +1,48 @@
+#include <ge/utils/Arena.hpp>
+
+#include <algorithm>
+
+namespace GE
+{
+	namespace Utils
+	{
+		void Arena::Reserve(size_t bytes)
+		{
+			if (static_cast<size_t>(_end - _cursor) >= bytes)
+				return;
+
+			// Worst case alignment padding of a handful of arrays
+			size_t size = bytes + 64;
+			_blocks.emplace_back(new char[size]);
+			_cursor = _blocks.back().get();
+			_end = _cursor + size;
+
+			_stats.bytesReserved += size;
+			_stats.blocks++;
+		}
+
+		void* Arena::AllocateBytes(size_t bytes, size_t alignment)
+		{
+			uintptr_t address = (reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+			if (!_cursor || address + bytes > reinterpret_cast<uintptr_t>(_end))
+			{
+				// Estimate exceeded: later blocks at least double, so overflow stays logarithmic
+				Reserve(std::max({ bytes + alignment, MinBlockSize, _stats.bytesReserved }));
+				address = (reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+			}
+
+			_stats.bytesUsed += address + bytes - reinterpret_cast<uintptr_t>(_cursor);
+			_cursor = reinterpret_cast<char*>(address + bytes);
+			return reinterpret_cast<void*>(address);
+		}
+
+		void Arena::Reset()
+		{
+			_blocks.clear();
+			_blocks.shrink_to_fit();
+			_cursor = nullptr;
+			_end = nullptr;
+			_stats = {};
+		}
+	}
+}
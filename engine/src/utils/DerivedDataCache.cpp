@@ -0,0 +1,250 @@
+#include <ge/utils/DerivedDataCache.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <ge/utils/Log.hpp>
+
+namespace
+{
+	const uint32_t DDC_MAGIC = 0x43444547; // "GEDC"
+	const uint32_t DDC_FORMAT_VERSION = 1;
+	const size_t DDC_ALIGNMENT = 16;
+
+	struct DerivedDataHeader
+	{
+		uint32_t magic;
+		uint32_t formatVersion;
+		uint32_t processorVersion;
+		uint32_t reserved;
+		uint64_t sourceHash;
+		uint64_t payloadSize;
+	};
+	static_assert(sizeof(DerivedDataHeader) % DDC_ALIGNMENT == 0, "Cache header must keep the payload aligned");
+
+	const uint64_t PRIME_1 = 11400714785074694791ull;
+	const uint64_t PRIME_2 = 14029467366897019727ull;
+	const uint64_t PRIME_3 = 1609587929392839161ull;
+	const uint64_t PRIME_4 = 9650029242287828579ull;
+	const uint64_t PRIME_5 = 2870177450012600261ull;
+
+	inline uint64_t RotateLeft(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline uint64_t Read64(const uint8_t* data)
+	{
+		uint64_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t Round(uint64_t accumulator, uint64_t input)
+	{
+		accumulator += input * PRIME_2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * PRIME_1;
+	}
+
+	inline uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+	{
+		accumulator ^= Round(0, value);
+		return accumulator * PRIME_1 + PRIME_4;
+	}
+}
+
+namespace GE
+{
+	namespace Utils
+	{
+		// xxHash64: four independent lanes over 32 byte stripes, fast enough to hash source assets on every load.
+		uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+		{
+			const uint8_t* p = static_cast<const uint8_t*>(data);
+			const uint8_t* end = p + size;
+			uint64_t hash;
+
+			if (size >= 32)
+			{
+				uint64_t v1 = seed + PRIME_1 + PRIME_2;
+				uint64_t v2 = seed + PRIME_2;
+				uint64_t v3 = seed;
+				uint64_t v4 = seed - PRIME_1;
+
+				const uint8_t* limit = end - 32;
+				do
+				{
+					v1 = Round(v1, Read64(p)); p += 8;
+					v2 = Round(v2, Read64(p)); p += 8;
+					v3 = Round(v3, Read64(p)); p += 8;
+					v4 = Round(v4, Read64(p)); p += 8;
+				} while (p <= limit);
+
+				hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+				hash = MergeRound(hash, v1);
+				hash = MergeRound(hash, v2);
+				hash = MergeRound(hash, v3);
+				hash = MergeRound(hash, v4);
+			}
+			else
+			{
+				hash = seed + PRIME_5;
+			}
+
+			hash += static_cast<uint64_t>(size);
+
+			while (p + 8 <= end)
+			{
+				hash ^= Round(0, Read64(p));
+				hash = RotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+				p += 8;
+			}
+
+			if (p + 4 <= end)
+			{
+				uint32_t value;
+				memcpy(&value, p, sizeof(value));
+				hash ^= static_cast<uint64_t>(value) * PRIME_1;
+				hash = RotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+				p += 4;
+			}
+
+			while (p < end)
+			{
+				hash ^= (*p) * PRIME_5;
+				hash = RotateLeft(hash, 11) * PRIME_1;
+				p++;
+			}
+
+			hash ^= hash >> 33;
+			hash *= PRIME_2;
+			hash ^= hash >> 29;
+			hash *= PRIME_3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+
+		void DerivedDataWriter::Align()
+		{
+			_data.resize((_data.size() + DDC_ALIGNMENT - 1) & ~(DDC_ALIGNMENT - 1), 0);
+		}
+
+		void DerivedDataWriter::WriteBytes(const void* data, size_t size)
+		{
+			size_t offset = _data.size();
+			_data.resize(offset + size);
+			if (size > 0)
+				memcpy(_data.data() + offset, data, size);
+		}
+
+		void DerivedDataReader::Align()
+		{
+			Skip(((_offset + DDC_ALIGNMENT - 1) & ~(DDC_ALIGNMENT - 1)) - _offset);
+		}
+
+		bool DerivedDataReader::ReadBytes(void* data, size_t size)
+		{
+			if (_failed || size > _data.size() - _offset)
+			{
+				_failed = true;
+				return false;
+			}
+
+			memcpy(data, _data.data() + _offset, size);
+			_offset += size;
+			return true;
+		}
+
+		void DerivedDataReader::Skip(size_t size)
+		{
+			_offset += std::min(size, _data.size() - _offset);
+		}
+
+		bool DerivedDataCache::Load(const DerivedDataKey& key, std::vector<char>& payload)
+		{
+			std::ifstream file(PathFor(key).c_str(), std::ios::binary | std::ios::ate);
+			if (!file.is_open())
+			{
+				_misses++;
+				return false;
+			}
+
+			size_t fileSize = (size_t)file.tellg();
+			file.seekg(0);
+
+			DerivedDataHeader header{};
+			if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+				header.magic != DDC_MAGIC || header.formatVersion != DDC_FORMAT_VERSION ||
+				header.processorVersion != key.version || header.sourceHash != key.sourceHash ||
+				header.payloadSize != fileSize - sizeof(header))
+			{
+				_misses++;
+				return false;
+			}
+
+			payload.resize(static_cast<size_t>(header.payloadSize));
+			if (!file.read(payload.data(), header.payloadSize))
+			{
+				_misses++;
+				return false;
+			}
+
+			_hits++;
+			_bytesRead += fileSize;
+			return true;
+		}
+
+		void DerivedDataCache::Store(const DerivedDataKey& key, const std::vector<char>& payload)
+		{
+			std::string path = PathFor(key);
+
+			std::error_code error;
+			std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+			// Write under a temporary name so a concurrent reader never sees a partial file. Each
+			// writer gets its own, so two threads storing the same key never share a file.
+			std::string tempPath = path + "." + std::to_string(_nextTempFile++) + ".tmp";
+			{
+				std::ofstream file(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					GE_WARN("Failed to write derived data: {}", path);
+					return;
+				}
+
+				DerivedDataHeader header{ DDC_MAGIC, DDC_FORMAT_VERSION, key.version, 0, key.sourceHash, payload.size() };
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(payload.data(), payload.size());
+			}
+
+			std::filesystem::rename(tempPath, path, error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				return;
+			}
+
+			_bytesWritten += sizeof(DerivedDataHeader) + payload.size();
+		}
+
+		DerivedDataCache::Stats DerivedDataCache::GetStats() const
+		{
+			Stats stats;
+			stats.hits = _hits.load();
+			stats.misses = _misses.load();
+			stats.bytesRead = _bytesRead.load();
+			stats.bytesWritten = _bytesWritten.load();
+			return stats;
+		}
+
+		std::string DerivedDataCache::PathFor(const DerivedDataKey& key) const
+		{
+			char name[64];
+			snprintf(name, sizeof(name), "_%016llx_v%u.ddc", static_cast<unsigned long long>(key.sourceHash), key.version);
+			return std::string("resources/cache/") + key.processor + name;
+		}
+	}
+}
@@ -1,5 +1,8 @@
 #include <ge/utils/Threadpool.hpp>
 
+#include <algorithm>
+#include <atomic>
+
 #if defined(NN_BUILD_TARGET_PLATFORM_NX)
 #include <nn/os/os_Thread.h>
 #endif
@@ -54,11 +57,58 @@ namespace GE
 
             condition.notify_all();
             for (auto& worker : workers)
-#ifdef _WIN32
-                worker.join();
-#else   
+#if defined(NN_BUILD_TARGET_PLATFORM_NX)
                 worker.Stop();
+#else
+                worker.join();
 #endif
         }
+
+        void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& work, uint32_t maxThreads)
+        {
+            // Shared with the pool tasks, which may start after the loop has already finished.
+            // work is only called for claimed items, so it is never touched after that.
+            struct Job
+            {
+                const std::function<void(uint32_t)>* work{ nullptr };
+                uint32_t count{ 0 };
+
+                std::atomic<uint32_t> next{ 0 };
+                std::atomic<uint32_t> done{ 0 };
+                std::mutex mutex;
+                std::condition_variable finished;
+
+                void Work()
+                {
+                    for (uint32_t i = next++; i < count; i = next++)
+                    {
+                        (*work)(i);
+                        if (++done == count)
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            finished.notify_all();
+                        }
+                    }
+                }
+            };
+
+            if (count == 0)
+                return;
+
+            auto job = std::make_shared<Job>();
+            job->work = &work;
+            job->count = count;
+
+            size_t helpers = std::min<size_t>(count, workers.size() + 1) - 1;
+            if (maxThreads > 0)
+                helpers = std::min<size_t>(helpers, maxThreads - 1);
+
+            for (size_t i = 0; i < helpers; i++)
+                enqueue([job]() { job->Work(); });
+            job->Work();
+
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->finished.wait(lock, [&]() { return job->done == job->count; });
+        }
 	}
 }
\ No newline at end of file
@@ -0,0 +1,757 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <ge/core/Global.hpp>
+#include <ge/gfx/MeshBounds.hpp>
+#include <ge/gfx/MeshClusters.hpp>
+#include <ge/gfx/MeshOptimizer.hpp>
+#include <ge/gfx/ObjParser.hpp>
+#include <ge/gfx/MeshSimplifier.hpp>
+#include <ge/gfx/Model.hpp>
+#include <ge/gfx/VertexQuantization.hpp>
+#include <ge/math/FrustumCull.hpp>
+#include <ge/utils/FileLoading.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // Heap traffic of the whole process, read around a load by the memory mode
+    std::atomic<uint64_t> g_allocations{ 0 };
+    std::atomic<uint64_t> g_allocatedBytes{ 0 };
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    struct MeshTotals
+    {
+        uint64_t triangles{ 0 };
+        uint64_t vertices{ 0 };
+        uint64_t transformed{ 0 };
+        uint64_t bytesFetched{ 0 };
+        uint64_t bytesReferenced{ 0 };
+    };
+
+    bool LoadModel(const std::string& path, GE::Gfx::Model& model)
+    {
+        if (!GE::Utils::FileExist(path.c_str()))
+        {
+            printf("File not found: %s\n", path.c_str());
+            return false;
+        }
+
+        // Material ids only survive parsing when the sibling .mtl is found
+        std::string mtlPath = path.substr(0, path.find_last_of('.')) + ".mtl";
+        if (GE::Utils::FileExist(mtlPath.c_str()))
+        {
+            model._mtlPath = mtlPath;
+            model._mtl_data = GE::Utils::LoadFile(mtlPath.c_str());
+        }
+
+        auto data = GE::Utils::LoadFile(path.c_str());
+        model.Load(data);
+        return model._isLoaded;
+    }
+
+    template<typename Objects>
+    MeshTotals Analyze(const Objects& objects, uint32_t cacheSize)
+    {
+        MeshTotals totals;
+        for (auto& object : objects)
+        {
+            auto cache = GE::Gfx::AnalyzeVertexCache(object.indices.data(), object.indices.size(), object.vertices.size(), cacheSize);
+            auto fetch = GE::Gfx::AnalyzeVertexFetch(object.indices.data(), object.indices.size(), object.vertices.size(), sizeof(glm::vec3));
+
+            totals.triangles += object.indices.size() / 3;
+            totals.vertices += object.vertices.size();
+            totals.transformed += cache.verticesTransformed;
+            totals.bytesFetched += fetch.bytesFetched;
+            totals.bytesReferenced += object.vertices.size() * sizeof(glm::vec3);
+        }
+        return totals;
+    }
+
+    void PrintRow(const char* stage, const MeshTotals& totals)
+    {
+        printf("%-14s %10llu %10llu %8.3f %8.3f %10.3f\n", stage,
+            (unsigned long long)totals.triangles, (unsigned long long)totals.vertices,
+            totals.triangles ? double(totals.transformed) / totals.triangles : 0.0,
+            totals.vertices ? double(totals.transformed) / totals.vertices : 0.0,
+            totals.bytesReferenced ? double(totals.bytesFetched) / totals.bytesReferenced : 0.0);
+    }
+
+    // Loads the model unoptimized, then applies each optimizer stage in turn and reports
+    // ACMR/ATVR (FIFO cache of cacheSize entries) and position stream overfetch.
+    int RunOptimize(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer optimize <model.obj> [cacheSize]\n");
+            return -1;
+        }
+
+        uint32_t cacheSize = args.size() > 1 ? static_cast<uint32_t>(std::stoul(args[1])) : 32;
+
+        GE::Gfx::Model model;
+        model.optimizerSettings = { false, false, false, false };
+        model.lodSettings.maxLevels = 1;
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        printf("%-14s %10s %10s %8s %8s %10s\n", "stage", "triangles", "vertices", "ACMR", "ATVR", "overfetch");
+        PrintRow("file order", Analyze(model.objects, cacheSize));
+
+        // Objects are views into the model arena, so each stage works on its own copies
+        struct WorkingMesh
+        {
+            std::vector<glm::vec3> vertices;
+            std::vector<uint32_t> indices;
+        };
+
+        std::vector<WorkingMesh> objects;
+        for (auto& object : model.objects)
+            objects.push_back({ { object.vertices.begin(), object.vertices.end() }, { object.indices.begin(), object.indices.end() } });
+
+        for (auto& object : objects)
+            GE::Gfx::OptimizeVertexCache(object.indices.data(), object.indices.data(), object.indices.size(), object.vertices.size());
+        PrintRow("vertex cache", Analyze(objects, cacheSize));
+
+        auto overdraw = objects;
+        for (auto& object : overdraw)
+            GE::Gfx::OptimizeOverdraw(object.indices.data(), object.indices.data(), object.indices.size(), object.vertices.data(), object.vertices.size());
+        PrintRow("+ overdraw", Analyze(overdraw, cacheSize));
+
+        for (auto& object : objects)
+        {
+            std::vector<uint32_t> remap(object.vertices.size());
+            size_t unique = GE::Gfx::OptimizeVertexFetchRemap(remap.data(), object.indices.data(), object.indices.size(), object.vertices.size());
+            GE::Gfx::RemapIndexBuffer(object.indices.data(), object.indices.data(), object.indices.size(), remap.data());
+
+            std::vector<glm::vec3> vertices(unique);
+            GE::Gfx::RemapVertexBuffer(vertices.data(), object.vertices.data(), object.vertices.size(), remap.data());
+            object.vertices.swap(vertices);
+        }
+        PrintRow("+ fetch", Analyze(objects, cacheSize));
+
+        return 0;
+    }
+
+    // Builds the LOD chain with the default settings and reports triangles per level next to
+    // the simplifier's error estimate. The error budget itself is checked by MeshTests.
+    int RunLod(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer lod <model.obj>\n");
+            return -1;
+        }
+
+        GE::Gfx::Model model;
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        uint32_t maxLevels = std::min(model.lodSettings.maxLevels, GE::Gfx::LodSettings::MaxLevels);
+        uint64_t triangles[GE::Gfx::LodSettings::MaxLevels] = {};
+        float estimated[GE::Gfx::LodSettings::MaxLevels] = {};
+
+        for (auto& object : model.objects)
+        {
+            for (uint32_t level = 0; level < maxLevels; level++)
+            {
+                auto& lod = object.lods[std::min<size_t>(level, object.lods.size() - 1)];
+                triangles[level] += lod.indexCount / 3;
+                estimated[level] = std::max(estimated[level], lod.error);
+            }
+        }
+
+        printf("%-6s %12s %8s %12s\n", "level", "triangles", "ratio", "est. error");
+        for (uint32_t level = 0; level < maxLevels; level++)
+        {
+            printf("LOD%-3u %12llu %7.1f%% %12.5f\n", level, (unsigned long long)triangles[level],
+                100.0 * triangles[level] / std::max<uint64_t>(triangles[0], 1), estimated[level]);
+        }
+
+        return 0;
+    }
+
+    // Renders the model from random viewpoints inside its bounds and compares the triangles
+    // submitted with per object frustum culling against per cluster frustum and cone culling.
+    // Also checks that no cone rejected cluster contains a triangle facing the camera.
+    int RunClusters(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer clusters <model.obj> [views]\n");
+            return -1;
+        }
+
+        uint32_t numViews = args.size() > 1 ? static_cast<uint32_t>(std::stoul(args[1])) : 256;
+
+        GE::Gfx::Model model;
+        model.lodSettings.maxLevels = 1;
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        struct Bounds
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+        };
+
+        std::vector<Bounds> bounds;
+        glm::vec3 sceneMin{ INFINITY };
+        glm::vec3 sceneMax{ -INFINITY };
+        uint64_t numClusters = 0;
+        uint64_t numTriangles = 0;
+        for (auto& object : model.objects)
+        {
+            Bounds b{ glm::vec3{ INFINITY }, glm::vec3{ -INFINITY } };
+            for (auto& v : object.vertices)
+            {
+                b.min = glm::min(b.min, v);
+                b.max = glm::max(b.max, v);
+            }
+            bounds.push_back(b);
+            sceneMin = glm::min(sceneMin, b.min);
+            sceneMax = glm::max(sceneMax, b.max);
+            numClusters += object.clusters.size();
+            numTriangles += object.lods[0].indexCount / 3;
+        }
+
+        glm::mat4 projection = glm::perspective(45.f, 16.f / 9.f, .1f, 10000.f);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        uint64_t objectTriangles = 0;
+        uint64_t clusterTriangles = 0;
+        uint64_t objectDraws = 0;
+        uint64_t clusterDraws = 0;
+        uint64_t violations = 0;
+        double objectMicroseconds = 0.0;
+        double clusterMicroseconds = 0.0;
+        std::vector<GE::Gfx::IndexRange> ranges;
+        std::vector<bool> objectVisible(model.objects.Size());
+
+        for (uint32_t i = 0; i < numViews; i++)
+        {
+            glm::vec3 eye = sceneMin + (sceneMax - sceneMin) * glm::vec3{ unit(rng), unit(rng), unit(rng) };
+            float yaw = unit(rng) * 6.2831853f;
+            float pitch = (unit(rng) - 0.5f) * 1.5f;
+            glm::vec3 forward{ std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch) };
+            GE::Math::Frustum frustum(projection * glm::lookAt(eye, eye + forward, glm::vec3{ 0.f, 1.f, 0.f }));
+
+            auto begin = std::chrono::high_resolution_clock::now();
+            for (size_t o = 0; o < model.objects.Size(); o++)
+            {
+                objectVisible[o] = frustum.IsBoxVisible(bounds[o].min, bounds[o].max);
+                if (objectVisible[o])
+                {
+                    objectTriangles += model.objects[o].lods[0].indexCount / 3;
+                    objectDraws++;
+                }
+            }
+            auto middle = std::chrono::high_resolution_clock::now();
+            for (size_t o = 0; o < model.objects.Size(); o++)
+            {
+                if (!objectVisible[o])
+                    continue;
+
+                auto& clusters = model.objects[o].clusters;
+                ranges.clear();
+                clusterTriangles += GE::Gfx::CullMeshClusters(ranges, clusters.data(), clusters.size(), frustum, eye);
+                clusterDraws += ranges.size();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            objectMicroseconds += std::chrono::duration<double, std::micro>(middle - begin).count();
+            clusterMicroseconds += std::chrono::duration<double, std::micro>(end - middle).count();
+
+            for (size_t o = 0; o < model.objects.Size(); o++)
+            {
+                auto& object = model.objects[o];
+                for (auto& cluster : object.clusters)
+                {
+                    glm::vec3 toCluster = cluster.center - eye;
+                    if (glm::dot(toCluster, cluster.coneAxis) < cluster.coneCutoff * glm::length(toCluster) + cluster.radius)
+                        continue;
+
+                    for (uint32_t t = 0; t < cluster.indexCount; t += 3)
+                    {
+                        const uint32_t* tri = object.indices.data() + cluster.firstIndex + t;
+                        const glm::vec3& a = object.vertices[tri[0]];
+                        glm::vec3 normal = glm::cross(object.vertices[tri[1]] - a, object.vertices[tri[2]] - a);
+                        if (glm::dot(normal, eye - a) > 0.f)
+                            violations++;
+                    }
+                }
+            }
+        }
+
+        printf("%llu triangles, %llu clusters (%.1f triangles per cluster), %u views\n",
+            (unsigned long long)numTriangles, (unsigned long long)numClusters, double(numTriangles) / std::max<uint64_t>(numClusters, 1), numViews);
+        printf("%-16s %14s %12s %12s\n", "culling", "triangles/view", "draws/view", "us/view");
+        printf("%-16s %14.0f %12.1f %12.2f\n", "object", double(objectTriangles) / numViews, double(objectDraws) / numViews, objectMicroseconds / numViews);
+        printf("%-16s %14.0f %12.1f %12.2f\n", "+ cluster", double(clusterTriangles) / numViews, double(clusterDraws) / numViews, clusterMicroseconds / numViews);
+        printf("clusters reject %.1f%% of the triangles passing object culling\n",
+            objectTriangles ? 100.0 * (objectTriangles - clusterTriangles) / objectTriangles : 0.0);
+        printf("%llu front facing triangles in cone rejected clusters\n", (unsigned long long)violations);
+
+        return violations == 0 ? 0 : 1;
+    }
+
+    // Quantizes every object of a float loaded model and reports the stream sizes before and
+    // after together with the largest round trip error of each attribute.
+    int RunQuantize(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer quantize <model.obj>\n");
+            return -1;
+        }
+
+        GE::Gfx::Model model;
+        model.vertexFormat = GE::Gfx::VertexFormat::Float;
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        constexpr uint64_t floatSize = sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3);
+        constexpr uint64_t quantizedSize = sizeof(GE::Gfx::QuantizedPosition) + sizeof(GE::Gfx::QuantizedTexCoord)
+            + sizeof(GE::Gfx::QuantizedNormal);
+
+        uint64_t numVertices = 0;
+        GE::Gfx::QuantizationError worst;
+        float worstRelative = 0.f;
+        for (auto& object : model.objects)
+        {
+            GE::Gfx::QuantizedVertexStreams streams;
+            GE::Gfx::QuantizeVertices(streams, object.vertices.data(), object.texCoords.data(), object.normals.data(), object.vertices.size());
+
+            auto error = GE::Gfx::MeasureQuantizationError(streams, object.vertices.data(), object.texCoords.data(),
+                object.normals.data(), object.vertices.size());
+
+            float extent = std::max(streams.positionScale.x, std::max(streams.positionScale.y, streams.positionScale.z));
+            worst.position = std::max(worst.position, error.position);
+            worst.normal = std::max(worst.normal, error.normal);
+            worst.texCoord = std::max(worst.texCoord, error.texCoord);
+            if (extent > 0.f)
+                worstRelative = std::max(worstRelative, error.position / extent);
+
+            numVertices += object.vertices.size();
+        }
+
+        printf("%llu vertices in %zu objects\n", (unsigned long long)numVertices, model.objects.Size());
+        printf("%-10s %8s %12s\n", "format", "bytes", "total MB");
+        printf("%-10s %8llu %12.2f\n", "float", (unsigned long long)floatSize, numVertices * floatSize / (1024.0 * 1024.0));
+        printf("%-10s %8llu %12.2f\n", "quantized", (unsigned long long)quantizedSize, numVertices * quantizedSize / (1024.0 * 1024.0));
+        printf("reduction %.2fx\n", double(floatSize) / quantizedSize);
+        printf("max position error %.6f (%.6f%% of object extent)\n", worst.position, 100.f * worstRelative);
+        printf("max normal error %.4f degrees\n", worst.normal);
+        printf("max uv error %.6f\n", worst.texCoord);
+
+        return 0;
+    }
+
+    // Checks that every LOD level is covered by submeshes in ascending material order and that
+    // clusters stay inside one submesh, then compares the material switches of drawing objects
+    // in turn against drawing material batches.
+    int RunMaterials(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer materials <model.obj>\n");
+            return -1;
+        }
+
+        GE::Gfx::Model model;
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        uint64_t errors = 0;
+        uint64_t objectDraws = 0;
+        uint64_t submeshDraws = 0;
+        uint64_t unbatchedSwitches = 0;
+        std::vector<bool> used(model.materials.size() + 1, false);
+        uint32_t previousMaterial = ~0u;
+
+        for (auto& object : model.objects)
+        {
+            for (size_t level = 0; level < object.lods.size(); level++)
+            {
+                auto& lod = object.lods[level];
+                uint32_t next = lod.firstIndex;
+                for (uint32_t s = 0; s < lod.numSubmeshes; s++)
+                {
+                    auto& submesh = object.submeshes[lod.firstSubmesh + s];
+                    // NoMaterial sorts first, so compare with it wrapped around to 0
+                    bool ascending = s == 0 || object.submeshes[lod.firstSubmesh + s - 1].material + 1 < submesh.material + 1;
+                    if (submesh.firstIndex != next || submesh.indexCount == 0 || submesh.indexCount % 3 || !ascending)
+                        errors++;
+                    next = submesh.firstIndex + submesh.indexCount;
+
+                    if (level == 0)
+                    {
+                        if (submesh.material != previousMaterial)
+                            unbatchedSwitches++;
+                        previousMaterial = submesh.material;
+                        used[std::min<size_t>(submesh.material, used.size() - 1)] = true;
+                        submeshDraws++;
+                    }
+                }
+                if (next != lod.firstIndex + lod.indexCount)
+                    errors++;
+            }
+
+            for (auto& cluster : object.clusters)
+            {
+                auto& lod = object.lods.front();
+                bool inside = false;
+                for (uint32_t s = 0; s < lod.numSubmeshes && !inside; s++)
+                {
+                    auto& submesh = object.submeshes[lod.firstSubmesh + s];
+                    inside = cluster.firstIndex >= submesh.firstIndex && cluster.firstIndex + cluster.indexCount <= submesh.firstIndex + submesh.indexCount;
+                }
+                if (!inside)
+                    errors++;
+            }
+
+            objectDraws++;
+        }
+
+        uint64_t batchedSwitches = std::count(used.begin(), used.end(), true);
+        printf("%zu materials, %llu objects -> %llu submesh draws at LOD0\n", model.materials.size(),
+            (unsigned long long)objectDraws, (unsigned long long)submeshDraws);
+        printf("material switches: %llu drawing objects in turn, %llu batched by material\n",
+            (unsigned long long)unbatchedSwitches, (unsigned long long)batchedSwitches);
+        printf("%llu submesh layout errors\n", (unsigned long long)errors);
+
+        return errors == 0 ? 0 : 1;
+    }
+
+    // Compares the load time bounds of every object against a scalar reference and times both
+    int RunBounds(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer bounds <model.obj>\n");
+            return -1;
+        }
+
+        GE::Gfx::Model model;
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        uint64_t numVertices = 0;
+        uint64_t failures = 0;
+        double boundsMicroseconds = 0.0;
+        double scalarMicroseconds = 0.0;
+        for (auto& object : model.objects)
+        {
+            if (object.vertices.empty())
+                continue;
+
+            auto begin = std::chrono::high_resolution_clock::now();
+            GE::Gfx::MeshBounds bounds = GE::Gfx::ComputeMeshBounds(object.vertices.data(), object.vertices.size());
+            auto middle = std::chrono::high_resolution_clock::now();
+
+            glm::vec3 min = object.vertices.front();
+            glm::vec3 max = min;
+            glm::vec3 sum{ 0.f };
+            for (auto& v : object.vertices)
+            {
+                min = glm::min(min, v);
+                max = glm::max(max, v);
+                sum += v;
+            }
+            glm::vec3 center = sum / static_cast<float>(object.vertices.size());
+            float radius = 0.f;
+            for (auto& v : object.vertices)
+                radius = std::max(radius, glm::length(v - center));
+            auto end = std::chrono::high_resolution_clock::now();
+
+            boundsMicroseconds += std::chrono::duration<double, std::micro>(middle - begin).count();
+            scalarMicroseconds += std::chrono::duration<double, std::micro>(end - middle).count();
+            numVertices += object.vertices.size();
+
+            // The extremes are exact, the mean only differs by summation order
+            float tolerance = 1e-4f * std::max(glm::length(max - min), 1.f);
+            bool contained = true;
+            for (auto& v : object.vertices)
+                contained = contained && glm::length(v - bounds.centerOfMass) <= bounds.radius * 1.0001f + 1e-6f;
+
+            if (bounds.aabb.min != min || bounds.aabb.max != max || glm::length(bounds.centerOfMass - center) > tolerance
+                || std::abs(bounds.radius - radius) > tolerance || !contained
+                || bounds.aabb.min != object.bounds.aabb.min || bounds.aabb.max != object.bounds.aabb.max || bounds.radius != object.bounds.radius)
+                failures++;
+        }
+
+        printf("%zu objects, %llu vertices\n", model.objects.Size(), (unsigned long long)numVertices);
+        printf("ComputeMeshBounds %10.1f us\nscalar reference  %10.1f us\n", boundsMicroseconds, scalarMicroseconds);
+        printf("%llu objects with bounds differing from the reference or the loaded model\n", (unsigned long long)failures);
+
+        return failures == 0 ? 0 : 1;
+    }
+
+    template<typename T>
+    bool SameArray(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    // Field by field comparison of everything Model reads from the parse, floats bit for bit
+    int CompareParses(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, const std::vector<tinyobj::material_t>& materials,
+        const tinyobj::attrib_t& expectedAttrib, const std::vector<tinyobj::shape_t>& expectedShapes, const std::vector<tinyobj::material_t>& expectedMaterials)
+    {
+        int differences = 0;
+        auto check = [&](bool same, const char* what, size_t shape) {
+            if (!same && differences++ < 16)
+                printf("  mismatch: %s (shape %zu)\n", what, shape);
+        };
+
+        check(SameArray(attrib.vertices, expectedAttrib.vertices), "vertices", 0);
+        check(SameArray(attrib.normals, expectedAttrib.normals), "normals", 0);
+        check(SameArray(attrib.texcoords, expectedAttrib.texcoords), "texcoords", 0);
+        check(shapes.size() == expectedShapes.size(), "shape count", shapes.size());
+        check(materials.size() == expectedMaterials.size(), "material count", 0);
+
+        for (size_t i = 0; i < std::min(shapes.size(), expectedShapes.size()); i++)
+        {
+            auto& mesh = shapes[i].mesh;
+            auto& expected = expectedShapes[i].mesh;
+            check(shapes[i].name == expectedShapes[i].name, "name", i);
+            check(mesh.indices.size() == expected.indices.size(), "index count", i);
+            for (size_t j = 0; j < std::min(mesh.indices.size(), expected.indices.size()); j++)
+            {
+                auto& a = mesh.indices[j];
+                auto& b = expected.indices[j];
+                if (a.vertex_index != b.vertex_index || a.normal_index != b.normal_index || a.texcoord_index != b.texcoord_index)
+                {
+                    check(false, "indices", i);
+                    break;
+                }
+            }
+            check(mesh.num_face_vertices == expected.num_face_vertices, "face sizes", i);
+            check(mesh.material_ids == expected.material_ids, "material ids", i);
+            check(mesh.smoothing_group_ids == expected.smoothing_group_ids, "smoothing groups", i);
+        }
+
+        for (size_t i = 0; i < std::min(materials.size(), expectedMaterials.size()); i++)
+            check(materials[i].name == expectedMaterials[i].name, "material name", i);
+
+        return differences;
+    }
+
+    uint64_t PeakResidentBytes()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+    }
+
+    // Loads the model once and reports the heap allocations it made, the process peak resident
+    // size and how much of the arena reserved up front the objects actually used
+    int RunMemory(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer memory <model.obj>\n");
+            return -1;
+        }
+
+        GE::Gfx::Model model;
+        uint64_t peakBefore = PeakResidentBytes();
+        uint64_t allocations = g_allocations.load();
+        uint64_t allocatedBytes = g_allocatedBytes.load();
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        if (!LoadModel(args[0], model))
+            return -1;
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+        allocations = g_allocations.load() - allocations;
+        allocatedBytes = g_allocatedBytes.load() - allocatedBytes;
+        uint64_t peakAfter = PeakResidentBytes();
+
+        constexpr double MB = 1024.0 * 1024.0;
+        GE::Utils::Arena::Stats arena = model._arena.GetStats();
+        printf("%zu objects loaded in %.1f ms\n", model.objects.Size(), ms);
+        printf("heap: %llu allocations, %.2f MB allocated\n", (unsigned long long)allocations, allocatedBytes / MB);
+        printf("peak resident: %.2f MB before load, %.2f MB after\n", peakBefore / MB, peakAfter / MB);
+        printf("arena: %.2f MB used of %.2f MB reserved (%.0f%%) in %u blocks\n", arena.bytesUsed / MB, arena.bytesReserved / MB,
+            arena.bytesReserved ? 100.0 * arena.bytesUsed / arena.bytesReserved : 0.0, arena.blocks);
+        return 0;
+    }
+
+    // Parses with tinyobj and with ParseObj at increasing thread counts, checking that every
+    // run produces exactly tinyobj's output and reporting throughput.
+    int RunParse(const std::vector<std::string>& args)
+    {
+        if (args.empty())
+        {
+            printf("usage: MeshAnalyzer parse <model.obj>\n");
+            return -1;
+        }
+
+        if (!GE::Utils::FileExist(args[0].c_str()))
+        {
+            printf("File not found: %s\n", args[0].c_str());
+            return -1;
+        }
+
+        auto data = GE::Utils::LoadFile(args[0].c_str());
+        std::string mtlPath = args[0].substr(0, args[0].find_last_of('.')) + ".mtl";
+        std::string mtl;
+        if (GE::Utils::FileExist(mtlPath.c_str()))
+        {
+            auto mtlData = GE::Utils::LoadFile(mtlPath.c_str());
+            mtl.assign(mtlData.begin(), mtlData.end());
+        }
+
+        double megabytes = data.size() / (1024.0 * 1024.0);
+        auto elapsedMs = [](std::chrono::high_resolution_clock::time_point begin) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+        };
+
+        tinyobj::attrib_t expectedAttrib;
+        std::vector<tinyobj::shape_t> expectedShapes;
+        std::vector<tinyobj::material_t> expectedMaterials;
+        {
+            std::string warn, err;
+            std::istringstream objStream(std::string(data.begin(), data.end()));
+            std::istringstream mtlStream(mtl);
+            tinyobj::MaterialStreamReader mtlReader(mtlStream);
+
+            auto begin = std::chrono::high_resolution_clock::now();
+            bool result = tinyobj::LoadObj(&expectedAttrib, &expectedShapes, &expectedMaterials, &warn, &err, &objStream, mtl.empty() ? nullptr : &mtlReader);
+            double ms = elapsedMs(begin);
+            if (!result)
+            {
+                printf("tinyobj failed: %s\n", err.c_str());
+                return -1;
+            }
+            printf("%-12s %10.1f ms %10.1f MB/s\n", "tinyobj", ms, megabytes / (ms / 1000.0));
+        }
+
+        int failures = 0;
+        uint32_t maxThreads = static_cast<uint32_t>(GE::GlobalThreadPool().Size() + 1);
+        for (uint32_t threads = 1;; threads = std::min(threads * 2, maxThreads))
+        {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn;
+            std::istringstream mtlStream(mtl);
+
+            auto begin = std::chrono::high_resolution_clock::now();
+            bool result = GE::Gfx::ParseObj(data.data(), data.size(), mtl.empty() ? nullptr : &mtlStream, attrib, shapes, materials, warn, threads);
+            double ms = elapsedMs(begin);
+            if (!result)
+            {
+                printf("ParseObj hands this file to tinyobj (lines, points or malformed faces)\n");
+                return 0;
+            }
+
+            char label[32];
+            snprintf(label, sizeof(label), "%u threads", threads);
+            printf("%-12s %10.1f ms %10.1f MB/s\n", label, ms, megabytes / (ms / 1000.0));
+
+            failures += CompareParses(attrib, shapes, materials, expectedAttrib, expectedShapes, expectedMaterials);
+            if (threads == maxThreads)
+                break;
+        }
+
+        printf("%s\n", failures == 0 ? "output identical to tinyobj" : "output differs from tinyobj");
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        args.push_back(argv[i]);
+    }
+
+    if (args.empty())
+    {
+        printf("usage: MeshAnalyzer <mode> [args]\n");
+        printf("modes:\n");
+        printf("  optimize <model.obj> [cacheSize]   vertex cache / fetch statistics per optimizer stage\n");
+        printf("  lod <model.obj>                    LOD chain triangle counts and error estimates\n");
+        printf("  clusters <model.obj> [views]       cluster culling against object culling over random views\n");
+        printf("  quantize <model.obj>               compact vertex stream sizes and quantization error\n");
+        printf("  bounds <model.obj>                 load time bounds against a scalar reference\n");
+        printf("  materials <model.obj>              submesh layout checks and material switches per frame\n");
+        printf("  parse <model.obj>                  parallel OBJ parser throughput and equality with tinyobj\n");
+        printf("  memory <model.obj>                 heap allocations, peak resident size and arena use of a load\n");
+        return -1;
+    }
+
+    std::string mode = args.front();
+    args.erase(args.begin());
+
+    if (mode == "optimize")
+        return RunOptimize(args);
+    if (mode == "lod")
+        return RunLod(args);
+    if (mode == "clusters")
+        return RunClusters(args);
+    if (mode == "quantize")
+        return RunQuantize(args);
+    if (mode == "bounds")
+        return RunBounds(args);
+    if (mode == "materials")
+        return RunMaterials(args);
+    if (mode == "parse")
+        return RunParse(args);
+    if (mode == "memory")
+        return RunMemory(args);
+
+    printf("Unknown mode: %s\n", mode.c_str());
+    return -1;
+}
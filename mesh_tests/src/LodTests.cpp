@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ge/gfx/MeshSimplifier.hpp>
+#include <ge/gfx/Model.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    // Allowed ratio between the measured distance of a level and the error the chain reports
+    // for it, which itself must stay within the level budget.
+    //
+    // SimplifyMesh stops before a collapse whose quadric error exceeds maxError * extent. That
+    // error is the area weighted RMS distance from the kept vertex to the planes merged into it,
+    // not the largest distance from a removed vertex to the new triangles, so it is no strict
+    // bound on what MeasureSimplificationError reports. On meshes of evenly sized triangles it
+    // still holds with a factor of 2:
+    // - Interior collapses on a flat or smooth surface keep the kept vertex within the RMS
+    //   distance of every ring plane, because the planes of one ring are (nearly) the same.
+    // - A border vertex only slides along one of its open edges. The border planes of both edges
+    //   carry BorderWeight times the squared edge length, against at most one squared edge of
+    //   face area, so for equal edges the outline moves at most sqrt(21 / 10), about 1.45 times
+    //   the quadric error.
+    // Levels are simplified from the previous level, so distances add up along the chain like
+    // the per level errors LodLevel::error accumulates.
+    constexpr float MeasuredSlack = 2.f;
+
+    // Rounding of the square root and of the sum along the chain
+    constexpr float ReportedTolerance = 1e-5f;
+
+    std::string ToObj(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices)
+    {
+        std::string obj;
+        char line[96];
+        for (auto& p : positions)
+        {
+            snprintf(line, sizeof(line), "v %.9g %.9g %.9g\n", p.x, p.y, p.z);
+            obj += line;
+        }
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            snprintf(line, sizeof(line), "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1);
+            obj += line;
+        }
+        return obj;
+    }
+
+    // Unit icosahedron with every triangle split in four per subdivision, closed and evenly tessellated
+    std::string GenerateSphere(int subdivisions)
+    {
+        const float t = (1.f + std::sqrt(5.f)) * 0.5f;
+        std::vector<glm::vec3> positions = {
+            { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+            { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+            { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 }
+        };
+        for (auto& p : positions)
+            p = glm::normalize(p);
+
+        std::vector<uint32_t> indices = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+        };
+
+        for (int s = 0; s < subdivisions; s++)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+            auto midpoint = [&](uint32_t a, uint32_t b) {
+                auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                auto it = midpoints.find(key);
+                if (it != midpoints.end())
+                    return it->second;
+
+                uint32_t index = static_cast<uint32_t>(positions.size());
+                positions.push_back(glm::normalize(positions[a] + positions[b]));
+                midpoints[key] = index;
+                return index;
+            };
+
+            std::vector<uint32_t> split;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+                split.insert(split.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+            indices.swap(split);
+        }
+
+        return ToObj(positions, indices);
+    }
+
+    // Flat size x size grid of quads in the XZ plane, open on all four sides
+    std::string GeneratePlane(int size)
+    {
+        std::string obj;
+        char line[96];
+        for (int z = 0; z <= size; z++)
+        {
+            for (int x = 0; x <= size; x++)
+            {
+                snprintf(line, sizeof(line), "v %d 0 %d\n", x, z);
+                obj += line;
+            }
+        }
+        for (int z = 0; z < size; z++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                int a = z * (size + 1) + x + 1;
+                snprintf(line, sizeof(line), "f %d %d %d %d\n", a, a + size + 1, a + size + 2, a + 1);
+                obj += line;
+            }
+        }
+        return obj;
+    }
+
+    // Loads obj with the default LOD settings, but as many levels as allowed so the chain runs
+    // down to a few dozen triangles. Checks the error SimplifyMesh reports against the level
+    // budget, and the brute force distance from the full resolution vertices against that error.
+    int CheckLodChain(const std::string& obj, uint32_t minLevels)
+    {
+        std::vector<char> data(obj.begin(), obj.end());
+        GE::Gfx::Model model;
+        model.lodSettings.maxLevels = GE::Gfx::LodSettings::MaxLevels;
+        model.Load(data);
+        if (!model._isLoaded || model.objects.Size() != 1)
+        {
+            printf("  model failed to load\n");
+            return 1;
+        }
+
+        auto& object = model.objects[0];
+        glm::vec3 min = object.vertices.front();
+        glm::vec3 max = min;
+        for (auto& v : object.vertices)
+        {
+            min = glm::min(min, v);
+            max = glm::max(max, v);
+        }
+        glm::vec3 extent = max - min;
+        float scale = std::max(extent.x, std::max(extent.y, extent.z));
+
+        int failures = 0;
+        if (object.lods.size() < minLevels)
+        {
+            printf("  %zu levels, expected at least %u\n", object.lods.size(), minLevels);
+            failures++;
+        }
+
+        printf("  %-6s %10s %12s %12s %12s\n", "level", "triangles", "reported", "measured", "budget");
+        for (uint32_t level = 0; level < object.lods.size(); level++)
+        {
+            auto& lod = object.lods[level];
+            float budget = scale * model.lodSettings.maxError * level;
+            float measured = level == 0 ? 0.f : GE::Gfx::MeasureSimplificationError(object.indices.data(), object.lods[0].indexCount,
+                object.indices.data() + lod.firstIndex, lod.indexCount, object.vertices.data());
+
+            printf("  LOD%-3u %10u %12.5f %12.5f %12.5f\n", level, lod.indexCount / 3, lod.error, measured, budget);
+
+            if (lod.error > budget * (1.f + ReportedTolerance))
+            {
+                printf("  LOD%u reported error over the budget\n", level);
+                failures++;
+            }
+            if (measured > lod.error * MeasuredSlack)
+            {
+                printf("  LOD%u measured error over %.0fx the reported error\n", level, MeasuredSlack);
+                failures++;
+            }
+        }
+
+        return failures;
+    }
+}
+
+int TestLodSphere()
+{
+    return CheckLodChain(GenerateSphere(4), 3) == 0 ? 0 : 1;
+}
+
+int TestLodPlane()
+{
+    return CheckLodChain(GeneratePlane(64), 3) == 0 ? 0 : 1;
+}
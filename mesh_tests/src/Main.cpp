@@ -0,0 +1,57 @@
+#include <cstdio>
+#include <cstring>
+
+#include <ge/core/Global.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    struct Test
+    {
+        const char* name;
+        int (*run)();
+    };
+
+    const Test Tests[] = {
+        { "obj_relative", TestObjRelative },
+        { "obj_groups", TestObjGroups },
+        { "obj_missing_attributes", TestObjMissingAttributes },
+        { "obj_polygons", TestObjPolygons },
+        { "obj_chunks", TestObjChunks },
+        { "obj_fallback", TestObjFallback },
+        { "lod_sphere", TestLodSphere },
+        { "lod_plane", TestLodPlane },
+    };
+}
+
+// Runs the tests named on the command line, or every test without arguments
+int main(int argc, char* argv[])
+{
+    GE::Global::Get().Initialize();
+
+    int ran = 0, failed = 0;
+    for (const Test& test : Tests)
+    {
+        bool wanted = argc < 2;
+        for (int i = 1; i < argc && !wanted; i++)
+            wanted = std::strcmp(argv[i], test.name) == 0;
+        if (!wanted)
+            continue;
+
+        printf("[%s]\n", test.name);
+        int result = test.run();
+        printf("[%s] %s\n", test.name, result == 0 ? "passed" : "FAILED");
+        ran++;
+        failed += result != 0;
+    }
+
+    GE::Global::Get().Release();
+
+    if (ran == 0)
+    {
+        printf("usage: MeshTests [test...]\n");
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ge/gfx/ObjParser.hpp>
+
+#include "Tests.hpp"
+
+namespace
+{
+    const char* const Materials =
+        "newmtl red\n"
+        "Kd 1 0 0\n"
+        "newmtl blue\n"
+        "Kd 0 0 1\n";
+
+    template<typename T>
+    bool SameArray(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    // Field by field comparison of everything Model reads from the parse, floats bit for bit
+    int CompareParses(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, const std::vector<tinyobj::material_t>& materials,
+        const tinyobj::attrib_t& expectedAttrib, const std::vector<tinyobj::shape_t>& expectedShapes, const std::vector<tinyobj::material_t>& expectedMaterials)
+    {
+        int differences = 0;
+        auto check = [&](bool same, const char* what, size_t shape) {
+            if (!same && differences++ < 16)
+                printf("  mismatch: %s (shape %zu)\n", what, shape);
+        };
+
+        check(SameArray(attrib.vertices, expectedAttrib.vertices), "vertices", 0);
+        check(SameArray(attrib.normals, expectedAttrib.normals), "normals", 0);
+        check(SameArray(attrib.texcoords, expectedAttrib.texcoords), "texcoords", 0);
+        check(shapes.size() == expectedShapes.size(), "shape count", shapes.size());
+        check(materials.size() == expectedMaterials.size(), "material count", 0);
+
+        for (size_t i = 0; i < std::min(shapes.size(), expectedShapes.size()); i++)
+        {
+            auto& mesh = shapes[i].mesh;
+            auto& expected = expectedShapes[i].mesh;
+            check(shapes[i].name == expectedShapes[i].name, "name", i);
+            check(mesh.indices.size() == expected.indices.size(), "index count", i);
+            for (size_t j = 0; j < std::min(mesh.indices.size(), expected.indices.size()); j++)
+            {
+                auto& a = mesh.indices[j];
+                auto& b = expected.indices[j];
+                if (a.vertex_index != b.vertex_index || a.normal_index != b.normal_index || a.texcoord_index != b.texcoord_index)
+                {
+                    check(false, "indices", i);
+                    break;
+                }
+            }
+            check(mesh.num_face_vertices == expected.num_face_vertices, "face sizes", i);
+            check(mesh.material_ids == expected.material_ids, "material ids", i);
+            check(mesh.smoothing_group_ids == expected.smoothing_group_ids, "smoothing groups", i);
+        }
+
+        for (size_t i = 0; i < std::min(materials.size(), expectedMaterials.size()); i++)
+            check(materials[i].name == expectedMaterials[i].name, "material name", i);
+
+        return differences;
+    }
+
+    // Parses obj with tinyobj and with ParseObj on one thread and on every thread, and counts
+    // the runs that were handed back or differ from tinyobj
+    int CompareWithTinyobj(const std::string& obj)
+    {
+        tinyobj::attrib_t expectedAttrib;
+        std::vector<tinyobj::shape_t> expectedShapes;
+        std::vector<tinyobj::material_t> expectedMaterials;
+        {
+            std::string warn, err;
+            std::istringstream objStream(obj);
+            std::istringstream mtlStream(Materials);
+            tinyobj::MaterialStreamReader mtlReader(mtlStream);
+            if (!tinyobj::LoadObj(&expectedAttrib, &expectedShapes, &expectedMaterials, &warn, &err, &objStream, &mtlReader))
+            {
+                printf("  tinyobj failed: %s\n", err.c_str());
+                return 1;
+            }
+        }
+
+        size_t indices = 0;
+        for (auto& shape : expectedShapes)
+            indices += shape.mesh.indices.size();
+        printf("  %zu bytes, %zu shapes, %zu triangles\n", obj.size(), expectedShapes.size(), indices / 3);
+
+        int failures = 0;
+        for (uint32_t threads : { 1u, 0u })
+        {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn;
+            std::istringstream mtlStream(Materials);
+
+            if (!GE::Gfx::ParseObj(obj.data(), obj.size(), &mtlStream, attrib, shapes, materials, warn, threads))
+            {
+                printf("  ParseObj handed the file to tinyobj (threads %u)\n", threads);
+                failures++;
+                continue;
+            }
+
+            int differences = CompareParses(attrib, shapes, materials, expectedAttrib, expectedShapes, expectedMaterials);
+            if (differences > 0)
+            {
+                printf("  %d differences from tinyobj (threads %u)\n", differences, threads);
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    bool Fallback(const std::string& obj)
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn;
+        return !GE::Gfx::ParseObj(obj.data(), obj.size(), nullptr, attrib, shapes, materials, warn);
+    }
+
+    // A width x height grid of vertices with positions, texcoords and normals, one set per line
+    void AppendGrid(std::string& obj, int width, int height)
+    {
+        char line[96];
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                snprintf(line, sizeof(line), "v %d.25 %d.5 -%d.125e-1\nvt 0.%d 0.%d\nvn 0 0 1\n", x, y, x + y, x, y);
+                obj += line;
+            }
+        }
+    }
+}
+
+int TestObjRelative()
+{
+    std::string obj =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\n"
+        "vn 0 0 1\n"
+        "f -3/-3/-1 -2/-2/-1 -1/-1/-1\n"
+        "v 2 0 0\nv 2 1 0\n"
+        "vt 0.5 0.5\n"
+        "f -4/1/1 -2/-1/-1 -1/-2/1\n"
+        "f 2/2/1 -2/-1/-1 5/4/-1\n";
+
+    return CompareWithTinyobj(obj) == 0 ? 0 : 1;
+}
+
+int TestObjGroups()
+{
+    std::string obj =
+        "mtllib scene.mtl\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "f 1 2 3\n"
+        "g first  part\n"
+        "usemtl red\n"
+        "s 1\n"
+        "f 1 2 3\n"
+        "usemtl blue\n"
+        "f 1 3 4\n"
+        "s off\n"
+        "usemtl missing\n"
+        "f 2 3 4\n"
+        "g empty\n"
+        "o named object\n"
+        "usemtl red\n"
+        "f 1 2 4\n"
+        "g\n"
+        "s 2\n"
+        "f 1 2 3\n"
+        "o named object\n"
+        "f 2 3 4\n";
+
+    return CompareWithTinyobj(obj) == 0 ? 0 : 1;
+}
+
+int TestObjMissingAttributes()
+{
+    std::string obj =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "f 1 2 3\n"
+        "vt 0 0\nvt 1 1\n"
+        "f 1/1 2/2 3/1\n"
+        "vn 0 0 1\n"
+        "f 1//1 3//1 4//1\n"
+        "f 2/1/1 3//1 4/2\n";
+
+    return CompareWithTinyobj(obj) == 0 ? 0 : 1;
+}
+
+int TestObjPolygons()
+{
+    std::string obj =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv -1 0.5 0\nv 0.5 2 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+        "f 1 2 3 6 4 5\n"
+        "usemtl red\n"
+        "f -6/-4 -5/-3 -4/-2 -3/-1 -2/-4\n"
+        "f 1 2\n"
+        "s 3\n"
+        "f 4//1 3//1 2//1 1//1\n";
+
+    return CompareWithTinyobj(obj) == 0 ? 0 : 1;
+}
+
+// Runs of faces longer than the parser's 4 MB chunks, so chunk boundaries land inside them
+// with relative indices, polygons, material and group switches on both sides
+int TestObjChunks()
+{
+    const int width = 256;
+    const int height = 256;
+
+    std::string obj = "mtllib scene.mtl\n";
+    AppendGrid(obj, width, height);
+
+    char line[160];
+    for (int pass = 0; pass < 2; pass++)
+    {
+        snprintf(line, sizeof(line), "g pass%d\n", pass);
+        obj += line;
+
+        for (int y = 0; y + 1 < height; y++)
+        {
+            if (y % 64 == 0)
+                obj += y % 128 == 0 ? "usemtl red\n" : "usemtl blue\n";
+
+            for (int x = 0; x + 1 < width; x++)
+            {
+                int a = y * width + x + 1;
+                int b = a + 1;
+                int c = a + width + 1;
+                int d = a + width;
+                if (pass == 0)
+                    snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+                else
+                {
+                    // Relative to the vertex count, which stays width * height
+                    int count = width * height;
+                    snprintf(line, sizeof(line), "f %d/%d %d/%d %d/%d\nf %d//%d %d//%d %d//%d\n",
+                        a - count - 1, a, b - count - 1, b, c - count - 1, c, a, a - count - 1, c, c - count - 1, d, d - count - 1);
+                }
+                obj += line;
+            }
+        }
+    }
+
+    // Vertices declared between faces move the base that later relative indices use
+    AppendGrid(obj, width, 2);
+    for (int x = 0; x + 1 < width; x++)
+    {
+        snprintf(line, sizeof(line), "f -%d -%d -%d -%d\n", 2 * width - x, 2 * width - x - 1, width - x - 1, width - x);
+        obj += line;
+    }
+
+    if (obj.size() < 2 * 4 * 1024 * 1024)
+    {
+        printf("  generated only %zu bytes, less than three chunks\n", obj.size());
+        return 1;
+    }
+    return CompareWithTinyobj(obj) == 0 ? 0 : 1;
+}
+
+// Lines, points and malformed faces are tinyobj's to handle, including when they come
+// after several chunks of supported records
+int TestObjFallback()
+{
+    std::string vertices = "v 0 0 0\nv 1 0 0\nv 1 1 0\n";
+    std::string large;
+    AppendGrid(large, 512, 256);
+
+    int failures = 0;
+    auto check = [&](bool fellBack, const char* what) {
+        if (!fellBack)
+        {
+            printf("  %s was parsed instead of handed to tinyobj\n", what);
+            failures++;
+        }
+    };
+
+    check(Fallback(vertices + "l 1 2 3\n"), "line");
+    check(Fallback(vertices + "p 1 2\n"), "point");
+    check(Fallback(vertices + "f 0 1 2\n"), "zero index");
+    check(Fallback(vertices + "f 1/0 2 3\n"), "zero texcoord index");
+    check(Fallback(large + "f 1 2 3\nl 1 2\n"), "line after several chunks");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Every test prints what it measured and returns 0 when all of its checks passed
+int TestObjRelative();
+int TestObjGroups();
+int TestObjMissingAttributes();
+int TestObjPolygons();
+int TestObjChunks();
+int TestObjFallback();
+int TestLodSphere();
+int TestLodPlane();
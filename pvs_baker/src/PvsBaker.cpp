@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ge/core/Global.hpp>
+#include <ge/gfx/Model.hpp>
+#include <ge/math/PotentiallyVisibleSet.hpp>
+#include <ge/utils/FileLoading.hpp>
+
+// Bakes the potentially visible set of a static model, one object per entity in the order the
+// model publishes them. The output is packed into EngineData.blob with DataPacker -t pvs.
+namespace
+{
+    constexpr float DefaultCells = 32.f;
+
+    struct Options
+    {
+        std::string model;
+        std::string output;
+        GE::Math::PvsBakeSettings settings;
+        bool bounds{ false };   // settings.min and max given, otherwise the model's bounds
+        bool cell{ false };     // settings.cellSize given, otherwise DefaultCells along the longest side
+        uint32_t lod{ 0 };      // Occluder level of detail, coarser bakes faster but may hide too much
+    };
+
+    std::vector<float> SplitFloats(const std::string& value)
+    {
+        std::vector<float> result;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ','))
+            result.push_back(std::stof(item));
+        return result;
+    }
+
+    void PrintUsage()
+    {
+        printf("usage: PvsBaker <model.obj> -o <model.pvs> [--cell size] [--samples 9] [--dilation 1] [--lod 0]\n");
+        printf("                [--threads max] [--bounds minX,minY,minZ,maxX,maxY,maxZ]\n");
+        printf("bounds is the volume the camera moves in, the model's bounds when left out, split into\n");
+        printf("%.0f cells along its longest side unless --cell is given\n", DefaultCells);
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg.size() < 2 || arg[0] != '-')
+            {
+                options.model = arg;
+                continue;
+            }
+            if (i + 1 >= argc)
+                return false;
+
+            std::string value = argv[++i];
+            if (arg == "-o")
+                options.output = value;
+            else if (arg == "--cell")
+            {
+                options.settings.cellSize = std::stof(value);
+                options.cell = true;
+            }
+            else if (arg == "--samples")
+                options.settings.samplesPerCell = std::max(1u, static_cast<uint32_t>(std::stoul(value)));
+            else if (arg == "--dilation")
+                options.settings.dilation = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--lod")
+                options.lod = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--threads")
+                options.settings.threads = std::max(1u, static_cast<uint32_t>(std::stoul(value)));
+            else if (arg == "--bounds")
+            {
+                std::vector<float> bounds = SplitFloats(value);
+                if (bounds.size() != 6)
+                    return false;
+                options.settings.min = { bounds[0], bounds[1], bounds[2] };
+                options.settings.max = { bounds[3], bounds[4], bounds[5] };
+                options.bounds = true;
+            }
+            else
+                return false;
+        }
+        return !options.model.empty() && !options.output.empty() && options.settings.cellSize > 0.f;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    options.settings.threads = static_cast<uint32_t>(GE::GlobalThreadPool().Size() + 1);
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    if (!GE::Utils::FileExist(options.model.c_str()))
+    {
+        printf("File not found: %s\n", options.model.c_str());
+        return -2;
+    }
+
+    GE::Gfx::Model model;
+    std::string mtlPath = options.model.substr(0, options.model.find_last_of('.')) + ".mtl";
+    if (GE::Utils::FileExist(mtlPath.c_str()))
+    {
+        model._mtlPath = mtlPath;
+        model._mtl_data = GE::Utils::LoadFile(mtlPath.c_str());
+    }
+    auto data = GE::Utils::LoadFile(options.model.c_str());
+    model.Load(data);
+    if (!model._isLoaded)
+    {
+        printf("Failed to load %s\n", options.model.c_str());
+        return -3;
+    }
+
+    std::vector<AABB> objects;
+    std::vector<Occluder> occluders;
+    for (auto& object : model.objects)
+    {
+        objects.push_back(object.bounds.aabb);
+
+        Occluder occluder;
+        if (!object.lods.empty())
+        {
+            const auto& level = object.lods[std::min<size_t>(options.lod, object.lods.size() - 1)];
+            occluder = { object.vertices.data(), object.indices.data() + level.firstIndex, level.indexCount };
+        }
+        occluders.push_back(occluder);
+    }
+
+    if (!options.bounds && !objects.empty())
+    {
+        options.settings.min = objects.front().min;
+        options.settings.max = objects.front().max;
+        for (const AABB& object : objects)
+        {
+            options.settings.min = glm::min(options.settings.min, object.min);
+            options.settings.max = glm::max(options.settings.max, object.max);
+        }
+    }
+
+    glm::vec3 extent = options.settings.max - options.settings.min;
+    if (!options.cell)
+        options.settings.cellSize = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-3f)) / DefaultCells;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    GE::Math::PvsBakeStats stats;
+    GE::Math::PotentiallyVisibleSet pvs = GE::Math::BakePotentiallyVisibleSet(objects.data(), occluders.data(), objects.size(), options.settings, &stats);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    uint32_t covered = stats.cells - stats.uncovered;
+    glm::uvec3 cells = pvs.GetCells();
+    printf("%s: %zu objects, %u x %u x %u cells of %.2f (%u uncovered), %llu samples on %u threads in %.1f s\n",
+        options.model.c_str(), objects.size(), cells.x, cells.y, cells.z, options.settings.cellSize, stats.uncovered,
+        (unsigned long long)stats.samples, options.settings.threads, seconds);
+    printf("%.1f of %zu objects per covered cell, %u distinct sets in %zu bytes\n",
+        double(stats.visibleBits) / std::max(covered, 1u), objects.size(), pvs.NumSets(), pvs.CodedBytes());
+
+    std::vector<char> serialized = pvs.Serialize();
+    std::ofstream out(options.output, std::ios_base::binary | std::ios_base::trunc);
+    if (!out.is_open())
+        return -4;
+    out.write(serialized.data(), serialized.size());
+    return out.good() ? 0 : -4;
+}
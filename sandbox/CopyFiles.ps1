@@ -1,7 +1,9 @@
 param (
     [Parameter(Mandatory=$true)][string]$SRC,
     [Parameter(Mandatory=$true)][string]$DEST,
-    [Parameter(Mandatory=$false)][switch]$RELEASE
+    [Parameter(Mandatory=$false)][switch]$RELEASE,
+    [Parameter(Mandatory=$false)][string]$DATAPACKER,
+    [Parameter(Mandatory=$false)][string]$PVSBAKER
  )
 
 if(!(Test-Path -Path $DEST)) {
@@ -107,3 +109,19 @@ if($LastExitCode -gt 0 -and $LastExitCode -ne 2 ){
     $xmlWriter.Flush()
     $xmlWriter.Close()
 }
+
+# Rebake the potentially visible set when the model changed, then pack it after the engine data
+if($PVSBAKER -and $DATAPACKER) {
+    $model=$SRC+"models\sponza.obj"
+    $pvs=$DEST+"..\sponza.pvs"
+    if(!(Test-Path -Path $pvs) -or (ls $model).LastWriteTime -gt (ls $pvs).LastWriteTime) {
+        Write-Output "Baking potentially visible set..."
+        & $PVSBAKER $model -o $pvs | out-null
+    }
+
+    $dataBlob=$DEST+"..\resources\EngineData.blob"
+    Copy-Item $SRC"..\..\internal\SaneEngine\include\resources\EngineData.blob" $dataBlob
+    if(Test-Path -Path $pvs) {
+        & $DATAPACKER -o $dataBlob -t pvs $pvs | out-null
+    }
+}
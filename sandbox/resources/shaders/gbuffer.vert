@@ -3,12 +3,10 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in vec3 aNormal;
-layout (location = 3) in float aTexID;
 
 layout (location = 0) out vec3 FragPos;
 layout (location = 1) out vec2 TexCoords;
 layout (location = 2) out vec3 Normal;
-layout (location = 3) out float TexID;
 
 layout(binding = 0) uniform UniformBufferObject {
     mat4 projection;
@@ -25,6 +23,4 @@ void main()
     Normal = model * aNormal;
 
     gl_Position = projection * view * worldPos;
-
-    TexID = aTexID;
 }
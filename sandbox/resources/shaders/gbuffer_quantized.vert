@@ -0,0 +1,39 @@
+#version 450
+
+layout (location = 0) in vec4 aPos;
+layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec2 aNormal;
+
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec2 TexCoords;
+layout (location = 2) out vec3 Normal;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 projection;
+    mat4 view;
+};
+
+// Maps the unorm positions back onto the object AABB
+layout(push_constant) uniform Dequantization {
+    vec4 offset;
+    vec4 scale;
+} dequantization;
+
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    vec4 worldPos = vec4(dequantization.offset.xyz + dequantization.scale.xyz * aPos.xyz, 1.0);
+    FragPos = worldPos.xyz;
+    TexCoords = aTexCoords;
+    Normal = DecodeOctahedral(aNormal);
+
+    gl_Position = projection * view * worldPos;
+}
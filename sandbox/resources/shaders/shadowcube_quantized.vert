@@ -0,0 +1,31 @@
+#version 450
+
+layout (location = 0) in vec4 inPos;
+
+layout (location = 0) out vec4 outPos;
+layout (location = 1) out vec3 outLightPos;
+
+layout (binding = 0) uniform UBO {
+	mat4 projection;
+	mat4 model;
+	vec4 lightPos;
+} ubo;
+
+layout(push_constant) uniform PushConsts {
+	mat4 view;
+	vec4 offset;
+	vec4 scale;
+} pushConsts;
+ 
+out gl_PerVertex {
+	vec4 gl_Position;
+};
+ 
+void main()
+{
+	vec4 pos = vec4(pushConsts.offset.xyz + pushConsts.scale.xyz * inPos.xyz, 1.0);
+	gl_Position = ubo.projection * pushConsts.view * ubo.model * pos;
+
+	outPos = pos;
+	outLightPos = ubo.lightPos.xyz; 
+}
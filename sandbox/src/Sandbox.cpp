@@ -1,3 +1,5 @@
+#include <deque>
+
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <entt/entt.hpp>
@@ -12,10 +14,17 @@
 #include <ge/gfx/Model.hpp>
 #include <ge/gfx/RenderPass.hpp>
 #include <ge/gfx/Texture.hpp>
+#include <ge/gfx/VertexLayout.hpp>
+#include <ge/math/PotentiallyVisibleSet.hpp>
+#include <ge/math/ShadowCull.hpp>
 #include <ge/systems/Camera3D.hpp>
 #include <ge/systems/InputSystem.hpp>
+#include <ge/systems/LodSystem.hpp>
+#include <ge/systems/ResourceTimelineGui.hpp>
 #include <ge/systems/SkyboxSystem.hpp>
+#include <ge/systems/ClusterCullingSystem.hpp>
 #include <ge/systems/FrustumCullingSystem.hpp>
+#include <ge/systems/OcclusionCullingSystem.hpp>
 #include <ge/utils/Types.hpp>
 #include <ge/utils/BlobParser.hpp>
 #include "ManifestHeader.hpp"
@@ -25,6 +34,12 @@ GLM_FUNC_QUALIFIER GLM_CONSTEXPR genType pi() { return genType(3.141592653589793
 
 #define SHADOWMAP_RESOLUTION 4096
 
+// Must match Model::vertexFormat, which picks the streams uploaded by Mesh
+constexpr GE::Gfx::VertexFormat SceneVertexFormat = GE::Gfx::VertexFormat::Quantized;
+
+// G-buffer fragment push constant holding the material of the current draw, after the vertex stage's dequantization
+constexpr uint32_t MaterialPushOffset = sizeof(Drawable::Dequantization);
+
 struct GBufferUniforms
 {
 	alignas(16) glm::mat4 gWVP;
@@ -81,7 +96,28 @@ public:
 		entity = registry.create();
 		registry.emplace<Visibility>(entity, false);
 		registry.emplace<Object>(entity, this);
-		registry.emplace<CenterOfMass>(entity, object->centerOfMass);
+		registry.emplace<CenterOfMass>(entity, object->bounds.centerOfMass);
+		registry.emplace<AABB>(entity, object->bounds.aabb);
+
+		LevelOfDetail lod;
+		lod.radius = object->bounds.radius;
+
+		lod.numLevels = static_cast<uint32_t>(std::min<size_t>(std::max<size_t>(object->lods.size(), 1), GE::Gfx::LodSettings::MaxLevels));
+		for (uint32_t level = 0; level < lod.numLevels && level < object->lods.size(); level++)
+			lod.errors[level] = object->lods[level].error;
+		registry.emplace<LevelOfDetail>(entity, lod);
+
+		ClusterCulling clusters;
+		clusters.clusters = object->clusters.data();
+		clusters.numClusters = static_cast<uint32_t>(object->clusters.size());
+		registry.emplace<ClusterCulling>(entity, clusters);
+
+		// The coarsest level is plenty to hide things behind
+		if (!object->lods.empty())
+		{
+			const auto& coarsest = object->lods.back();
+			registry.emplace<Occluder>(entity, Occluder{ object->vertices.data(), object->indices.data() + coarsest.firstIndex, coarsest.indexCount });
+		}
 	}
 
 	virtual ~Mesh()
@@ -90,7 +126,7 @@ public:
 			verticesBuffer.Destroy();
 			texCoordsBuffer.Destroy();
 			normalsBuffer.Destroy();
-			texIdsBuffer.Destroy();
+			indicesBuffer.Destroy();
 		}
 	}
 
@@ -101,40 +137,104 @@ public:
 
 		numVerts = static_cast<uint32_t>(object->vertices.size());
 
-		verticesBuffer.Create(object->vertices.size() * sizeof(glm::vec3));
-		verticesBuffer.Buffer(cmdBuffer, object->vertices.data(), object->vertices.size() * sizeof(glm::vec3));
+		auto& quantized = object->quantized;
+		if (!quantized.positions.empty())
+		{
+			dequantization.offset = glm::vec4(quantized.positionOffset, 0.f);
+			dequantization.scale = glm::vec4(quantized.positionScale, 0.f);
 
-		glm::vec3 min = object->vertices.front();
-		glm::vec3 max = object->vertices.front();
-		for (auto& v : object->vertices) {
-			min = glm::vec3(std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z));
-			max = glm::vec3(std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z));
+			BufferStream(verticesBuffer, cmdBuffer, quantized.positions);
+			BufferStream(texCoordsBuffer, cmdBuffer, quantized.texCoords);
+			BufferStream(normalsBuffer, cmdBuffer, quantized.normals);
+		}
+		else
+		{
+			BufferStream(verticesBuffer, cmdBuffer, object->vertices);
+			BufferStream(texCoordsBuffer, cmdBuffer, object->texCoords);
+			BufferStream(normalsBuffer, cmdBuffer, object->normals);
 		}
-		GE::GlobalRegistry().emplace<AABB>(entity, min, max);
-
-		texCoordsBuffer.Create(object->texCoords.size() * sizeof(glm::vec2));
-		texCoordsBuffer.Buffer(cmdBuffer, object->texCoords.data(), object->texCoords.size() * sizeof(glm::vec2));
-
-		normalsBuffer.Create(object->normals.size() * sizeof(glm::vec3));
-		normalsBuffer.Buffer(cmdBuffer, object->normals.data(), object->normals.size() * sizeof(glm::vec3));
 
-		texIdsBuffer.Create(object->texture_id.size() * sizeof(float));
-		texIdsBuffer.Buffer(cmdBuffer, object->texture_id.data(), object->texture_id.size() * sizeof(float));
+		numIndices = object->lods.empty() ? static_cast<uint32_t>(object->indices.size()) : object->lods.front().indexCount;
+		if (numVerts <= 0xFFFF)
+		{
+			std::vector<uint16_t> indices(object->indices.begin(), object->indices.end());
+			indicesBuffer.Create(indices.size() * sizeof(uint16_t), VK_INDEX_TYPE_UINT16);
+			indicesBuffer.Buffer(cmdBuffer, indices.data(), indices.size() * sizeof(uint16_t));
+		}
+		else
+		{
+			indicesBuffer.Create(object->indices.size() * sizeof(uint32_t), VK_INDEX_TYPE_UINT32);
+			indicesBuffer.Buffer(cmdBuffer, object->indices.data(), object->indices.size() * sizeof(uint32_t));
+		}
 
 		loaded = true;
 		return true;
 	}
 
-	virtual void Draw(VkCommandBuffer cmdBuffer, VkDescriptorSet* descriptor, uint32_t frameIndex) override
+	virtual void Bind(VkCommandBuffer cmdBuffer) override
 	{
-		if (!loaded)
+		VkDeviceSize offsets[] = { 0, 0, 0 };
+		VkBuffer buffers[] = { verticesBuffer, texCoordsBuffer, normalsBuffer };
+		vkCmdBindVertexBuffers(cmdBuffer, 0, 3, buffers, offsets);
+		indicesBuffer.Bind(cmdBuffer);
+	}
+
+	virtual void DrawCommands(std::vector<DrawCommand>& commands) const override
+	{
+		if (object->lods.empty())
+			return Drawable::DrawCommands(commands);
+
+		const LevelOfDetail& lod = GE::GlobalRegistry().get<LevelOfDetail>(entity);
+		const auto& level = object->lods[lod.level < object->lods.size() ? lod.level : 0];
+		const GE::Gfx::Submesh* submesh = object->submeshes.data() + level.firstSubmesh;
+		const GE::Gfx::Submesh* lastSubmesh = submesh + level.numSubmeshes;
+
+		const ClusterCulling& clusters = GE::GlobalRegistry().get<ClusterCulling>(entity);
+		if (!clusters.active)
+		{
+			for (; submesh != lastSubmesh; submesh++)
+				commands.push_back({ submesh->firstIndex, submesh->indexCount, submesh->material });
 			return;
+		}
 
-		VkDeviceSize offsets[] = { 0, 0, 0, 0 };
-		VkBuffer buffers[] = { verticesBuffer, texCoordsBuffer, normalsBuffer, texIdsBuffer };
-		vkCmdBindVertexBuffers(cmdBuffer, 0, 4, buffers, offsets);
+		// Clusters never straddle submeshes but merged ranges can, so split them at the boundaries
+		for (auto& range : clusters.ranges)
+		{
+			uint32_t first = range.firstIndex;
+			uint32_t last = range.firstIndex + range.indexCount;
+			while (first < last && submesh != lastSubmesh)
+			{
+				uint32_t submeshEnd = submesh->firstIndex + submesh->indexCount;
+				if (first >= submeshEnd)
+				{
+					submesh++;
+					continue;
+				}
 
-		vkCmdDraw(cmdBuffer, numVerts, 1, 0, 0);
+				uint32_t end = std::min(last, submeshEnd);
+				commands.push_back({ first, end - first, submesh->material });
+				first = end;
+			}
+		}
+	}
+
+	template<typename T>
+	static void BufferStream(GE::Gfx::VulkanVertexBuffer& buffer, VkCommandBuffer cmdBuffer, const GE::Utils::Span<T>& stream)
+	{
+		buffer.Create(stream.size() * sizeof(T));
+		buffer.Buffer(cmdBuffer, stream.data(), stream.size() * sizeof(T));
+	}
+
+	virtual void DrawRange(uint32_t& firstIndex, uint32_t& indexCount) const override
+	{
+		const LevelOfDetail& lod = GE::GlobalRegistry().get<LevelOfDetail>(entity);
+		if (lod.level < object->lods.size())
+		{
+			firstIndex = object->lods[lod.level].firstIndex;
+			indexCount = object->lods[lod.level].indexCount;
+		}
+		else
+			Drawable::DrawRange(firstIndex, indexCount);
 	}
 
 public:
@@ -145,11 +245,13 @@ public:
 class TestLayer : virtual public GE::Sys::System, public GE::Camera3DSink, public GE::ResourceSink
 {
 public:
-	TestLayer()
+	TestLayer(const GE::Sys::FrustumCullingSystem* cullingSys)
 		: GE::Sys::System("TestLayer")
+		, _cullingSys(cullingSys)
 	{
 		REGISTER_SYSTEM();
 		GE::Utils::EngineResourceParser::Get();
+		_modelRequestedAt = GE::NowMicroseconds();
 	}
 
 	void Attach()
@@ -157,15 +259,56 @@ public:
 		GE::Gfx::NullTexture::Get();
 		CreateUserData();
 		GE::GlobalDispatcher().sink<GE::Gfx::ResizeEvent>().connect<&TestLayer::Resize>(this);
+		GE::GlobalDispatcher().sink<GE::ResourcePartLoaded>().connect<&TestLayer::OnModelObjectLoaded>(this);
 	}
 
 	void Detach()
 	{
 		GE::Gfx::NullTexture::Get()->Destroy();
 		GE::GlobalDispatcher().sink<GE::Gfx::ResizeEvent>().disconnect<&TestLayer::Resize>(this);
+		GE::GlobalDispatcher().sink<GE::ResourcePartLoaded>().disconnect<&TestLayer::OnModelObjectLoaded>(this);
 		DestroyUserData();
 	}
 
+	// Meshes are created as the model publishes its objects, nearby ones render while the rest parses
+	void OnModelObjectLoaded(const GE::ResourcePartLoaded& part)
+	{
+		if (static_cast<uint64_t>(part.uuid) != MODEL_SPONZA_OBJ || part.part < _modelObjects.size())
+			return;
+
+		// The first object guarantees the materials, so the texture table can be built
+		if (_modelObjects.empty())
+		{
+			vkDeviceWaitIdle(*GE::Gfx::VulkanCore::Get().device);
+			ResourcesUpdated = true;
+		}
+
+		while (_modelObjects.size() <= part.part)
+		{
+			uint32_t index = static_cast<uint32_t>(_modelObjects.size());
+			Mesh& mesh = _modelObjects.emplace_back(&_modelHandle->objects[index]);
+			GE::GlobalRegistry().emplace<PvsObject>(mesh.entity, index);
+			if (!_materialTextures.empty())
+				AddResourceUsage(mesh);
+		}
+	}
+
+	// Let the resource system stream the textures of visible, nearby meshes first
+	void AddResourceUsage(const Mesh& mesh)
+	{
+		ResourceUsage usage;
+		for (auto& submesh : mesh.object->submeshes)
+		{
+			if (submesh.material >= _materialTextures.size())
+				continue;
+
+			auto uuid = _materialTextures[submesh.material];
+			if (std::find(usage.resources.begin(), usage.resources.end(), uuid) == usage.resources.end())
+				usage.resources.push_back(uuid);
+		}
+		GE::GlobalRegistry().emplace_or_replace<ResourceUsage>(mesh.entity, usage);
+	}
+
 	void CreateUserData()
 	{
 		commandBuffers.Create(64);
@@ -201,23 +344,17 @@ public:
 		});
 
 		{
-			_gbufferPass.AddShader("shaders/gbuffer.vert.spv");
+			bool quantized = SceneVertexFormat == GE::Gfx::VertexFormat::Quantized;
+			_gbufferPass.AddShader(quantized ? "shaders/gbuffer_quantized.vert.spv" : "shaders/gbuffer.vert.spv");
 			_gbufferPass.AddShader("shaders/gbuffer.frag.spv");
 			_gbufferPass.SetClearFlag(true);
 
-			_gbufferPass.AddVertexBufferDescs({
-				{ 0, 3_FLOAT, VK_VERTEX_INPUT_RATE_VERTEX },
-				{ 1, 2_FLOAT, VK_VERTEX_INPUT_RATE_VERTEX },
-				{ 2, 3_FLOAT, VK_VERTEX_INPUT_RATE_VERTEX },
-				{ 3, 1_FLOAT, VK_VERTEX_INPUT_RATE_VERTEX },
-				});
-
-			_gbufferPass.AddVertexAttribDescs({
-				{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
-				{ 1, 1, VK_FORMAT_R32G32_SFLOAT, 0 },
-				{ 2, 2, VK_FORMAT_R32G32B32_SFLOAT, 0 },
-				{ 3, 3, VK_FORMAT_R32_SFLOAT, 0 },
-				});
+			auto layout = GE::Gfx::GetVertexInputLayout(SceneVertexFormat);
+			_gbufferPass.AddVertexBufferDescs(layout.bindings);
+			_gbufferPass.AddVertexAttribDescs(layout.attributes);
+			if (quantized)
+				_gbufferPass.AddPushConstants({ {VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Drawable::Dequantization)} });
+			_gbufferPass.AddPushConstants({ {VK_SHADER_STAGE_FRAGMENT_BIT, MaterialPushOffset, sizeof(uint32_t)} });
 
 			_gbufferPass.AddDescriptorsSetLayouts({ descriptorPool.GetDescriptorSetLayout(0) });
 			_gbufferPass.Configure(GE::Gfx::GetNumFrames(), GE::Gfx::GetFrameWidth(), GE::Gfx::GetFrameHeight());
@@ -225,18 +362,15 @@ public:
 		}
 		{
 			_shadowPass.SetClearFlag(true);
-			_shadowPass.AddShader("shaders/shadowcube.vert.spv");
+			bool quantized = SceneVertexFormat == GE::Gfx::VertexFormat::Quantized;
+			_shadowPass.AddShader(quantized ? "shaders/shadowcube_quantized.vert.spv" : "shaders/shadowcube.vert.spv");
 			_shadowPass.AddShader("shaders/shadowcube.frag.spv");
 
-			_shadowPass.AddVertexBufferDescs({
-				{ 0, 3_FLOAT, VK_VERTEX_INPUT_RATE_VERTEX },
-				});
-
-			_shadowPass.AddVertexAttribDescs({
-				{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
-				});
+			auto layout = GE::Gfx::GetVertexInputLayout(SceneVertexFormat, GE::Gfx::VertexStreamPosition);
+			_shadowPass.AddVertexBufferDescs(layout.bindings);
+			_shadowPass.AddVertexAttribDescs(layout.attributes);
 
-			_shadowPass.AddPushConstants({ {VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4)} });
+			_shadowPass.AddPushConstants({ {VK_SHADER_STAGE_VERTEX_BIT, 0, static_cast<uint32_t>(sizeof(glm::mat4) + (quantized ? sizeof(Drawable::Dequantization) : 0))} });
 
 			_shadowPass.AddDescriptorsSetLayouts({ descriptorPool.GetDescriptorSetLayout(2) });
 			_shadowPass.Configure(1, SHADOWMAP_RESOLUTION, SHADOWMAP_RESOLUTION);
@@ -344,6 +478,7 @@ public:
 	void DestroyUserData()
 	{
 		_modelObjects.clear();
+		_numUploaded = 0;
 		_finalPassVertices.Destroy();
 		_finalPass.Destroy();
 		for (uint32_t i = 0; i < GE::Gfx::GetNumFrames(); i++) {
@@ -367,8 +502,9 @@ public:
 		if (!_loadedResources)
 			return;
 
+		auto& registry = GE::GlobalRegistry();
 		auto currentFrame = GE::Gfx::GetCurrentFrame();
-		auto view = GE::GlobalRegistry().view<const Object, const Visibility, const CenterOfMass>();
+		const GE::Sys::VisibleSet& visibleSet = _cullingSys->GetVisibleSet();
 
 		//GE_INFO("Position: {},{},{}", _cameraData.position.x,  _cameraData.position.y,  _cameraData.position.z);
 		if(count != prevCount)
@@ -391,17 +527,24 @@ public:
 		{
 			VkCommandBuffer& currentBuffer = commandBuffers.GetBuffer();
 
-			int64_t numBuffered = 0;
-			view.each([&](const Object& obj, const Visibility visibility, const CenterOfMass) {
-				if (numBuffered > 0)
-					return;
-
-				if (obj.drawable->Buffer(currentBuffer, &descriptorPool.GetDescriptorSet(0, currentFrame), currentFrame))
+			// Bounds exist before the buffers, so visible objects are uploaded first, one per frame.
+			// The rest are only walked while some are not uploaded yet.
+			bool uploaded = false;
+			auto upload = [&](Drawable* drawable) {
+				if (!uploaded && drawable->Buffer(currentBuffer, &descriptorPool.GetDescriptorSet(0, currentFrame), currentFrame))
 				{
-					numBuffered++;
+					uploaded = true;
+					_numUploaded++;
 					_renderShadowCube = true;
 				}
-			});
+			};
+			for (entt::entity entity : visibleSet.entities)
+			{
+				if (const Object* obj = registry.try_get<const Object>(entity))
+					upload(obj->drawable);
+			}
+			if (!uploaded && _numUploaded < _modelObjects.size())
+				registry.view<const Object>().each([&](const Object obj) { upload(obj.drawable); });
 
 			GBufferUniforms gbufferUniform;
 			gbufferUniform.gWVP = _cameraData.projection * _cameraData.view;
@@ -412,17 +555,45 @@ public:
 
 			vkCmdBindDescriptorSets(currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _gbufferPass.Layout(), 0, 1, &descriptorPool.GetDescriptorSet(0, currentFrame), 0, nullptr);
 			
-			std::vector<std::pair<Drawable*, float>> objects;
-			view.each([&](const Object obj, const Visibility visibility, const CenterOfMass centerOfMass) {
-				if (visibility) {
-					objects.push_back({ obj.drawable, glm::length(centerOfMass - _cameraData.position)});
-				}
-			});
+			// Culling hands over the visible objects with their squared distance
+			_visibleObjects.clear();
+			for (size_t i = 0; i < visibleSet.Size(); i++) {
+				const Object* obj = registry.try_get<const Object>(visibleSet.entities[i]);
+				if (obj && obj->drawable->loaded)
+					_visibleObjects.push_back({ obj->drawable, visibleSet.sortKeys[i] });
+			}
 
 			// Sort objects by distance (front to back)
-			std::sort(objects.begin(), objects.end(), [](const std::pair<Drawable*, float>& a, const std::pair<Drawable*, float>& b) -> bool { return a.second > b.second; });
-			for (auto& obj : objects) {
-				obj.first->Draw(currentBuffer, &descriptorPool.GetDescriptorSet(0, currentFrame), currentFrame);
+			std::sort(_visibleObjects.begin(), _visibleObjects.end(), [](const std::pair<Drawable*, float>& a, const std::pair<Drawable*, float>& b) -> bool { return a.second > b.second; });
+
+			// Batch by material, keeping the distance order within each material
+			_gbufferDraws.clear();
+			for (auto& obj : _visibleObjects) {
+				_drawCommands.clear();
+				obj.first->DrawCommands(_drawCommands);
+				for (auto& command : _drawCommands)
+					_gbufferDraws.push_back({ obj.first, command });
+			}
+			std::stable_sort(_gbufferDraws.begin(), _gbufferDraws.end(), [](const GBufferDraw& a, const GBufferDraw& b) { return a.command.material < b.command.material; });
+
+			if (_firstDrawAt == 0 && !_gbufferDraws.empty())
+				_firstDrawAt = GE::NowMicroseconds();
+
+			Drawable* bound = nullptr;
+			const Drawable::DrawCommand* previous = nullptr;
+			for (auto& draw : _gbufferDraws) {
+				if (draw.drawable != bound) {
+					bound = draw.drawable;
+					bound->Bind(currentBuffer);
+					if (SceneVertexFormat == GE::Gfx::VertexFormat::Quantized)
+						vkCmdPushConstants(currentBuffer, _gbufferPass.Layout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Drawable::Dequantization), &bound->dequantization);
+				}
+				if (!previous || draw.command.material != previous->material) {
+					previous = &draw.command;
+					uint32_t texture = std::min<uint32_t>(draw.command.material, static_cast<uint32_t>(_materialTextures.size()));
+					vkCmdPushConstants(currentBuffer, _gbufferPass.Layout(), VK_SHADER_STAGE_FRAGMENT_BIT, MaterialPushOffset, sizeof(uint32_t), &texture);
+				}
+				vkCmdDrawIndexed(currentBuffer, draw.command.indexCount, 1, draw.command.firstIndex, 0, 0);
 			}
 
 			_gbufferPass.End(currentBuffer);
@@ -442,48 +613,44 @@ public:
 
 			_shadowPassUniformBuffer.Buffer(commandBuffers.GetBuffer(), &shadowMapUniforms, sizeof(shadowMapUniforms));
 
-			for (uint32_t faceIndex = 0; faceIndex < 6; faceIndex++)
+			// Shadows fall on what the camera cannot see, so casters ignore Visibility and are culled
+			// against the faces instead, the light reaching as far as the faces' far plane
+			_shadowCasters.clear();
+			_shadowCasterBounds.clear();
+			GE::GlobalRegistry().view<const Object, const AABB>().each([&](const Object obj, const AABB& aabb) {
+				if (obj.drawable->loaded) {
+					_shadowCasters.push_back(obj.drawable);
+					_shadowCasterBounds.push_back(aabb);
+				}
+				});
+			GE::Math::ShadowCubeCuller shadowCuller(shadowMapUniforms.projection, _sun.Position, zFar);
+			shadowCuller.Cull(_shadowCasterBounds.data(), _shadowCasterBounds.size(), _shadowFaceDraws, &_shadowStats);
+
+			for (uint32_t faceIndex = 0; faceIndex < GE::Math::CubeFaces; faceIndex++)
 			{
 				VkCommandBuffer& currentBuffer = commandBuffers.GetBuffer();
 				_shadowPass.Begin(currentBuffer);
 
-				glm::mat4 viewMatrix = glm::mat4(1.0f);
-				switch (faceIndex)
-				{
-				case 0: // POSITIVE_X
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-					break;
-				case 1:	// NEGATIVE_X
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-					break;
-				case 2:	// POSITIVE_Y
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-					break;
-				case 3:	// NEGATIVE_Y
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-					break;
-				case 4:	// POSITIVE_Z
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-					break;
-				case 5:	// NEGATIVE_Z
-					viewMatrix = glm::rotate(viewMatrix, glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-					break;
-				}
+				glm::mat4 viewMatrix = GE::Math::CubeFaceRotation(faceIndex);
 				vkCmdPushConstants(currentBuffer, _shadowPass._pipeline->PipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &viewMatrix);
 
 				vkCmdBindDescriptorSets(currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _shadowPass.Layout(), 0, 1, &descriptorPool.GetDescriptorSet(2, currentFrame), 0, nullptr);
 
-				view.each([&](const Object obj, const Visibility visibility, const CenterOfMass) {
-					if (obj.drawable->loaded) {
-						VkDeviceSize offsets[] = { 0 };
-						VkBuffer buffers[] = { obj.drawable->verticesBuffer };
-						vkCmdBindVertexBuffers(currentBuffer, 0, 1, buffers, offsets);
-
-						vkCmdDraw(currentBuffer, obj.drawable->numVerts, 1, 0, 0);
-					}
-					});
+				for (uint32_t caster : _shadowFaceDraws[faceIndex])
+				{
+					Drawable* drawable = _shadowCasters[caster];
+					VkDeviceSize offsets[] = { 0 };
+					VkBuffer buffers[] = { drawable->verticesBuffer };
+					vkCmdBindVertexBuffers(currentBuffer, 0, 1, buffers, offsets);
+					drawable->indicesBuffer.Bind(currentBuffer);
+
+					if (SceneVertexFormat == GE::Gfx::VertexFormat::Quantized)
+						vkCmdPushConstants(currentBuffer, _shadowPass._pipeline->PipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4), sizeof(Drawable::Dequantization), &drawable->dequantization);
+
+					uint32_t firstIndex, indexCount;
+					drawable->DrawRange(firstIndex, indexCount);
+					vkCmdDrawIndexed(currentBuffer, indexCount, 1, firstIndex, 0, 0);
+				}
 
 				vkCmdEndRenderPass(currentBuffer);
 
@@ -588,8 +755,8 @@ public:
 
 			GE::Utils::UUID uuid = GE::Sys::ResourceSystem::Get().LookupResource(path);
 			GE::Sys::ResourceHandle<GE::Gfx::Texture> texture(uuid);
-
 			if (firstPass) {
+				_materialTextures.push_back(uuid);
 				sceneTextures.push_back(texture);
 				RegisterUUID(uuid);
 			}
@@ -603,6 +770,15 @@ public:
 				modelTextures.push_back(texture->_texture);
 		}
 
+		// Last, for submeshes without a material
+		modelTextures.push_back(*GE::Gfx::NullTexture::Get());
+
+		if (firstPass)
+		{
+			for (auto& mesh : _modelObjects)
+				AddResourceUsage(mesh);
+		}
+
 		uint32_t i = 0;
 		uint32_t ii = GE::Gfx::GetNumFrames();
 		for (; i < ii; i++)
@@ -621,36 +797,53 @@ public:
 		}
 
 		ResourcesUpdated = false;
+		_loadedResources = true;
 	}
 
 	virtual void Update(int64_t tsMicroseconds) override
 	{
-		if (!_loadedResources && _modelHandle->_isLoaded)
+		if (!_modelComplete && _modelHandle->_isLoaded && _modelObjects.size() == _modelHandle->objects.Size())
 		{
-			vkDeviceWaitIdle(*GE::Gfx::VulkanCore::Get().device);
-
-			_modelObjects.reserve(_modelHandle->objects.size());
-			for (auto& object : _modelHandle->objects) {
-				_modelObjects.emplace_back(&object);
-			}
-
-			_loadedResources = true;
-			ResourcesUpdated = true;
+			GE_INFO("Model: first draw after {:.1f} ms, all {} objects after {:.1f} ms", (_firstDrawAt - _modelRequestedAt) / 1000.0,
+				_modelObjects.size(), (GE::NowMicroseconds() - _modelRequestedAt) / 1000.0);
+			_modelComplete = true;
 		}
 
-		if(ResourcesUpdated)
+		if(ResourcesUpdated && !_modelObjects.empty())
 			LoadTexturesForModel();
 	}
 
+	// Casters drawn into each cube face the last time the shadow cube was rendered
+	GE::Math::ShadowCubeCuller::Stats GetShadowStats() const { return _shadowStats; }
+
 private:
+	const GE::Sys::FrustumCullingSystem* _cullingSys;
 	GE::Gfx::VulkanDescriptorsPool descriptorPool;
 	GE::Gfx::VulkanCommandBuffers commandBuffers;
 
 	// Resources
-	bool _loadedResources = false;
+	bool _loadedResources = false;	// Texture table built for the first objects
+	bool _modelComplete = false;
 	GE::Sys::ResourceHandle<GE::Gfx::Model> _modelHandle{ MODEL_SPONZA_OBJ };
 	std::vector<GE::Sys::ResourceHandle<GE::Gfx::Texture>> sceneTextures;
-	std::vector<Mesh> _modelObjects;
+	std::vector<GE::Utils::UUID> _materialTextures;
+
+	// Entities point at their Mesh, so meshes must not move as objects stream in
+	std::deque<Mesh> _modelObjects;
+	size_t _numUploaded{ 0 };
+
+	// Time to first draw against time to the complete model
+	int64_t _modelRequestedAt{ 0 };
+	int64_t _firstDrawAt{ 0 };
+
+	struct GBufferDraw
+	{
+		Drawable* drawable;
+		Drawable::DrawCommand command;
+	};
+	std::vector<std::pair<Drawable*, float>> _visibleObjects;
+	std::vector<Drawable::DrawCommand> _drawCommands;
+	std::vector<GBufferDraw> _gbufferDraws;
 
 	// GBuffer Pass
 	GE::Gfx::GBufferRenderPass _gbufferPass;
@@ -662,6 +855,10 @@ private:
 	GE::Gfx::VulkanUniformBuffer _shadowPassUniformBuffer;
 	GE::Gfx::VulkanBuffer _sunDataBuffer;
 	Light _sun;
+	std::vector<Drawable*> _shadowCasters;
+	std::vector<AABB> _shadowCasterBounds;
+	std::vector<uint32_t> _shadowFaceDraws[GE::Math::CubeFaces];
+	GE::Math::ShadowCubeCuller::Stats _shadowStats;
 
 	// GBuffer/Shadow Composition Pass
 	GE::Gfx::MSAAFrameBufferRenderPass _compositionPass;
@@ -685,8 +882,13 @@ private:
 class TestGuiLayer : public GE::Sys::System
 {
 public:
-	TestGuiLayer()
+	TestGuiLayer(const TestLayer* testLayer, const GE::Sys::FrustumCullingSystem* cullingSys, const GE::Sys::OcclusionCullingSystem* occlusionSys,
+		const GE::Sys::ClusterCullingSystem* clusterSys)
 		: GE::Sys::System("TestGuiLayer")
+		, _testLayer(testLayer)
+		, _cullingSys(cullingSys)
+		, _occlusionSys(occlusionSys)
+		, _clusterSys(clusterSys)
 	{
 	}
 
@@ -694,12 +896,41 @@ public:
 	{
 		if (ImGui::Begin("Framerate", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize))
 		{
-			ImGui::SetWindowSize("Framerate", { 200, 25 });
+			ImGui::SetWindowSize("Framerate", { 300, 150 });
 			ImGui::SetWindowPos("Framerate", { 0, 0 });
 			ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+			auto stats = GE::Sys::ResourceSystem::Get().GetStreamingStats();
+			ImGui::Text("Streaming: %u pending (%u visible)", stats.pending, stats.pendingVisible);
+			if (stats.lastVisibleCompleteMicroseconds >= 0)
+				ImGui::Text("Visible resident in %.1f ms", stats.lastVisibleCompleteMicroseconds / 1000.0);
+
+			auto culling = _cullingSys->GetStats();
+			ImGui::Text("Culling: %u of %u visible (%u moving, %u too small), %u nodes, %u cells", culling.visible, culling.entities, culling.dynamic,
+				culling.tooSmall, culling.bvh.nodesVisited, culling.grid.cellsVisited);
+			if (culling.pvsCulled > 0)
+				ImGui::Text("PVS: %u hidden by the camera's cell", culling.pvsCulled);
+
+			auto occlusion = _occlusionSys->GetStats();
+			ImGui::Text("Occlusion: %u of %u hidden, %u occluders, %.2f ms", occlusion.occluded, occlusion.tested, occlusion.occluders,
+				(occlusion.rasterizeMicroseconds + occlusion.testMicroseconds) / 1000.0);
+
+			auto shadows = _testLayer->GetShadowStats();
+			ImGui::Text("Shadow draws: %u %u %u %u %u %u (%u of %u)", shadows.faceDraws[0], shadows.faceDraws[1], shadows.faceDraws[2],
+				shadows.faceDraws[3], shadows.faceDraws[4], shadows.faceDraws[5], shadows.Draws(), GE::Math::CubeFaces * shadows.casters);
+
+			auto clusters = _clusterSys->GetStats();
+			if (clusters.objectTriangles > 0)
+				ImGui::Text("Clusters: %.1f%% triangles culled, %u draws", 100.0 * (clusters.objectTriangles - clusters.clusterTriangles) / clusters.objectTriangles, clusters.ranges);
 		}
 		ImGui::End();
 	}
+
+private:
+	const TestLayer* _testLayer;
+	const GE::Sys::FrustumCullingSystem* _cullingSys;
+	const GE::Sys::OcclusionCullingSystem* _occlusionSys;
+	const GE::Sys::ClusterCullingSystem* _clusterSys;
 };
 
 class Sandbox : public GE::GfxApplication
@@ -707,7 +938,10 @@ class Sandbox : public GE::GfxApplication
 public:
 	Sandbox() 
 		: GE::GfxApplication("Sandbox"),
-		inputSys(this)
+		testLayer(&cullingSys),
+		testGuiLayer(&testLayer, &cullingSys, &occlusionSys, &clusterSys),
+		inputSys(this),
+		occlusionSys(&cullingSys)
 	{
 #ifdef _DEBUG
 		GE_SET_LOG_LEVEL(GE_LOG_LEVEL_TRACE);
@@ -733,10 +967,27 @@ public:
 
 		skyboxLayer.SetImage("textures/skybox.png");
 
+		// Baked by PvsBaker from the same model, see CopyFiles.ps1
+		auto pvsData = GE::Utils::EngineResourceParser::GetDataPoint("PVS_SPONZA_PVS");
+		if (pvsData.size > 0)
+		{
+			if (pvs.Deserialize(GE::Utils::LoadFile("EngineData.blob", pvsData.startPoint, pvsData.size)))
+				cullingSys.SetPotentiallyVisibleSet(&pvs);
+			else
+				GE_WARN("Ignoring PVS_SPONZA_PVS, stale or corrupt, rebake it with PvsBaker");
+		}
+
+		cullingSys.SetScreenHeight(GE::Gfx::GetFrameHeight());
+		GE::GlobalDispatcher().sink<GE::Gfx::ResizeEvent>().connect<&Sandbox::Resize>(this);
+
 		PushSystem(&cullingSys);
+		PushSystem(&occlusionSys);
+		PushSystem(&lodSys);
+		PushSystem(&clusterSys);
 		PushSystem(&skyboxLayer);
 		PushSystem(&testLayer);
 		PushSystem(&testGuiLayer);
+		PushSystem(&timelineGui);
 		PushSystem(&inputSys);
 		PushSystem(&cameraSys);
 	}
@@ -746,10 +997,16 @@ public:
 		TIMED_TRACE();
 		WaitForWindowIdle();
 
+		GE::GlobalDispatcher().sink<GE::Gfx::ResizeEvent>().disconnect<&Sandbox::Resize>(this);
+
 		PopSystem(&cullingSys);
+		PopSystem(&occlusionSys);
+		PopSystem(&lodSys);
+		PopSystem(&clusterSys);
 		PopSystem(&testLayer);
 		PopSystem(&skyboxLayer);
 		PopSystem(&testGuiLayer);
+		PopSystem(&timelineGui);
 		PopSystem(&inputSys);
 		PopSystem(&cameraSys);
 	}
@@ -760,12 +1017,22 @@ public:
 	}
 
 private:
+	void Resize(GE::Gfx::ResizeEvent evt)
+	{
+		cullingSys.SetScreenHeight(GE::Gfx::GetFrameHeight());
+	}
+
 	TestLayer testLayer;
 	TestGuiLayer testGuiLayer;
+	GE::Sys::ResourceTimelineGui timelineGui;
 	GE::Sys::SkyboxSystem skyboxLayer;
 	GE::Sys::Camera3D cameraSys;
 	GE::Sys::InputSystem inputSys;
 	GE::Sys::FrustumCullingSystem cullingSys;
+	GE::Sys::OcclusionCullingSystem occlusionSys;
+	GE::Sys::LodSystem lodSys;
+	GE::Sys::ClusterCullingSystem clusterSys;
+	GE::Math::PotentiallyVisibleSet pvs;
 };
 
 std::unique_ptr<GE::Application> GE::CreateApplication()